@@ -0,0 +1,88 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np, CPU_SET
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "affinity.h"
+
+// Rozparsuje zoznam CPU ("0-3,8").
+int affinity_parse_list(const char *list, int *cpus, int max)
+{
+    int count = 0;
+    const char *p = list;
+    while (p && *p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) return -1;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) return -1;
+        }
+        for (long c = first; c <= last; c++) {
+            if (count == max || c >= CPU_SETSIZE) return -1;
+            cpus[count++] = (int)c;
+        }
+        while (*end == ' ' || *end == '\n') end++;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return count;
+}
+
+// CPU jednotlivých NUMA uzlov zo sysfs (/sys/devices/system/node/nodeN/cpulist).
+int affinity_numa_cpus(int *cpus, int *nodes, int max)
+{
+    int count = 0;
+    for (int node = 0; node < 1024 && count < max; node++) {
+        char path[96], line[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (!f) {
+            if (node == 0) break;  // žiadne NUMA informácie
+            continue;              // uzly nemusia byť číslované súvisle
+        }
+        char *ok = fgets(line, sizeof(line), f);
+        fclose(f);
+        if (!ok) continue;
+        int n = affinity_parse_list(line, cpus + count, max - count);
+        if (n < 0) continue;
+        for (int i = 0; i < n; i++) nodes[count + i] = node;
+        count += n;
+    }
+    if (count > 0) return count;
+
+    // Stroj bez NUMA v sysfs: jeden uzol so všetkými online CPU.
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long c = 0; c < online && count < max; c++) {
+        cpus[count] = (int)c;
+        nodes[count] = 0;
+        count++;
+    }
+    return count;
+}
+
+int affinity_pin_self(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+// Servisné vlákna nechá bežať na všetkých CPU procesu okrem tých, ktoré patria simulácii.
+int affinity_exclude_self(const int *cpus, int count)
+{
+    if (!cpus || count <= 0) return 0;
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return -1;
+    for (int i = 0; i < count; i++)
+        if (cpus[i] < CPU_SETSIZE) CPU_CLR(cpus[i], &set);
+    if (CPU_COUNT(&set) == 0) return 0; // všetky CPU sú simulačné, servisné vlákna sa delia
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
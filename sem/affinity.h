@@ -0,0 +1,19 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+// Pripnutie vlákien na CPU: simulačné vlákna na zvolené jadrá (--cpus / --numa),
+// servisné vlákna (chodec, socket) mimo nich. Bez zoznamu CPU sa nič nemení.
+
+#define AFFINITY_MAX_CPUS 1024
+
+// Rozparsuje zoznam v tvare "0-3,8,10-11". Vráti počet CPU alebo -1 pri chybe.
+int affinity_parse_list(const char *list, int *cpus, int max);
+// CPU zoradené po NUMA uzloch (uzol 0, potom 1, ...) zo sysfs; nodes[i] = uzol cpus[i].
+// Na stroji bez NUMA informácií vráti všetky online CPU v uzle 0.
+int affinity_numa_cpus(int *cpus, int *nodes, int max);
+// Pripne volajúce vlákno na jedno CPU. Vráti 0 alebo -1.
+int affinity_pin_self(int cpu);
+// Obmedzí volajúce vlákno na pôvodné CPU procesu bez zadaných (ak nejaké ostanú).
+int affinity_exclude_self(const int *cpus, int count);
+
+#endif // AFFINITY_H
@@ -0,0 +1,148 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "autotune.h"
+#include "simulation.h"
+#include "world.h"
+
+// Automatické ladenie: identita hostiteľa a triedy konfigurácie, uložené voľby a kalibrácia.
+
+// Rýchlosť musí byť o toľko vyššia, aby prebila doterajšiu voľbu (šum krátkych behov).
+#define AUTOTUNE_MIN_GAIN 1.02
+// Pokles pod tento podiel najlepšej rýchlosti ukončí skúšanie ďalších počtov vlákien.
+#define AUTOTUNE_STOP_RATIO 0.9
+
+static int log2_ceil(long long v)
+{
+    int k = 0;
+    while ((1LL << k) < v) k++;
+    return k;
+}
+
+// Hostiteľ: názov, počet CPU a hash riadku "model name" z /proc/cpuinfo.
+static void host_id(char *buf, size_t size)
+{
+    char name[64] = "unknown";
+    if (gethostname(name, sizeof(name)) != 0) strcpy(name, "unknown");
+    name[sizeof(name) - 1] = '\0';
+    unsigned int h = 2166136261u;
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "model name", 10) != 0) continue;
+            for (const char *p = line; *p; p++) {
+                h ^= (unsigned char)*p;
+                h *= 16777619u;
+            }
+            break;
+        }
+        fclose(f);
+    }
+    snprintf(buf, size, "%s-%ldcpu-%08x", name, sysconf(_SC_NPROCESSORS_ONLN), h);
+}
+
+// Trieda konfigurácie: čo mení cenu prechádzky a pomer práce k zápisom výsledkov.
+static void config_class(const SharedState *S, char *buf, size_t size)
+{
+    snprintf(buf, size, "n%d-k%d-%s%s%s", log2_ceil(S->world_size), log2_ceil(S->max_steps),
+             S->use_obstacles ? "walls" : "torus", S->prob_field ? "-field" : "",
+             S->target_map ? "-targets" : "");
+}
+
+// Posledný uložený riadok pre hostiteľa a triedu. Vráti 1 a vyplní voľbu, inak 0.
+static int load_choice(const char *host, const char *cls, int *threads, int *batch, double *rate)
+{
+    FILE *f = fopen(SAVED_DIR "/" AUTOTUNE_FILE, "r");
+    if (!f) return 0;
+    char h[160], c[64];
+    int t, b;
+    double r;
+    int found = 0;
+    while (fscanf(f, "%159s %63s %d %d %lf", h, c, &t, &b, &r) == 5) {
+        if (strcmp(h, host) != 0 || strcmp(c, cls) != 0) continue;
+        *threads = t;
+        *batch = b;
+        *rate = r;
+        found = 1;
+    }
+    fclose(f);
+    return found;
+}
+
+static void store_choice(const char *host, const char *cls, int threads, int batch, double rate)
+{
+    mkdir(SAVED_DIR, 0755);
+    FILE *f = fopen(SAVED_DIR "/" AUTOTUNE_FILE, "a");
+    if (!f) {
+        printf("Warning: Could not write '%s/%s'.\n", SAVED_DIR, AUTOTUNE_FILE);
+        return;
+    }
+    fprintf(f, "%s %s %d %d %.0f\n", host, cls, threads, batch, rate);
+    fclose(f);
+}
+
+static double measure(SharedState *S, int threads, int batch)
+{
+    double rate = simulation_burst(S, threads, batch, AUTOTUNE_BURST_MS);
+    if (rate >= 0)
+        printf("[Autotune]   %3d thread(s), batch %4d: %.1f Msteps/s\n", threads, batch, rate / 1e6);
+    return rate;
+}
+
+int autotune_run(SharedState *S, int max_threads)
+{
+    char host[160], cls[64];
+    host_id(host, sizeof(host));
+    config_class(S, cls, sizeof(cls));
+    if (max_threads < 1) max_threads = 1;
+
+    int threads, batch;
+    double rate;
+    if (load_choice(host, cls, &threads, &batch, &rate) && threads >= 1 && threads <= max_threads &&
+        batch > 0) {
+        S->threads = threads;
+        S->batch = batch;
+        printf("[Autotune] Saved choice for %s / %s: %d thread(s), batch %d (%.1f Msteps/s).\n",
+               host, cls, threads, batch, rate / 1e6);
+        return 0;
+    }
+
+    printf("[Autotune] Calibrating on %s / %s (%d ms per burst)...\n", host, cls, AUTOTUNE_BURST_MS);
+    // 1. Počet vlákien pri predvolenom bloku: mocniny dvoch a nakoniec maximum.
+    int best_t = 1, best_b = SIM_DEFAULT_BATCH;
+    double best = -1.0;
+    for (int t = 1; t <= max_threads; t = (t < max_threads && t * 2 > max_threads) ? max_threads : t * 2) {
+        double r = measure(S, t, SIM_DEFAULT_BATCH);
+        if (r < 0) {
+            printf("Error: Autotune could not start %d calibration thread(s).\n", t);
+            return -1;
+        }
+        if (r > best * AUTOTUNE_MIN_GAIN) {
+            best = r;
+            best_t = t;
+        } else if (r < best * AUTOTUNE_STOP_RATIO) {
+            break;
+        }
+    }
+    // 2. Veľkosť bloku pri zvolenom počte vlákien.
+    static const int batches[] = { 16, 256, 1024 };
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        double r = measure(S, best_t, batches[i]);
+        if (r > best * AUTOTUNE_MIN_GAIN) {
+            best = r;
+            best_b = batches[i];
+        }
+    }
+
+    S->threads = best_t;
+    S->batch = best_b;
+    store_choice(host, cls, best_t, best_b, best);
+    printf("[Autotune] Using %d thread(s), batch %d (%.1f Msteps/s), saved to %s/%s.\n",
+           best_t, best_b, best / 1e6, SAVED_DIR, AUTOTUNE_FILE);
+    return 0;
+}
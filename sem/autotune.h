@@ -0,0 +1,21 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+// Automatické ladenie pri štarte (--autotune): krátke kalibračné behy skutočnej záťaže
+// (simulation_burst) vyberú počet simulačných vlákien a veľkosť bloku buniek. Výsledok nezávisí
+// od voľby (prúdy sú dané seedom, replikáciou a bunkou), mení sa len rýchlosť.
+//
+// Voľba sa pamätá v saved/autotune.txt, riadok "hostiteľ trieda vlákna blok kroky/s" na každú
+// dvojicu. Hostiteľ = názov, počet CPU a hash modelu CPU; trieda = rád veľkosti sveta a max_steps,
+// steny/torus, pole pravdepodobností a mapa cieľov. Nové ladenie vynúti zmazanie riadku.
+
+#define AUTOTUNE_FILE "autotune.txt"  // v SAVED_DIR
+#define AUTOTUNE_BURST_MS 150         // dĺžka jedného kalibračného behu
+
+struct SharedState;
+
+// Nastaví S->threads a S->batch (najviac max_threads vlákien) z uloženej voľby alebo z kalibrácie
+// a vypíše, čo zvolil. Vráti 0 alebo -1 (kalibrácia zlyhala, nastavenia ostávajú).
+int autotune_run(struct SharedState *S, int max_threads);
+
+#endif // AUTOTUNE_H
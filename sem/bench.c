@@ -0,0 +1,485 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "bench.h"
+#include "simulation.h"
+#include "walker.h"
+#include "world.h"
+#include "utils.h"
+#include "worldgen.h"
+#include "probfield.h"
+
+// Benchmark jadra: sweep veľkosti sveta, hustoty prekážok, pravdepodobností, max_steps a vlákien.
+// Výstup je CSV (jeden riadok na prípad), ktoré sa dá neskôr použiť ako --baseline.
+#define BENCH_MAX_CASES 48
+#define BENCH_SEED 0x5EED5EEDull   // pevný seed: každá vzorka robí presne tú istú prácu
+#define BENCH_MAX_REPS 1000000
+
+typedef struct BenchCase {
+    char name[48];
+    int world_size;
+    double density;        // podiel buniek s prekážkou
+    Probabilities prob;
+    int max_steps;
+    int threads;
+    int batch;             // 0 = SIM_DEFAULT_BATCH
+    bool kernel;           // meraj len random_walk (bez simulate_from a štatistík)
+    const char *world;     // špecifikácia generátora (worldgen.h) namiesto density, NULL = density
+    bool field;            // pole pravdepodobností po bunkách (alias tabuľky) namiesto prob
+} BenchCase;
+
+typedef struct BenchResult {
+    int replications;      // replikácií na vzorku
+    long long walks;       // prechádzok na vzorku
+    long long steps;       // krokov na vzorku
+    double *sample_s;      // časy vzoriek (zoradené)
+    int samples;
+} BenchResult;
+
+typedef struct BaselineEntry {
+    char name[48];
+    double steps_per_s;
+} BaselineEntry;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil podľa najbližšieho poradia zo zoradeného poľa.
+static double percentile(const double *sorted, int n, double p)
+{
+    int idx = (int)(p * n + 0.999999) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= n) idx = n - 1;
+    return sorted[idx];
+}
+
+// ============ PRÍPADY ============
+
+static void add_case(BenchCase *cases, int *count, const BenchConfig *cfg, const BenchCase *c)
+{
+    if (*count >= BENCH_MAX_CASES) return;
+    if (cfg->filter[0] != '\0' && !strstr(c->name, cfg->filter)) return;
+    cases[(*count)++] = *c;
+}
+
+// Zostaví sweep: každý prípad mení jeden parameter oproti základnému prípadu "base".
+static int build_cases(const BenchConfig *cfg, BenchCase *cases)
+{
+    int count = 0;
+    BenchCase base = { "base", 64, 0.0, { 0.25, 0.25, 0.25, 0.25 }, 1000, 1, 0, false, NULL, false };
+    BenchCase c;
+
+    c = base;
+    safe_strcpy(c.name, "kernel_step", sizeof(c.name));
+    c.kernel = true;
+    add_case(cases, &count, cfg, &c);
+    add_case(cases, &count, cfg, &base);
+
+    static const int sizes_full[] = { 16, 32, 128, 256 };
+    static const int sizes_quick[] = { 16, 256 };
+    const int *sizes = cfg->quick ? sizes_quick : sizes_full;
+    int nsizes = cfg->quick ? 2 : 4;
+    for (int i = 0; i < nsizes; i++) {
+        c = base;
+        c.world_size = sizes[i];
+        snprintf(c.name, sizeof(c.name), "size_%d", sizes[i]);
+        add_case(cases, &count, cfg, &c);
+    }
+
+    static const double dens_full[] = { 0.1, 0.2, 0.3 };
+    static const double dens_quick[] = { 0.2 };
+    const double *dens = cfg->quick ? dens_quick : dens_full;
+    int ndens = cfg->quick ? 1 : 3;
+    for (int i = 0; i < ndens; i++) {
+        c = base;
+        c.density = dens[i];
+        snprintf(c.name, sizeof(c.name), "density_%02d", (int)(dens[i] * 100 + 0.5));
+        add_case(cases, &count, cfg, &c);
+    }
+
+    // Štruktúrované mapy z generátora: dlhé chodby a úzke prechody namiesto rovnomerného šumu.
+    if (!cfg->quick) {
+        static const char *const worlds[][2] = {
+            { "world_maze", "maze:255,seed=1" },
+            { "world_rooms", "rooms:256,seed=1" },
+            { "world_rings", "rings:256,seed=1" },
+        };
+        for (int i = 0; i < 3; i++) {
+            WorldGenSpec spec;
+            if (worldgen_parse(worlds[i][1], &spec) != 0) continue;
+            c = base;
+            c.world_size = spec.size;
+            c.world = worlds[i][1];
+            safe_strcpy(c.name, worlds[i][0], sizeof(c.name));
+            add_case(cases, &count, cfg, &c);
+        }
+    }
+
+    if (!cfg->quick) {
+        c = base;
+        c.prob = (Probabilities){ 0.30, 0.20, 0.25, 0.25 };
+        safe_strcpy(c.name, "skew_mild", sizeof(c.name));
+        add_case(cases, &count, cfg, &c);
+    }
+    c = base;
+    c.prob = (Probabilities){ 0.50, 0.10, 0.20, 0.20 };
+    safe_strcpy(c.name, "skew_strong", sizeof(c.name));
+    add_case(cases, &count, cfg, &c);
+
+    c = base;
+    c.field = true;
+    safe_strcpy(c.name, "prob_field", sizeof(c.name));
+    add_case(cases, &count, cfg, &c);
+
+    static const int steps_full[] = { 100, 10000 };
+    int nsteps = cfg->quick ? 1 : 2;
+    for (int i = 0; i < nsteps; i++) {
+        c = base;
+        c.max_steps = steps_full[i];
+        snprintf(c.name, sizeof(c.name), "steps_%d", steps_full[i]);
+        add_case(cases, &count, cfg, &c);
+    }
+
+    // Vlákna: mocniny dvoch až po max_threads (aspoň 2, aby bola vidno réžia synchronizácie).
+    int max_threads = cfg->max_threads;
+    if (max_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        max_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (max_threads < 2) max_threads = 2;
+    for (int t = 2; t <= max_threads; t *= 2) {
+        c = base;
+        c.threads = t;
+        snprintf(c.name, sizeof(c.name), "threads_%d", t);
+        add_case(cases, &count, cfg, &c);
+        if (t * 2 > max_threads && t != max_threads) {
+            c.threads = max_threads;
+            snprintf(c.name, sizeof(c.name), "threads_%d", max_threads);
+            add_case(cases, &count, cfg, &c);
+        }
+    }
+
+    if (!cfg->quick) {
+        static const int batches[] = { 1, 16, 256 };
+        for (int i = 0; i < 3; i++) {
+            c = base;
+            c.threads = max_threads;
+            c.batch = batches[i];
+            snprintf(c.name, sizeof(c.name), "batch_%d_t%d", batches[i], max_threads);
+            add_case(cases, &count, cfg, &c);
+        }
+    }
+    return count;
+}
+
+// ============ MERANIE ============
+
+// Pripraví svet prípadu bez IPC; prekážky sa generujú deterministicky z BENCH_SEED.
+static SharedState *bench_prepare(const BenchCase *c)
+{
+    WorldGenSpec gen;
+    if (c->world && worldgen_parse(c->world, &gen) != 0) return NULL;
+    SharedState *S = calloc(1, sizeof(SharedState));
+    if (!S) return NULL;
+    S->world_size = c->world ? gen.size : c->world_size;
+    S->max_steps = c->max_steps;
+    S->prob = c->prob;
+    S->use_obstacles = c->density > 0.0;
+    S->threads = c->threads;
+    S->batch = c->batch;
+    S->seed = BENCH_SEED;
+    S->mode = 2;
+    allocate_world(S);
+    initialize_world(S);
+    pthread_mutex_init(&S->lock, NULL);
+
+    if (c->world) {
+        if (worldgen_generate(S, &gen, NULL) != 0) {
+            pthread_mutex_destroy(&S->lock);
+            free_world(S);
+            free(S);
+            return NULL;
+        }
+    } else if (S->use_obstacles) {
+        WalkRng rng;
+        walk_rng_seed(&rng, BENCH_SEED, 0, 0);
+        for (int y = 0; y < S->world_size; y++)
+            for (int x = 0; x < S->world_size; x++)
+                S->obstacles[y][x] = walk_rng_uniform(&rng) < c->density;
+        S->obstacles[S->world_size / 2][S->world_size / 2] = 0;
+    }
+    if (c->field) {
+        // Prúd zľava doprava, ktorého sila sa mení so stĺpcom.
+        if (!probfield_alloc(S)) {
+            pthread_mutex_destroy(&S->lock);
+            free_world(S);
+            free(S);
+            return NULL;
+        }
+        int n = S->world_size;
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                double *p = &S->prob_field[4 * ((size_t)y * n + x)];
+                double drift = 0.1 * x / (n > 1 ? n - 1 : 1);
+                p[0] = c->prob.up;
+                p[1] = c->prob.down;
+                p[2] = c->prob.left - drift / 2;
+                p[3] = c->prob.right + drift / 2;
+            }
+        }
+        probfield_build(S);
+    }
+    return S;
+}
+
+static void bench_release(SharedState *S)
+{
+    pthread_mutex_destroy(&S->lock);
+    free_world(S);
+    free(S);
+}
+
+// Vynuluje štatistiky a spustí reps replikácií; vráti čas v sekundách.
+static double bench_replications(SharedState *S, int reps)
+{
+    for (int y = 0; y < S->world_size; y++)
+        for (int x = 0; x < S->world_size; x++) {
+            S->total_steps[y][x] = 0;
+            S->success_count[y][x] = 0;
+        }
+    S->replications = reps;
+    S->current_rep = 0;
+    S->walks_done = 0;
+    S->steps_done = 0;
+    S->finished = false;
+
+    double t0 = now_s();
+    simulation_thread(S);
+    return now_s() - t0;
+}
+
+// Čistý krok chodca: target_steps volaní random_walk na jednom chodcovi.
+static double bench_kernel(SharedState *S, long long steps)
+{
+    WalkRng rng;
+    walk_rng_seed(&rng, BENCH_SEED, 0, 0);
+    Walker w = { 0, 0 };
+    double t0 = now_s();
+    for (long long i = 0; i < steps; i++)
+        random_walk(S, &w, &rng);
+    double dt = now_s() - t0;
+    // Použi výsledok, aby prekladač slučku nevyhodil.
+    if (w.x == -1) fprintf(stderr, "%d\n", w.y);
+    return dt;
+}
+
+// Odmeria jeden prípad: kalibrácia počtu replikácií, rozbeh a vzorky.
+static int bench_case(const BenchConfig *cfg, const BenchCase *c, BenchResult *res)
+{
+    SharedState *S = bench_prepare(c);
+    res->sample_s = malloc(cfg->samples * sizeof(double));
+    if (!S || !res->sample_s) {
+        if (S) bench_release(S);
+        free(res->sample_s);
+        res->sample_s = NULL;
+        return -1;
+    }
+    res->samples = cfg->samples;
+
+    if (c->kernel) {
+        res->replications = 0;
+        res->walks = 0;
+        res->steps = cfg->target_steps;
+        bench_kernel(S, cfg->target_steps / 10); // rozbeh
+        for (int i = 0; i < cfg->samples; i++)
+            res->sample_s[i] = bench_kernel(S, res->steps);
+    } else {
+        // Kalibrácia podľa počtu krokov jednej replikácie (deterministická, nezávisí od času).
+        bench_replications(S, 1);
+        long long per_rep = S->steps_done > 0 ? S->steps_done : 1;
+        long long reps = cfg->target_steps / per_rep;
+        if (reps < 1) reps = 1;
+        if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+        res->replications = (int)reps;
+
+        bench_replications(S, res->replications); // rozbeh
+        for (int i = 0; i < cfg->samples; i++)
+            res->sample_s[i] = bench_replications(S, res->replications);
+        res->walks = S->walks_done;
+        res->steps = S->steps_done;
+    }
+
+    qsort(res->sample_s, res->samples, sizeof(double), cmp_double);
+    bench_release(S);
+    return 0;
+}
+
+// ============ VÝSTUP A BASELINE ============
+
+// Načíta stĺpce "case" a "steps_per_s" zo staršieho CSV výstupu.
+static int load_baseline(const char *path, BaselineEntry *out, int max)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: Could not open baseline '%s'.\n", path);
+        return -1;
+    }
+
+    char line[1024];
+    int col_case = -1, col_rate = -1, count = 0;
+    if (fgets(line, sizeof(line), f)) {
+        int col = 0;
+        for (char *save = NULL, *tok = strtok_r(line, ",\n", &save); tok; tok = strtok_r(NULL, ",\n", &save), col++) {
+            if (!strcmp(tok, "case")) col_case = col;
+            if (!strcmp(tok, "steps_per_s")) col_rate = col;
+        }
+    }
+    if (col_case < 0 || col_rate < 0) {
+        fprintf(stderr, "Error: Baseline '%s' has no case/steps_per_s columns.\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    while (count < max && fgets(line, sizeof(line), f)) {
+        int col = 0;
+        BaselineEntry e = { "", 0.0 };
+        for (char *save = NULL, *tok = strtok_r(line, ",\n", &save); tok; tok = strtok_r(NULL, ",\n", &save), col++) {
+            if (col == col_case) safe_strcpy(e.name, tok, sizeof(e.name));
+            if (col == col_rate) e.steps_per_s = atof(tok);
+        }
+        if (e.name[0] != '\0' && e.steps_per_s > 0) out[count++] = e;
+    }
+    fclose(f);
+    return count;
+}
+
+static const BaselineEntry *find_baseline(const BaselineEntry *base, int n, const char *name)
+{
+    for (int i = 0; i < n; i++)
+        if (!strcmp(base[i].name, name)) return &base[i];
+    return NULL;
+}
+
+// Zapíše rovnaký text na stdout aj do voliteľného súboru.
+static void emit(FILE *file, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    if (file) {
+        va_start(ap, fmt);
+        vfprintf(file, fmt, ap);
+        va_end(ap);
+    }
+}
+
+// Spustí všetky prípady a vypíše CSV; pri --baseline doplní porovnanie steps/s.
+int bench_run(const BenchConfig *config)
+{
+    BenchCase cases[BENCH_MAX_CASES];
+    int count = build_cases(config, cases);
+    if (count == 0) {
+        fprintf(stderr, "Error: No benchmark case matches '%s'.\n", config->filter);
+        return 1;
+    }
+
+    BaselineEntry baseline[BENCH_MAX_CASES * 2];
+    int nbase = -1;
+    if (config->baseline_file[0] != '\0') {
+        nbase = load_baseline(config->baseline_file, baseline, BENCH_MAX_CASES * 2);
+        if (nbase < 0) return 1;
+    }
+
+    FILE *out = NULL;
+    if (config->out_file[0] != '\0') {
+        out = fopen(config->out_file, "w");
+        if (!out) {
+            fprintf(stderr, "Error: Could not open '%s' for writing.\n", config->out_file);
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "[Bench] %d cases, %d samples, ~%lld steps per sample\n",
+            count, config->samples, config->target_steps);
+    emit(out, "case,world_size,density,prob_up,prob_down,prob_left,prob_right,max_steps,threads,batch,"
+              "replications,samples,walks,steps,steps_per_s,walks_per_s,ns_per_step,"
+              "min_ms,p50_ms,p90_ms,p99_ms,max_ms%s\n",
+         nbase >= 0 ? ",baseline_steps_per_s,delta_pct,status" : "");
+
+    int regressions = 0;
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        const BenchCase *c = &cases[i];
+        fprintf(stderr, "[Bench] %-16s ", c->name);
+        fflush(stderr);
+
+        BenchResult r;
+        memset(&r, 0, sizeof(r));
+        if (bench_case(config, c, &r) != 0) {
+            fprintf(stderr, "FAILED\n");
+            failed++;
+            continue;
+        }
+
+        double med = percentile(r.sample_s, r.samples, 0.50);
+        double steps_per_s = med > 0 ? r.steps / med : 0.0;
+        double walks_per_s = med > 0 ? r.walks / med : 0.0;
+        double ns_per_step = r.steps > 0 ? med * 1e9 / r.steps : 0.0;
+        fprintf(stderr, "%12.0f steps/s %8.2f ns/step\n", steps_per_s, ns_per_step);
+
+        emit(out, "%s,%d,%.2f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d,%d,%d,%lld,%lld,%.1f,%.1f,%.3f,"
+                  "%.3f,%.3f,%.3f,%.3f,%.3f",
+             c->name, c->world_size, c->density,
+             c->prob.up, c->prob.down, c->prob.left, c->prob.right,
+             c->max_steps, c->threads, c->batch > 0 ? c->batch : SIM_DEFAULT_BATCH,
+             r.replications, r.samples, r.walks, r.steps,
+             steps_per_s, walks_per_s, ns_per_step,
+             r.sample_s[0] * 1e3, med * 1e3,
+             percentile(r.sample_s, r.samples, 0.90) * 1e3,
+             percentile(r.sample_s, r.samples, 0.99) * 1e3,
+             r.sample_s[r.samples - 1] * 1e3);
+
+        if (nbase >= 0) {
+            const BaselineEntry *b = find_baseline(baseline, nbase, c->name);
+            if (!b) {
+                emit(out, ",,,new\n");
+            } else {
+                double delta = (steps_per_s / b->steps_per_s - 1.0) * 100.0;
+                const char *status = "same";
+                if (delta < -config->threshold_pct) {
+                    status = "regression";
+                    regressions++;
+                } else if (delta > config->threshold_pct) {
+                    status = "faster";
+                }
+                emit(out, ",%.1f,%.2f,%s\n", b->steps_per_s, delta, status);
+            }
+        } else {
+            emit(out, "\n");
+        }
+        free(r.sample_s);
+    }
+
+    if (out) fclose(out);
+    if (nbase >= 0)
+        fprintf(stderr, "[Bench] %d regression(s) beyond %.1f%% vs '%s'\n",
+                regressions, config->threshold_pct, config->baseline_file);
+    return (failed || regressions) ? 1 : 0;
+}
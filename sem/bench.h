@@ -0,0 +1,19 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Benchmark simulačného jadra: priamo volá simulate_from/simulation_thread (bez IPC a klienta).
+typedef struct BenchConfig {
+    int quick;              // menšia sada prípadov a kratšie vzorky
+    int samples;            // počet meraných vzoriek na prípad
+    long long target_steps; // približný počet krokov na jednu vzorku
+    int max_threads;        // najvyšší počet vlákien v sweepe (0 = počet CPU)
+    char filter[64];        // spusti len prípady, ktorých názov obsahuje tento reťazec
+    char out_file[256];     // CSV výsledkov navyše aj do súboru
+    char baseline_file[256];// porovnaj steps/s so staršími výsledkami
+    double threshold_pct;   // pokles väčší ako toto je regresia
+} BenchConfig;
+
+// Spustí všetky prípady; vráti 0, alebo 1 pri chybe či regresii oproti baseline.
+int bench_run(const BenchConfig *config);
+
+#endif // BENCH_H
@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "simulation.h"
+#include "world.h"
+
+// Úložisko výsledkov: kľúč konfigurácie, vyhľadanie, prevzatie a uloženie záznamu.
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+static void fnv_bytes(uint64_t *h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        *h ^= p[i];
+        *h *= FNV_PRIME;
+    }
+}
+
+static void fnv_int(uint64_t *h, long long v)
+{
+    fnv_bytes(h, &v, sizeof(v));
+}
+
+// Súbory nesú pravdepodobnosti na 6 desatinných miest, preto sa hashujú zaokrúhlené.
+static void fnv_prob(uint64_t *h, double p)
+{
+    fnv_int(h, (long long)(p * 1e6 + 0.5));
+}
+
+uint64_t cache_key(const SharedState *S)
+{
+    uint64_t h = FNV_OFFSET;
+    int n = S->world_size;
+    fnv_int(&h, CACHE_VERSION);
+    fnv_int(&h, n);
+    fnv_int(&h, S->use_obstacles ? 1 : 0);
+    fnv_int(&h, S->max_steps);
+    if (S->prob_field) {
+        fnv_int(&h, 1);
+        for (size_t i = 0; i < 4 * (size_t)n * n; i++) fnv_prob(&h, S->prob_field[i]);
+    } else {
+        fnv_int(&h, 0);
+        fnv_prob(&h, S->prob.up);
+        fnv_prob(&h, S->prob.down);
+        fnv_prob(&h, S->prob.left);
+        fnv_prob(&h, S->prob.right);
+    }
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            unsigned char o = S->obstacles[y][x] != 0;
+            fnv_bytes(&h, &o, 1);
+        }
+    }
+    fnv_int(&h, S->ntargets);
+    for (int i = 0; i < S->ntargets; i++) {
+        fnv_int(&h, S->targets[i].x0);
+        fnv_int(&h, S->targets[i].y0);
+        fnv_int(&h, S->targets[i].x1);
+        fnv_int(&h, S->targets[i].y1);
+    }
+    return h;
+}
+
+// Počet replikácií záznamu z hlavičky súboru (veľkosť, replikácie) bez načítania mriežok.
+static int entry_reps(const char *filepath)
+{
+    FILE *f = fopen(filepath, "r");
+    if (!f) return -1;
+    int size, reps;
+    int ok = fscanf(f, "%d %d", &size, &reps) == 2;
+    fclose(f);
+    return ok ? reps : -1;
+}
+
+int cache_lookup(const SharedState *S, uint64_t seed, char *path, size_t size,
+                 uint64_t *seed_out, int *reps_out)
+{
+    DIR *dir = opendir(SAVED_DIR "/" CACHE_DIR);
+    if (!dir) return 0;
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "%016llx_", (unsigned long long)cache_key(S));
+    size_t plen = strlen(prefix);
+    int best = -1;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) {
+        if (strncmp(e->d_name, prefix, plen) != 0) continue;
+        char *end;
+        unsigned long long s = strtoull(e->d_name + plen, &end, 16);
+        if (strcmp(end, ".txt") != 0 || (seed && s != seed)) continue;
+        char filepath[512];
+        snprintf(filepath, sizeof(filepath), "%s/%s/%s", SAVED_DIR, CACHE_DIR, e->d_name);
+        int reps = entry_reps(filepath);
+        if (reps <= best) continue;
+        best = reps;
+        snprintf(path, size, "%s/%s", CACHE_DIR, e->d_name);
+        *seed_out = s;
+        *reps_out = reps;
+    }
+    closedir(dir);
+    return best >= 0;
+}
+
+int cache_load(SharedState *S, const char *path)
+{
+    SharedState cached;
+    memset(&cached, 0, sizeof(cached));
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s", SAVED_DIR, path);
+    if (!world_load_file(&cached, filepath)) return -1;
+
+    // Kľúč je len hash: zhodu konfigurácie treba overiť celú.
+    int reps = -1;
+    if (!world_compatible(&cached, S)) {
+        printf("Warning: Cache entry '%s' does not match this configuration, ignoring it.\n", path);
+    } else {
+        int n = S->world_size;
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                S->total_steps[y][x] = cached.total_steps[y][x];
+                S->success_count[y][x] = cached.success_count[y][x];
+            }
+        }
+        for (int i = 0; i < S->ntargets; i++) S->target_hits[i] = cached.target_hits[i];
+        reps = cached.replications;
+        S->current_rep = reps;
+        if (S->replications < reps) S->replications = reps;
+    }
+    free_world(&cached);
+    return reps;
+}
+
+int cache_store(const SharedState *S)
+{
+    char path[256];
+    uint64_t seed;
+    int reps;
+    if (cache_lookup(S, S->seed, path, sizeof(path), &seed, &reps) && reps >= S->replications)
+        return 1;
+
+    mkdir(SAVED_DIR, 0755);
+    mkdir(SAVED_DIR "/" CACHE_DIR, 0755);
+    unsigned long long key = cache_key(S);
+    char filepath[512], tmp[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s/%016llx_%016llx.txt", SAVED_DIR, CACHE_DIR,
+             key, (unsigned long long)S->seed);
+    snprintf(tmp, sizeof(tmp), "%s/%s/.tmp_%d_%016llx", SAVED_DIR, CACHE_DIR, (int)getpid(), key);
+    if (!world_save_file(S, tmp)) {
+        remove(tmp);
+        return 0;
+    }
+    if (rename(tmp, filepath) != 0) {
+        printf("Error: Could not store cache entry '%s'.\n", filepath);
+        remove(tmp);
+        return 0;
+    }
+    printf("[Server] Results cached as '%s' (%d replications).\n", filepath, S->replications);
+    return 1;
+}
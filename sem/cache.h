@@ -0,0 +1,33 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Úložisko výsledkov adresované obsahom (--cache): saved/cache/<kľúč>_<seed>.txt vo formáte -o.
+// Kľúč je hash všetkého, čo určuje výsledok prechádzok: veľkosť, torus/steny, max_steps,
+// pravdepodobnosti alebo pole pravdepodobností, prekážky, ciele a verzia jadra (CACHE_VERSION).
+// Počet replikácií do kľúča nepatrí. Replikácia r sa počíta z prúdov (seed, r, bunka), takže
+// záznam s R replikáciami sa pri tom istom seede predĺži len o replikácie R.. (nové prúdy)
+// a výsledok je rovnaký ako jeden dlhší beh.
+
+#define CACHE_DIR "cache"   // podpriečinok SAVED_DIR
+// Zvýšiť pri zmene jadra, ktorá mení výsledky pre rovnaký seed (RNG, krok chodca, ...).
+#define CACHE_VERSION 1
+
+struct SharedState;
+
+// Hash konfigurácie sveta (FNV-1a; pravdepodobnosti zaokrúhlené na 6 miest ako v súboroch).
+uint64_t cache_key(const struct SharedState *S);
+// Nájde záznam pre konfiguráciu S: seed != 0 = len záznam s týmto seedom, 0 = záznam s najviac
+// replikáciami. Vráti 1 a vyplní path (relatívne k SAVED_DIR), *seed_out a *reps_out, inak 0.
+int cache_lookup(const struct SharedState *S, uint64_t seed, char *path, size_t size,
+                 uint64_t *seed_out, int *reps_out);
+// Prevezme výsledky záznamu do S (svet už je nastavený): overí zhodu konfigurácie, nastaví
+// current_rep a replikácie aspoň na počet v zázname. Vráti počet replikácií záznamu alebo -1.
+int cache_load(struct SharedState *S, const char *path);
+// Uloží dokončený beh pod kľúčom aktuálneho sveta, ak záznam s jeho seedom nemá viac replikácií.
+// Zapisuje cez dočasný súbor a rename, takže súbežné servery nevidia rozpísaný záznam. Vráti 1/0.
+int cache_store(const struct SharedState *S);
+
+#endif // CACHE_H
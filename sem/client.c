@@ -10,21 +10,32 @@
 #include <stdlib.h>
 #include <termios.h>
 #include <dirent.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
 
 #include "client.h"
 #include "ipc.h"
 #include "world.h"
 #include "utils.h"
+#include "render.h"
+#include "pyramid.h"
 
 // Klientská aplikácia: výber servera, načítanie konfigurácie a terminálové zobrazenie simulácie.
 #define RENDER_INTERVAL_MS 100
 #define MAX_SERVERS 20
 #define MAX_FILES 50
-#define SAVED_DIR "saved"
 #define CONNECT_RETRIES 50
 #define CONNECT_SLEEP_MS 100
+#define SPAWN_TIMEOUT_MS 10000 // najdlhšie čakanie na READY od spusteného servera
+#define SPAWN_MAX_ARGS 24
+#define VIEW_RESERVED_ROWS 16 // riadky obrazovky mimo mriežky (hlavička, menu)
+#define CMD_PENDING_MAX 32    // príkazy odoslané počas behu, ktoré ešte čakajú na odpoveď
 
 static volatile sig_atomic_t stop_flag = 0;
 static struct termios orig_termios;
@@ -38,56 +49,116 @@ typedef struct {
     int use_obstacles_file;
 } SimParams;
 
-typedef struct {
-    int pid;
-    char shm_name[64];
-    char sock_path[128];
-} ServerInfo;
-
 typedef struct {
     int sock_fd;
     IPCShared *ipc;
+    int from_stream;        // ipc je lokálna kópia plnená zo socketu
     int summary_view;
     pthread_mutex_t view_lock;
     int server_pid;
+
+    // Výrez a priblíženie nad pyramídou štatistík (chránené view_lock)
+    Pyramid pyr;
+    bool has_pyr;
+    int zoom;        // úroveň pyramídy (0 = jednotlivé bunky)
+    int view_x;      // ľavý horný roh výrezu v súradniciach úrovne
+    int view_y;
+    bool view_init;  // výrez ešte nebol nastavený na prehľad
+    bool show_stats; // riadok s metrikami behu (kláves m)
+    bool edit_mode;  // úprava prekážok (kláves e): kurzor a príkaz OBSTACLE
+    int cursor_x;    // kurzor v súradniciach sveta (-1 = ešte nebol umiestnený)
+    int cursor_y;
+
+    // Stopa chodca (číta a používa len vlákno vykresľovania)
+    int trail_len;            // počet starších pozícií v stope (0 = len chodec)
+    int replay_ms;            // 0 = živo, inak sa prehráva jedna pozícia za replay_ms
+    uint64_t replay_pos;      // pri prehrávaní: koniec prehranej časti stopy
+    uint64_t replay_last_ns;
+    uint64_t trail_end;       // koniec stopy v poslednej snímke (detekcia zmeny)
+    IPCTrailPoint trail[IPC_TRAIL_LEN];
+    int trail_count;          // najnovšia pozícia je trail[trail_count - 1]
+
+    // Odpovede servera prichádzajú v poradí príkazov (chránené view_lock)
+    char pending[CMD_PENDING_MAX]; // druh čakajúceho príkazu: 'm' = MODE, 'o' = OBSTACLE
+    int pending_head;
+    int pending_count;
+    char edit_status[64];          // posledná odpoveď na OBSTACLE (OK / ERR ...)
+    unsigned int edit_status_seq;  // zvyšuje sa pri novej odpovedi (prekreslenie)
 } ClientCtx;
 
 // ============ IPC HELPERS ============
 
-// Spočíta dostupné servery zo súboru so zoznamom.
-static int count_servers(ServerInfo *servers)
+// Spustí server na pozadí a počká, kým ohlási pripravenosť cez rúru (--ready-fd).
+// argv je zoznam argumentov servera ukončený NULL (bez názvu programu).
+static int spawn_server(char *const argv[], char *shm_name, char *sock_path)
 {
-    FILE *f = fopen("/tmp/pos_server_list.txt", "r");
-    if (!f) return 0;
-    
-    int count = 0;
-    while (count < MAX_SERVERS &&
-           fscanf(f, "PID=%d SHM=%63s SOCK=%127s\n",
-                  &servers[count].pid, servers[count].shm_name,
-                  servers[count].sock_path) == 3) {
-        count++;
+    int pfd[2];
+    if (pipe(pfd) != 0) return -1;
+
+    pid_t child = fork();
+    if (child < 0) {
+        close(pfd[0]);
+        close(pfd[1]);
+        return -1;
     }
-    fclose(f);
-    return count;
-}
+    if (child == 0) {
+        // Dvojitý fork: server nebude dieťaťom klienta (žiadny zombie) a má vlastnú session.
+        close(pfd[0]);
+        if (fork() != 0) _exit(0);
+        setsid();
+        int devnull = open("/dev/null", O_RDWR);
+        if (devnull >= 0) {
+            dup2(devnull, STDIN_FILENO);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            if (devnull > STDERR_FILENO) close(devnull);
+        }
 
-// Vyberie posledný (najnovší) server zo zoznamu.
-static int get_latest_server(char *shm_name, char *sock_path)
-{
-    ServerInfo servers[MAX_SERVERS];
-    int count = count_servers(servers);
-    
-    if (count == 0) return -1;
-    safe_strcpy(shm_name, servers[count - 1].shm_name, 64);
-    safe_strcpy(sock_path, servers[count - 1].sock_path, 128);
+        char fd_arg[16];
+        snprintf(fd_arg, sizeof(fd_arg), "%d", pfd[1]);
+        char *args[SPAWN_MAX_ARGS + 4];
+        int n = 0;
+        args[n++] = "./server";
+        for (int i = 0; argv[i] && n < SPAWN_MAX_ARGS; i++) args[n++] = argv[i];
+        args[n++] = "--ready-fd";
+        args[n++] = fd_arg;
+        args[n] = NULL;
+        execv("./server", args);
+        _exit(127);
+    }
+
+    close(pfd[1]);
+    waitpid(child, NULL, 0);
+
+    // Čakaj na "READY <pid>"; EOF znamená, že server zlyhal ešte pred otvorením socketu.
+    char line[64];
+    size_t len = 0;
+    struct pollfd p = { .fd = pfd[0], .events = POLLIN };
+    while (len < sizeof(line) - 1 && poll(&p, 1, SPAWN_TIMEOUT_MS) > 0) {
+        ssize_t r = read(pfd[0], line + len, sizeof(line) - 1 - len);
+        if (r <= 0) break;
+        len += (size_t)r;
+        if (memchr(line, '\n', len)) break;
+    }
+    line[len] = '\0';
+    close(pfd[0]);
+
+    int pid;
+    IPCServerEntry e;
+    if (sscanf(line, "READY %d", &pid) != 1 || ipc_registry_find(pid, &e) != 0) {
+        printf("[Client] Server failed to start.\n");
+        return -1;
+    }
+    safe_strcpy(shm_name, e.shm_name, 64);
+    safe_strcpy(sock_path, e.sock_path, 128);
     return 0;
 }
 
 // Interaktívne nechá používateľa zvoliť server na pripojenie.
 static int select_server(char *shm_name, char *sock_path)
 {
-    ServerInfo servers[MAX_SERVERS];
-    int count = count_servers(servers);
+    IPCServerEntry servers[MAX_SERVERS];
+    int count = ipc_registry_list(servers, MAX_SERVERS);
     
     if (count == 0) {
         printf("[Client] No active servers. Returning to menu...\n");
@@ -98,7 +169,8 @@ static int select_server(char *shm_name, char *sock_path)
     CLEAR_SCREEN();
     printf("Available servers:\n\n");
     for (int i = 0; i < count; i++)
-        printf("  [%d] PID: %d\n", i + 1, servers[i].pid);
+        printf("  [%d] PID: %d%s\n", i + 1, servers[i].pid,
+               strcmp(servers[i].shm_name, "-") == 0 ? " (daemon)" : "");
     printf("\nSelect [1-%d]: ", count);
     
     int choice;
@@ -275,81 +347,621 @@ static IPCShared* open_shm_retry(const char *name)
     return NULL;
 }
 
+// Prečíta presne len bajtov zo socketu. Vráti 0 alebo -1 (EOF/chyba).
+static int read_full(int fd, void *buf, size_t len)
+{
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = read(fd, (char *)buf + off, len - off);
+        if (n <= 0) return -1;
+        off += (size_t)n;
+    }
+    return 0;
+}
+
+// Prečíta jeden riadok odpovede po bajtoch, aby sa nezačali konzumovať binárne rámce.
+static int read_line(int fd, char *line, size_t size)
+{
+    size_t len = 0;
+    while (len < size - 1) {
+        if (read_full(fd, &line[len], 1) != 0) return -1;
+        if (line[len] == '\n') break;
+        len++;
+    }
+    line[len] = '\0';
+    return 0;
+}
+
+// Prihlási sa na odber stavu cez socket; vráti dohodnutý interval alebo -1.
+static int subscribe_stream(int fd, int interval_ms)
+{
+    char cmd[32];
+    snprintf(cmd, sizeof(cmd), "SUBSCRIBE %d\n", interval_ms);
+    send_cmd(fd, cmd);
+
+    char line[32];
+    if (read_line(fd, line, sizeof(line)) != 0) return -1;
+
+    int agreed;
+    if (sscanf(line, "OK %d", &agreed) != 1) return -1;
+    return agreed;
+}
+
+// Pri démonovi vypíše jeho úlohy, nechá zvoliť jednu a pripojí sa k nej (ATTACH).
+static int select_daemon_job(int fd, char *shm_name)
+{
+    disable_raw_mode(&orig_termios);
+    CLEAR_SCREEN();
+    printf("Daemon jobs:\n\n");
+
+    send_cmd(fd, "JOBS\n");
+    char line[640];
+    int jobs = 0;
+    while (read_line(fd, line, sizeof(line)) == 0 && strcmp(line, "END") != 0) {
+        printf("  %s\n", line);
+        jobs++;
+    }
+    if (jobs == 0) {
+        printf("  (none)\n");
+        enable_raw_mode(&orig_termios);
+        return -1;
+    }
+
+    printf("\nJob ID: ");
+    int id;
+    int ok = (scanf("%d", &id) == 1);
+    while (getchar() != '\n');
+    enable_raw_mode(&orig_termios);
+    if (!ok) return -1;
+
+    char cmd[32];
+    snprintf(cmd, sizeof(cmd), "ATTACH %d\n", id);
+    send_cmd(fd, cmd);
+    if (read_line(fd, line, sizeof(line)) != 0 || sscanf(line, "OK %63s", shm_name) != 1) {
+        printf("Attach failed: %s\n", line);
+        return -1;
+    }
+    return 0;
+}
+
+// Odošle príkaz počas behu a zapamätá si jeho druh, aby sa odpoveď dala priradiť.
+// Vráti -1, ak na odpoveď čaká priveľa príkazov (príkaz sa neodošle).
+static int send_tracked(ClientCtx *ctx, const char *cmd, char kind)
+{
+    pthread_mutex_lock(&ctx->view_lock);
+    if (ctx->pending_count >= CMD_PENDING_MAX) {
+        pthread_mutex_unlock(&ctx->view_lock);
+        return -1;
+    }
+    ctx->pending[(ctx->pending_head + ctx->pending_count) % CMD_PENDING_MAX] = kind;
+    ctx->pending_count++;
+    pthread_mutex_unlock(&ctx->view_lock);
+    send_cmd(ctx->sock_fd, cmd);
+    return 0;
+}
+
+// Priradí odpoveď najstaršiemu čakajúcemu príkazu; odpoveď na OBSTACLE ukáže v riadku stavu.
+static void handle_reply(ClientCtx *ctx, const char *line)
+{
+    pthread_mutex_lock(&ctx->view_lock);
+    char kind = 0;
+    if (ctx->pending_count > 0) {
+        kind = ctx->pending[ctx->pending_head];
+        ctx->pending_head = (ctx->pending_head + 1) % CMD_PENDING_MAX;
+        ctx->pending_count--;
+    }
+    if (kind == 'o') {
+        safe_strcpy(ctx->edit_status, line, sizeof(ctx->edit_status));
+        ctx->edit_status_seq++;
+    }
+    pthread_mutex_unlock(&ctx->view_lock);
+}
+
 // ============ THREADS ============
 
-// Vlákno na zobrazovanie stavu simulácie v termináli.
-static void *render_thread(void *arg)
+// Vlákno, ktoré číta textové odpovede servera (len pri zdieľanej pamäti; stream ich nesie v rámcoch).
+static void *reply_thread(void *arg)
 {
     ClientCtx *ctx = (ClientCtx *)arg;
-    int last_mode = -1, last_view = -1;
-    
+    char line[256];
+    while (!stop_flag && read_line(ctx->sock_fd, line, sizeof(line)) == 0)
+        handle_reply(ctx, line);
+    return NULL;
+}
+
+// Vlákno, ktoré prijíma rámce zo socketu a aplikuje ich na lokálnu kópiu stavu.
+static void *stream_thread(void *arg)
+{
+    ClientCtx *ctx = (ClientCtx *)arg;
+    uint8_t *payload = malloc(IPC_FRAME_MAX_PAYLOAD);
+    if (!payload) return NULL;
+
     while (!stop_flag) {
-        IPCShared *ipc = ctx->ipc;
-        if (!ipc) break;
+        IPCFrameHeader hdr;
+        if (read_full(ctx->sock_fd, &hdr, sizeof(hdr)) != 0) break;
+        if (hdr.magic != IPC_FRAME_MAGIC || hdr.payload_len > IPC_FRAME_MAX_PAYLOAD) break;
+        if (read_full(ctx->sock_fd, payload, hdr.payload_len) != 0) break;
+        if (hdr.type == IPC_FRAME_REPLY) {
+            char line[256];
+            size_t len = hdr.payload_len < sizeof(line) - 1 ? hdr.payload_len : sizeof(line) - 1;
+            memcpy(line, payload, len);
+            while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+            line[len] = '\0';
+            handle_reply(ctx, line);
+            continue;
+        }
+        if (ipc_frame_apply(ctx->ipc, &hdr, payload) != 0) break;
+    }
 
-        int n = ipc->world_size;
-        if (n <= 0 || n > IPC_MAX_WORLD) n = IPC_MAX_WORLD;
+    free(payload);
+    return NULL;
+}
 
-        pthread_mutex_lock(&ctx->view_lock);
-        int local_view = ctx->summary_view;
-        pthread_mutex_unlock(&ctx->view_lock);
+// Zapíše hodnotu bunky presne do 4 znakov (veľké čísla skráti na k/M).
+static void format_cell4(char *dst, long long v)
+{
+    char cell[32];
+    if (v < 10000) snprintf(cell, sizeof(cell), "%4lld", v);
+    else if (v < 1000000) snprintf(cell, sizeof(cell), "%3lldk", v / 1000);
+    else snprintf(cell, sizeof(cell), "%3lldM", v / 1000000 > 999 ? 999 : v / 1000000);
+    memcpy(dst, cell, 4);
+}
 
-        if (last_mode != ipc->mode || last_view != local_view) {
-            CLEAR_SCREEN();
-            last_mode = ipc->mode;
-            last_view = local_view;
-        } else {
-            MOVE_CURSOR();
+// Koľko buniek výrezu sa zmestí na terminál (šírka bunky podľa módu).
+static void viewport_capacity(int mode, int *w, int *h)
+{
+    int cols = IPC_MAX_WORLD * 4, rows = IPC_MAX_WORLD + VIEW_RESERVED_ROWS;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0) {
+        cols = ws.ws_col;
+        rows = ws.ws_row;
+    }
+    int cell_w = (mode == 1) ? 2 : 4;
+    *w = (cols - 1) / cell_w;
+    *h = rows - VIEW_RESERVED_ROWS;
+    if (*w < 1) *w = 1;
+    if (*h < 1) *h = 1;
+    if (*w > IPC_MAX_WORLD) *w = IPC_MAX_WORLD;
+    if (*h > IPC_MAX_WORLD) *h = IPC_MAX_WORLD;
+}
+
+// Obmedzí výrez na rozmer aktuálnej úrovne; vráti jeho šírku a výšku.
+static void viewport_clamp(ClientCtx *ctx, int mode, int *w, int *h)
+{
+    const PyramidHeader *ph = ctx->pyr.hdr;
+    viewport_capacity(mode, w, h);
+
+    if (!ctx->view_init) {
+        // Prehľad: najjemnejšia úroveň, ktorá sa celá zmestí na obrazovku.
+        ctx->zoom = 0;
+        while (ctx->zoom < ph->levels - 1 &&
+               (ph->dim[ctx->zoom] > *w || ph->dim[ctx->zoom] > *h))
+            ctx->zoom++;
+        ctx->view_x = ctx->view_y = 0;
+        ctx->view_init = true;
+    }
+    if (ctx->zoom < 0) ctx->zoom = 0;
+    if (ctx->zoom > ph->levels - 1) ctx->zoom = ph->levels - 1;
+
+    int dim = ph->dim[ctx->zoom];
+    if (*w > dim) *w = dim;
+    if (*h > dim) *h = dim;
+    if (ctx->view_x > dim - *w) ctx->view_x = dim - *w;
+    if (ctx->view_y > dim - *h) ctx->view_y = dim - *h;
+    if (ctx->view_x < 0) ctx->view_x = 0;
+    if (ctx->view_y < 0) ctx->view_y = 0;
+}
+
+// Zmení úroveň priblíženia so zachovaním stredu výrezu.
+static void viewport_zoom(ClientCtx *ctx, int delta)
+{
+    if (!ctx->has_pyr) return;
+    int levels = ctx->pyr.hdr->levels;
+    int nz = ctx->zoom + delta;
+    if (nz < 0 || nz >= levels) return;
+
+    int w, h;
+    viewport_capacity(ctx->ipc->mode, &w, &h);
+    int cx = ctx->view_x + w / 2;
+    int cy = ctx->view_y + h / 2;
+    if (delta > 0) { cx >>= delta; cy >>= delta; }
+    else { cx <<= -delta; cy <<= -delta; }
+    ctx->zoom = nz;
+    ctx->view_x = cx - w / 2;
+    ctx->view_y = cy - h / 2;
+}
+
+// Posunie výrez o polovicu jeho rozmeru v danom smere.
+static void viewport_pan(ClientCtx *ctx, int dx, int dy)
+{
+    if (!ctx->has_pyr) return;
+    int w, h;
+    viewport_capacity(ctx->ipc->mode, &w, &h);
+    ctx->view_x += dx * ((w + 1) / 2);
+    ctx->view_y += dy * ((h + 1) / 2);
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Načíta stopu chodca z IPC do ctx->trail. Pri prehrávaní posúva vlastný kurzor o jednu
+// pozíciu za replay_ms; keď ho zápis predbehne o celý ring, pokračuje najstaršou dostupnou.
+static void trail_snapshot(ClientCtx *ctx, const IPCShared *ipc)
+{
+    uint64_t head;
+    if (ctx->replay_ms <= 0) {
+        ctx->trail_count = ipc_trail_read(ipc, 0, ctx->trail, ctx->trail_len + 1, &head);
+        ctx->trail_end = head;
+        return;
+    }
+    head = atomic_load_explicit((atomic_ullong *)&ipc->trail_head, memory_order_acquire);
+    uint64_t now = monotonic_ns();
+    uint64_t period = (uint64_t)ctx->replay_ms * 1000000ull;
+    if (ctx->replay_last_ns == 0) ctx->replay_last_ns = now;
+    uint64_t advance = (now - ctx->replay_last_ns) / period;
+    ctx->replay_pos += advance;
+    ctx->replay_last_ns += advance * period;
+    uint64_t oldest = head > IPC_TRAIL_LEN ? head - IPC_TRAIL_LEN + 1 : 0;
+    if (ctx->replay_pos < oldest + 1) ctx->replay_pos = oldest + 1;
+    if (ctx->replay_pos > head) ctx->replay_pos = head;
+    ctx->trail_count = ipc_trail_read(ipc, ctx->replay_pos, ctx->trail, ctx->trail_len + 1, NULL);
+    ctx->trail_end = ctx->replay_pos;
+}
+
+// Blednúca stopa: čím staršia pozícia, tým slabší znak.
+static char trail_char(int age, int len)
+{
+    if (age * 3 <= len) return 'o';
+    if (age * 3 <= 2 * len) return ':';
+    return ',';
+}
+
+// Vyplní marks (w x h) znakmi chodca a stopy vo výreze od (vx, vy) na úrovni shift; novšie
+// pozície prepíšu staršie. wrap > 0 = súradnice sa zalomia ako walker_x v IPC.
+// Bez stopy (napr. stream) sa použije len poloha (wx, wy).
+static void trail_marks(const ClientCtx *ctx, char *marks, int w, int h, int vx, int vy,
+                        int shift, int wrap, int wx, int wy)
+{
+    memset(marks, 0, (size_t)w * h);
+    int count = ctx->trail_count;
+    for (int i = 0; i < (count > 0 ? count : 1); i++) {
+        int x = count > 0 ? ctx->trail[i].x : wx;
+        int y = count > 0 ? ctx->trail[i].y : wy;
+        if (wrap > 0) {
+            x %= wrap;
+            y %= wrap;
         }
+        x = (x >> shift) - vx;
+        y = (y >> shift) - vy;
+        if (x < 0 || y < 0 || x >= w || y >= h) continue;
+        int age = count > 0 ? count - 1 - i : 0;
+        marks[y * w + x] = (age == 0) ? 'W' : trail_char(age, ctx->trail_len);
+    }
+}
 
-        print_header();
+// Zloží mriežku z pyramídy: číta len bloky úrovne zoom vo výreze.
+static void compose_pyramid(Renderer *rd, ClientCtx *ctx, const IPCShared *ipc, int view)
+{
+    const Pyramid *pyr = &ctx->pyr;
+    const PyramidHeader *ph = pyr->hdr;
+    char line[IPC_MAX_WORLD * 4 + 1];
+    int w, h;
+
+    pthread_mutex_lock(&ctx->view_lock);
+    viewport_clamp(ctx, ipc->mode, &w, &h);
+    int z = ctx->zoom, vx = ctx->view_x, vy = ctx->view_y;
+    int cx = ctx->edit_mode ? ctx->cursor_x >> z : -1;  // blok s kurzorom úprav
+    int cy = ctx->edit_mode ? ctx->cursor_y >> z : -1;
+    pthread_mutex_unlock(&ctx->view_lock);
 
-        if (ctx->server_pid > 0)
-            printf("Server PID: %d\n", ctx->server_pid);
-        printf("Mode: %s | View: %s | Replication %d of %d | Completed: %s\n",
-               ipc->mode == 1 ? "interactive" : "summary",
-               local_view == 0 ? "average" : "probability",
-               ipc->current_rep, ipc->replications,
-               ipc->finished ? "yes" : "no");
-
-        if (ipc->mode == 1) {
-            printf("\n(W=walker, *=center, #=obstacle)\n");
-            for (int y = 0; y < n; y++) {
-                for (int x = 0; x < n; x++) {
-                    if (ipc->obstacles[y][x]) printf("# ");
-                    else if (y == ipc->walker_y && x == ipc->walker_x) printf("W ");
-                    else if (y == n/2 && x == n/2) printf("* ");
-                    else printf(". ");
+    int n = ph->world_size;
+    int center = n / 2;
+    render_line(rd, "Zoom: 1:%d | View: x %d-%d, y %d-%d of %d",
+                1 << z, vx << z, ((vx + w) << z) - 1 < n ? ((vx + w) << z) - 1 : n - 1,
+                vy << z, ((vy + h) << z) - 1 < n ? ((vy + h) << z) - 1 : n - 1, n);
+
+    if (ipc->mode == 1) {
+        char marks[IPC_MAX_WORLD * IPC_MAX_WORLD];
+        trail_marks(ctx, marks, w, h, vx, vy, z, 0, ph->walker_x, ph->walker_y);
+        render_line(rd, "(W=walker, o:,=trail, *=center, #=obstacle, +=partly blocked)");
+        for (int y = vy; y < vy + h; y++) {
+            char *p = line;
+            for (int x = vx; x < vx + w; x++) {
+                PyramidCell c;
+                pyramid_block(pyr, z, x, y, &c);
+                char mark = marks[(y - vy) * w + (x - vx)];
+                if (x == cx && y == cy) *p++ = '@';
+                else if (c.free_cells == 0) *p++ = '#';
+                else if (mark) *p++ = mark;
+                else if (!ipc->has_targets && (center >> z) == y && (center >> z) == x) *p++ = '*';
+                else if (c.free_cells < c.area) *p++ = '+';
+                else *p++ = '.';
+                *p++ = ' ';
+            }
+            *p = '\0';
+            render_line(rd, "%s", line);
+        }
+    } else {
+        render_line(rd, "%s:", view == 0 ? "Average steps" : "Probability (%)");
+        for (int y = vy; y < vy + h; y++) {
+            char *p = line;
+            for (int x = vx; x < vx + w; x++) {
+                PyramidCell c;
+                pyramid_block(pyr, z, x, y, &c);
+                if (x == cx && y == cy) {
+                    memcpy(p, c.free_cells == 0 ? " #@#" : "  @@", 4);
+                } else if (c.free_cells == 0) {
+                    memcpy(p, " ###", 4);
+                } else if (c.stale_cells > 0) {
+                    memcpy(p, "  ~~", 4);
+                } else if (c.success_count > 0) {
+                    long long trials = (long long)ipc->replications * c.free_cells;
+                    long long v = (view == 0) ? c.total_steps / c.success_count
+                                              : (trials > 0 ? c.success_count * 100 / trials : 0);
+                    format_cell4(p, v);
+                } else {
+                    memcpy(p, "  --", 4);
                 }
-                printf("\n");
+                p += 4;
             }
-        } else {
-            printf("\n%s:\n", local_view == 0 ? "Average steps" : "Probability (%)");
-            for (int y = 0; y < n; y++) {
-                for (int x = 0; x < n; x++) {
-                    if (ipc->obstacles[y][x]) printf(" ###");
-                    else if (ipc->success_count[y][x] > 0) {
-                        if (local_view == 0)
-                            printf("%4d", ipc->total_steps[y][x] / ipc->success_count[y][x]);
-                        else
-                            printf("%4d", (ipc->success_count[y][x] * 100) / ipc->replications);
-                    } else {
-                        printf("  --");
-                    }
+            *p = '\0';
+            render_line(rd, "%s", line);
+        }
+    }
+}
+
+// Riadok s metrikami behu: rýchlosť krokov, ETA, podiel čakania na zámok a čas publikovania.
+static void compose_stats(Renderer *rd, const ClientCtx *ctx, const IPCShared *ipc)
+{
+    if (ctx->from_stream) {
+        render_line(rd, "Metrics: n/a in stream mode (use STATS on the socket)");
+        return;
+    }
+    const IPCMetrics *m = &ipc->metrics;
+    double busy_ns = (double)m->elapsed_ns * (m->threads > 0 ? m->threads : 1);
+    double wait_pct = busy_ns > 0 ? 100.0 * m->lock_wait_ns / busy_ns : 0.0;
+    char eta[32];
+    if (m->eta_s < 0) snprintf(eta, sizeof(eta), "?");
+    else snprintf(eta, sizeof(eta), "%.0fs", m->eta_s);
+    render_line(rd, "Metrics: %d thr | steps/s 1s %.0f 10s %.0f 60s %.0f | ETA %s | lock wait %.1f%% | publish %.1f ms",
+                m->threads, m->rate_1s, m->rate_10s, m->rate_60s, eta, wait_pct, m->publish_time_ns / 1e6);
+}
+
+// Pohľady súhrnu (kláves 3): mapa obsadenosti len ak ju server zbiera (--occupancy).
+#define VIEW_OCCUPANCY 2
+#define VIEW_COUNT_BASIC 2
+#define VIEW_COUNT_OCCUPANCY 5
+static const char *const view_names[VIEW_COUNT_OCCUPANCY] = {
+    "average", "probability", "occupancy", "occupancy/success", "occupancy/failed"
+};
+
+// Návštevy bunky podľa pohľadu: všetky, len úspešné alebo len neúspešné prechádzky.
+static long long occupancy_value(const IPCShared *ipc, int view, int x, int y)
+{
+    if (view == VIEW_OCCUPANCY + 1) return ipc->occupancy[0][y][x];
+    if (view == VIEW_OCCUPANCY + 2) return ipc->occupancy[1][y][x];
+    return ipc->occupancy[0][y][x] + ipc->occupancy[1][y][x];
+}
+
+// Teplotná mapa obsadenosti: návštevy bunky v % najnavštevovanejšej bunky výrezu.
+static void compose_occupancy(Renderer *rd, const IPCShared *ipc, int n, int view, char *line)
+{
+    long long max = 0;
+    for (int y = 0; y < n; y++)
+        for (int x = 0; x < n; x++) {
+            long long v = occupancy_value(ipc, view, x, y);
+            if (v > max) max = v;
+        }
+    render_line(rd, "Occupancy, %s walks (%% of max = %lld visits):",
+                view == VIEW_OCCUPANCY + 1 ? "successful" : view == VIEW_OCCUPANCY + 2 ? "failed" : "all",
+                max);
+    for (int y = 0; y < n; y++) {
+        char *p = line;
+        for (int x = 0; x < n; x++) {
+            long long v = occupancy_value(ipc, view, x, y);
+            if (ipc->obstacles[y][x]) memcpy(p, " ###", 4);
+            else if (v > 0) format_cell4(p, max > 0 ? v * 100 / max : 0);
+            else memcpy(p, "  --", 4);
+            p += 4;
+        }
+        *p = '\0';
+        render_line(rd, "%s", line);
+    }
+}
+
+// Zloží jednu snímku obrazovky zo stavu v ipc (bez výpisu na terminál).
+static void compose_frame(Renderer *rd, ClientCtx *ctx, const IPCShared *ipc, int view)
+{
+    int n = ipc->world_size;
+    if (n <= 0 || n > IPC_MAX_WORLD) n = IPC_MAX_WORLD;
+    char line[IPC_MAX_WORLD * 4 + 1];
+    if (view >= VIEW_COUNT_BASIC && !ipc->has_occupancy) view = 0;
+
+    render_begin(rd);
+    render_line(rd, "==============================");
+    render_line(rd, "=== RANDOM WALKER - CLIENT ===");
+    render_line(rd, "==============================");
+    if (ctx->server_pid > 0)
+        render_line(rd, "Server PID: %d", ctx->server_pid);
+    char extra[160] = "";
+    if (ctx->edit_mode) {
+        char status[sizeof(ctx->edit_status)];
+        pthread_mutex_lock(&ctx->view_lock);
+        memcpy(status, ctx->edit_status, sizeof(status));
+        pthread_mutex_unlock(&ctx->view_lock);
+        snprintf(extra, sizeof(extra), " | Edit: %d,%d%s%s", ctx->cursor_x, ctx->cursor_y,
+                 status[0] ? " " : "", status);
+    }
+    if (ipc->stale_cells > 0)
+        snprintf(extra + strlen(extra), sizeof(extra) - strlen(extra), " | Recomputing: %lld (~~)",
+                 ipc->stale_cells);
+    render_line(rd, "Mode: %s | View: %s | Replication %d of %d | Completed: %s%s",
+                ipc->mode == 1 ? "interactive" : "summary",
+                view_names[view],
+                ipc->current_rep, ipc->replications,
+                ipc->finished ? "yes" : "no", extra);
+    if (ctx->show_stats) compose_stats(rd, ctx, ipc);
+    render_line(rd, "");
+
+    if (ctx->has_pyr && view < VIEW_COUNT_BASIC) {
+        compose_pyramid(rd, ctx, ipc, view);
+    } else if (ipc->mode == 1) {
+        char marks[IPC_MAX_WORLD * IPC_MAX_WORLD];
+        trail_marks(ctx, marks, n, n, 0, 0, 0, n, ipc->walker_x, ipc->walker_y);
+        render_line(rd, "(W=walker, o:,=trail, *=%s, #=obstacle)", ipc->has_targets ? "target" : "center");
+        for (int y = 0; y < n; y++) {
+            char *p = line;
+            for (int x = 0; x < n; x++) {
+                if (ctx->edit_mode && x == ctx->cursor_x && y == ctx->cursor_y) *p++ = '@';
+                else if (ipc->obstacles[y][x]) *p++ = '#';
+                else if (marks[y * n + x]) *p++ = marks[y * n + x];
+                else if (ipc->has_targets ? ipc->target[y][x] : (y == n/2 && x == n/2)) *p++ = '*';
+                else *p++ = '.';
+                *p++ = ' ';
+            }
+            *p = '\0';
+            render_line(rd, "%s", line);
+        }
+    } else if (view >= VIEW_COUNT_BASIC) {
+        compose_occupancy(rd, ipc, n, view, line);
+    } else {
+        render_line(rd, "%s:", view == 0 ? "Average steps" : "Probability (%)");
+        for (int y = 0; y < n; y++) {
+            char *p = line;
+            for (int x = 0; x < n; x++) {
+                int sc = ipc->success_count[y][x];
+                if (ctx->edit_mode && x == ctx->cursor_x && y == ctx->cursor_y) {
+                    memcpy(p, ipc->obstacles[y][x] ? " #@#" : "  @@", 4);
+                } else if (ipc->obstacles[y][x]) {
+                    memcpy(p, " ###", 4);
+                } else if (ipc->stale[y][x]) {
+                    memcpy(p, "  ~~", 4);
+                } else if (sc > 0) {
+                    int v = (view == 0) ? ipc->total_steps[y][x] / sc
+                                        : (ipc->replications > 0 ? (sc * 100) / ipc->replications : 0);
+                    format_cell4(p, v);
+                } else {
+                    memcpy(p, "  --", 4);
                 }
-                printf("\n");
+                p += 4;
             }
+            *p = '\0';
+            render_line(rd, "%s", line);
         }
+    }
+
+    render_line(rd, "");
+    render_line(rd, "[1] interactive ");
+    render_line(rd, "[2] summary ");
+    render_line(rd, "[3] view ");
+    if (ctx->has_pyr) render_line(rd, "[w/a/s/d] pan [+/-] zoom [0] overview");
+    if (ctx->edit_mode) render_line(rd, "[m] metrics [i/j/k/l] cursor [x] toggle obstacle [e] end edit");
+    else if (ipc->edits_allowed) render_line(rd, "[m] metrics [e] edit obstacles");
+    else render_line(rd, "[m] metrics");
+    render_line(rd, "[ESC] exit");
+    if (ipc->finished) render_line(rd, "[DONE]");
+}
 
-        printf("\n[1] interactive \n[2] summary \n[3] view \n[ESC] exit\n");
-        if (ipc->finished) printf("[DONE]\n");
+// Vlákno na zobrazovanie stavu simulácie v termináli.
+// Kreslí len keď sa zmenili publikované dáta (version) alebo lokálny pohľad.
+static void *render_thread(void *arg)
+{
+    ClientCtx *ctx = (ClientCtx *)arg;
+    Renderer *rd = render_create();
+    if (!rd) return NULL;
+
+    fflush(stdout);
+    bool drawn = false;
+    unsigned int last_version = 0, last_pyr_version = 0;
+    int last_view = -1, last_zoom = -1, last_vx = -1, last_vy = -1;
+    long long last_metrics = -1;
+    uint64_t last_trail = UINT64_MAX;
+    long long last_cursor = -2;
+    unsigned int last_status = 0;
+
+    while (!stop_flag) {
+        IPCShared *ipc = ctx->ipc;
+        if (!ipc) break;
+
+        pthread_mutex_lock(&ctx->view_lock);
+        int local_view = ctx->summary_view;
+        int zoom = ctx->zoom, vx = ctx->view_x, vy = ctx->view_y;
+        long long metrics = ctx->show_stats ? ipc->metrics.elapsed_ns : 0;
+        long long cursor = ctx->edit_mode ? (long long)ctx->cursor_y * INT32_MAX + ctx->cursor_x : -1;
+        unsigned int status = ctx->edit_status_seq;
+        pthread_mutex_unlock(&ctx->view_lock);
+
+        trail_snapshot(ctx, ipc);
+        unsigned int version = ipc->version;
+        unsigned int pyr_version = ctx->has_pyr ? ctx->pyr.hdr->version : 0;
+        if (!drawn || version != last_version || pyr_version != last_pyr_version ||
+            local_view != last_view || zoom != last_zoom || vx != last_vx || vy != last_vy ||
+            metrics != last_metrics || ctx->trail_end != last_trail || cursor != last_cursor ||
+            status != last_status) {
+            compose_frame(rd, ctx, ipc, local_view);
+            render_present(rd);
+            drawn = true;
+            last_version = version;
+            last_pyr_version = pyr_version;
+            last_view = local_view;
+            last_zoom = zoom;
+            last_vx = vx;
+            last_vy = vy;
+            last_metrics = metrics;
+            last_trail = ctx->trail_end;
+            last_cursor = cursor;
+            last_status = status;
+        }
 
         struct timespec ts = {0, RENDER_INTERVAL_MS * 1000000L};
         nanosleep(&ts, NULL);
     }
+
+    render_finish(rd);
+    render_destroy(rd);
     return NULL;
 }
 
+// Klávesy úpravy prekážok: e zapne/vypne kurzor, i/j/k/l ho posúvajú (o blok aktuálneho
+// priblíženia), x prepne prekážku pod kurzorom. Server úpravu aplikuje na hranici replikácie
+// a jeho odpoveď (OK / ERR ...) sa ukáže v riadku stavu.
+static void edit_key(ClientCtx *ctx, int ch)
+{
+    const IPCShared *ipc = ctx->ipc;
+    int n = ctx->has_pyr ? ctx->pyr.hdr->world_size : ipc->world_size;
+    char cmd[64] = "";
+    pthread_mutex_lock(&ctx->view_lock);
+    int step = ctx->has_pyr ? 1 << ctx->zoom : 1;
+    if (ch == 'e') {
+        ctx->edit_mode = !ctx->edit_mode;
+        ctx->edit_status[0] = '\0';
+        if (ctx->cursor_x < 0) ctx->cursor_x = ctx->cursor_y = n / 2;
+    } else if (ch == 'i') ctx->cursor_y -= step;
+    else if (ch == 'k') ctx->cursor_y += step;
+    else if (ch == 'j') ctx->cursor_x -= step;
+    else if (ch == 'l') ctx->cursor_x += step;
+    if (ctx->cursor_x < 0) ctx->cursor_x = 0;
+    if (ctx->cursor_y < 0) ctx->cursor_y = 0;
+    if (ctx->cursor_x >= n) ctx->cursor_x = n - 1;
+    if (ctx->cursor_y >= n) ctx->cursor_y = n - 1;
+    if (ch == 'x') {
+        int x = ctx->cursor_x, y = ctx->cursor_y;
+        int blocked = ctx->has_pyr ? ctx->pyr.grid[(size_t)y * n + x] : ipc->obstacles[y][x];
+        snprintf(cmd, sizeof(cmd), "OBSTACLE %d %d %d\n", x, y, !blocked);
+    }
+    pthread_mutex_unlock(&ctx->view_lock);
+    if (cmd[0] && send_tracked(ctx, cmd, 'o') != 0) {
+        pthread_mutex_lock(&ctx->view_lock);
+        safe_strcpy(ctx->edit_status, "ERR server busy", sizeof(ctx->edit_status));
+        ctx->edit_status_seq++;
+        pthread_mutex_unlock(&ctx->view_lock);
+    }
+}
+
 // Vlákno na spracovanie vstupu používateľa počas behu.
 static void *input_thread(void *arg)
 {
@@ -365,12 +977,30 @@ static void *input_thread(void *arg)
             }
             continue;
         }
-        if (ch == '1') send_cmd(ctx->sock_fd, "MODE 1\n");
-        else if (ch == '2') send_cmd(ctx->sock_fd, "MODE 2\n");
+        if (ch == '1') send_tracked(ctx, "MODE 1\n", 'm');
+        else if (ch == '2') send_tracked(ctx, "MODE 2\n", 'm');
         else if (ch == '3') {
             pthread_mutex_lock(&ctx->view_lock);
-            ctx->summary_view = 1 - ctx->summary_view;
+            int views = (ipc && ipc->has_occupancy) ? VIEW_COUNT_OCCUPANCY : VIEW_COUNT_BASIC;
+            ctx->summary_view = (ctx->summary_view + 1) % views;
+            pthread_mutex_unlock(&ctx->view_lock);
+        } else if (ch == 'm') {
+            pthread_mutex_lock(&ctx->view_lock);
+            ctx->show_stats = !ctx->show_stats;
+            pthread_mutex_unlock(&ctx->view_lock);
+        } else if (strchr("wasd+=-0", ch) && ch != '\0') {
+            pthread_mutex_lock(&ctx->view_lock);
+            if (ch == 'w') viewport_pan(ctx, 0, -1);
+            else if (ch == 's') viewport_pan(ctx, 0, 1);
+            else if (ch == 'a') viewport_pan(ctx, -1, 0);
+            else if (ch == 'd') viewport_pan(ctx, 1, 0);
+            else if (ch == '+' || ch == '=') viewport_zoom(ctx, -1);
+            else if (ch == '-') viewport_zoom(ctx, 1);
+            else if (ch == '0') ctx->view_init = false;
             pthread_mutex_unlock(&ctx->view_lock);
+        } else if ((ch == 'e' && ipc && ipc->edits_allowed) ||
+                   (ctx->edit_mode && strchr("ijklx", ch) && ch != '\0')) {
+            edit_key(ctx, ch);
         } else if (ch == 27) {
             stop_flag = 1;
             break;
@@ -382,7 +1012,7 @@ static void *input_thread(void *arg)
 // ============ MAIN ============
 
 // Hlavná slučka klienta: výber servera, spustenie vlákien a čakanie na ukončenie.
-int client_run(void)
+int client_run(const ClientConfig *config)
 {
     signal(SIGINT, handle_sigint);
     enable_raw_mode(&orig_termios);
@@ -409,18 +1039,24 @@ int client_run(void)
             SimParams p = {0};
             if (get_params(&p) != 0) continue;
             
-            char cmd[1024];
-            int n = snprintf(cmd, 1024, "./server -r %d -k %d -p %.2f %.2f %.2f %.2f -o %s",
-                p.replications, p.max_steps, p.prob_up, p.prob_down, p.prob_left, p.prob_right, p.output_file);
-            if (p.use_obstacles_file)
-                n += snprintf(cmd + n, 1024 - n, " -f %s", p.obstacles_file);
-            else
-                n += snprintf(cmd + n, 1024 - n, " -s %d", p.world_size);
-            snprintf(cmd + n, 1024 - n, " >/dev/null 2>&1 &");
-            
-            if (system(cmd) == -1) continue;
-            sleep(1);
-            if (get_latest_server(shm_name, sock_path) != 0) continue;
+            char reps[16], steps[16], pu[16], pd[16], pl[16], pr[16], size[16];
+            snprintf(reps, sizeof(reps), "%d", p.replications);
+            snprintf(steps, sizeof(steps), "%d", p.max_steps);
+            snprintf(pu, sizeof(pu), "%.2f", p.prob_up);
+            snprintf(pd, sizeof(pd), "%.2f", p.prob_down);
+            snprintf(pl, sizeof(pl), "%.2f", p.prob_left);
+            snprintf(pr, sizeof(pr), "%.2f", p.prob_right);
+            snprintf(size, sizeof(size), "%d", p.world_size);
+            char *args[] = {
+                "-r", reps, "-k", steps, "-p", pu, pd, pl, pr, "-o", p.output_file,
+                p.use_obstacles_file ? "-f" : "-s",
+                p.use_obstacles_file ? p.obstacles_file : size,
+                NULL
+            };
+            if (spawn_server(args, shm_name, sock_path) != 0) {
+                sleep(2);
+                continue;
+            }
         } else if (choice == '2') {
             if (select_server(shm_name, sock_path) != 0) {
                 sleep(2);
@@ -447,15 +1083,14 @@ int client_run(void)
             }
             while (getchar() != '\n');
             
-            char cmd[1024];
-            snprintf(cmd, 1024, "./server -l %s -r %d -o %s >/dev/null 2>&1 &", file, reps, outf);
-            if (system(cmd) == -1) {
-                enable_raw_mode(&orig_termios);
+            char reps_arg[16];
+            snprintf(reps_arg, sizeof(reps_arg), "%d", reps);
+            char *args[] = { "-l", file, "-r", reps_arg, "-o", outf, NULL };
+            enable_raw_mode(&orig_termios);
+            if (spawn_server(args, shm_name, sock_path) != 0) {
+                sleep(2);
                 continue;
             }
-            sleep(1);
-            enable_raw_mode(&orig_termios);
-            if (get_latest_server(shm_name, sock_path) != 0) continue;
         } else {
             printf("Wrong input.\n");
             sleep(1);
@@ -469,7 +1104,23 @@ int client_run(void)
             continue;
         }
 
-        ipc = open_shm_retry(shm_name);
+        // Démon nemá vlastnú shm: najprv si vyber úlohu.
+        if (strcmp(shm_name, "-") == 0 && select_daemon_job(sock_fd, shm_name) != 0) {
+            ipc_close_socket(sock_fd);
+            sleep(2);
+            continue;
+        }
+
+        if (config && config->use_stream) {
+            // Bez prístupu k shm: stav sa skladá z rámcov prijatých cez socket.
+            ipc = calloc(1, sizeof(IPCShared));
+            if (ipc && subscribe_stream(sock_fd, config->stream_interval_ms) < 0) {
+                free(ipc);
+                ipc = NULL;
+            }
+        } else {
+            ipc = open_shm_retry(shm_name);
+        }
         if (!ipc) {
             printf("Shared memory connection failed.\n");
             ipc_close_socket(sock_fd);
@@ -483,12 +1134,23 @@ int client_run(void)
         int pid = 0;
         sscanf(sock_path, "/tmp/pos_socket_%d", &pid);
 
+        bool from_stream = config && config->use_stream;
         ClientCtx ctx = {
-            .sock_fd = sock_fd, .ipc = ipc, .summary_view = 0,
-            .view_lock = PTHREAD_MUTEX_INITIALIZER, .server_pid = pid
+            .sock_fd = sock_fd, .ipc = ipc, .from_stream = from_stream,
+            .summary_view = 0,
+            .view_lock = PTHREAD_MUTEX_INITIALIZER, .server_pid = pid,
+            .show_stats = config && config->show_stats,
+            .cursor_x = -1, .cursor_y = -1,
+            .trail_len = config ? config->trail_len : 0,
+            .replay_ms = config ? config->replay_ms : 0
         };
+        // Pyramída je dostupná len cez zdieľanú pamäť (nie v stream móde).
+        if (!from_stream && ipc->pyramid_shm[0] != '\0')
+            ctx.has_pyr = (pyramid_open(ipc->pyramid_shm, &ctx.pyr) == 0);
 
-        pthread_t tr, ti;
+        // Odpovede na príkazy číta stream vlákno (rámce IPC_FRAME_REPLY) alebo samostatné vlákno.
+        pthread_t tr, ti, ts;
+        pthread_create(&ts, NULL, from_stream ? stream_thread : reply_thread, &ctx);
         pthread_create(&tr, NULL, render_thread, &ctx);
         pthread_create(&ti, NULL, input_thread, &ctx);
 
@@ -496,7 +1158,12 @@ int client_run(void)
         stop_flag = 1;
         pthread_join(tr, NULL);
 
-        ipc_close_shared(ipc);
+        // shutdown odblokuje read v stream vlákne aj vo vlákne odpovedí
+        shutdown(sock_fd, SHUT_RDWR);
+        pthread_join(ts, NULL);
+        if (from_stream) free(ipc);
+        else ipc_close_shared(ipc);
+        if (ctx.has_pyr) pyramid_close(&ctx.pyr);
         ipc_close_socket(sock_fd);
         printf("Disconnected.\n");
         sleep(1);
@@ -1,7 +1,15 @@
 #ifndef CLIENT_H
 #define CLIENT_H
 
+typedef struct ClientConfig {
+    int use_stream;         // 1 = stav čítať zo socketu (SUBSCRIBE) namiesto shm
+    int stream_interval_ms; // požadovaný interval rámcov
+    int show_stats;         // 1 = od začiatku zobrazovať riadok s metrikami behu
+    int trail_len;          // --trail: počet starších pozícií chodca v stope (0 = bez stopy)
+    int replay_ms;          // --replay: prehrávať stopu po jednej pozícii za replay_ms (0 = živo)
+} ClientConfig;
+
 // Deklarácia hlavnej funkcie pre spustenie klienta.
-int client_run(void);
+int client_run(const ClientConfig *config);
 
 #endif // CLIENT_H
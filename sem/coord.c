@@ -0,0 +1,525 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include "coord.h"
+#include "simulation.h"
+#include "world.h"
+#include "affinity.h"
+#include "ipc.h"
+#include "pyramid.h"
+#include "trace.h"
+#include "probfield.h"
+
+// Koordinátor a worker distribuovaného behu: rozsahy replikácií cez socket.
+
+#define COORD_ACCEPT_POLL_MS 200   // ako často accept slučka kontroluje koniec behu
+#define COORD_DRAIN_TIMEOUT_S 2    // čakanie na odpojenie nečinných workerov na konci
+
+typedef enum { RANGE_PENDING, RANGE_ASSIGNED, RANGE_DONE } RangeState;
+
+// Rozsah replikácií [first, first + count) a jeho stav.
+typedef struct CoordRange {
+    int first;
+    int count;
+    RangeState state;
+} CoordRange;
+
+typedef struct CoordConn {
+    struct Coordinator *C;
+    int fd;
+    int id;
+    struct CoordConn *next;
+} CoordConn;
+
+typedef struct Coordinator {
+    SharedState *S;
+    pthread_mutex_t lock;     // chráni rozsahy, počítadlá a zoznam spojení
+    pthread_cond_t cond;
+    CoordRange *ranges;
+    int nranges;
+    int done;
+    int active;               // otvorené spojenia s workermi
+    int next_id;
+    CoordConn *conns;
+    long long successes;
+    struct timespec start;
+} Coordinator;
+
+// Prečíta ďalší neprázdny riadok (po číselných blokoch ostáva v streame koniec riadku).
+static char *read_line(char *buf, int size, FILE *in)
+{
+    while (fgets(buf, size, in)) {
+        if (buf[strspn(buf, " \t\r\n")] != '\0') return buf;
+    }
+    return NULL;
+}
+
+// Vezme ďalší voľný rozsah; ak žiadny nie je, čaká (rozsah mŕtveho workera sa môže vrátiť).
+// Vráti NULL, keď sú všetky rozsahy hotové.
+static CoordRange *take_range(Coordinator *C)
+{
+    pthread_mutex_lock(&C->lock);
+    while (1) {
+        if (C->S->cancel || C->done == C->nranges) {
+            pthread_mutex_unlock(&C->lock);
+            return NULL;
+        }
+        for (int i = 0; i < C->nranges; i++) {
+            if (C->ranges[i].state == RANGE_PENDING) {
+                C->ranges[i].state = RANGE_ASSIGNED;
+                pthread_mutex_unlock(&C->lock);
+                return &C->ranges[i];
+            }
+        }
+        pthread_cond_wait(&C->cond, &C->lock);
+    }
+}
+
+// Zmení stav rozsahu a zobudí čakajúce spojenia aj hlavné vlákno koordinátora.
+static void set_range_state(Coordinator *C, CoordRange *r, RangeState state)
+{
+    pthread_mutex_lock(&C->lock);
+    r->state = state;
+    if (state == RANGE_DONE) C->done++;
+    pthread_cond_broadcast(&C->cond);
+    pthread_mutex_unlock(&C->lock);
+}
+
+// Pošle workerovi konfiguráciu behu a mapu prekážok.
+static int send_config(FILE *out, const SharedState *S)
+{
+    int n = S->world_size;
+    fprintf(out, "CONFIG %d %d %.17g %.17g %.17g %.17g %llu\n", n, S->max_steps,
+            S->prob.up, S->prob.down, S->prob.left, S->prob.right, (unsigned long long)S->seed);
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++)
+            fprintf(out, "%d ", S->obstacles[y][x] ? 1 : 0);
+        fprintf(out, "\n");
+    }
+    // Pole pravdepodobností (--prob-field) ide za prekážkami, 0 = globálny vektor z CONFIG.
+    fprintf(out, "FIELD %d\n", S->prob_field ? 1 : 0);
+    if (S->prob_field) {
+        size_t total = 4 * (size_t)n * n;
+        for (size_t i = 0; i < total; i++)
+            fprintf(out, (i % 4 == 3) ? "%.17g\n" : "%.17g ", S->prob_field[i]);
+    }
+    // Ciele (--target): počet a obdĺžniky, 0 = stred sveta.
+    fprintf(out, "TARGETS %d\n", S->ntargets);
+    for (int i = 0; i < S->ntargets; i++)
+        fprintf(out, "%d %d %d %d\n", S->targets[i].x0, S->targets[i].y0,
+                S->targets[i].x1, S->targets[i].y1);
+    return fflush(out) == 0 ? 0 : -1;
+}
+
+// Prijme výsledok rozsahu r a pripočíta ho k stavu servera. Polovičný výsledok sa nezapočíta.
+static int receive_result(Coordinator *C, FILE *in, const CoordRange *r)
+{
+    SharedState *S = C->S;
+    int n = S->world_size;
+    char line[160];
+    int first, count, cells;
+    long long steps, walks;
+
+    if (!read_line(line, sizeof(line), in)) return -1;
+    if (sscanf(line, "RESULT %d %d %lld %lld %d", &first, &count, &steps, &walks, &cells) != 5 ||
+        first != r->first || count != r->count || cells < 0 || cells > n * n)
+        return -1;
+
+    int *buf = malloc((size_t)(cells > 0 ? cells : 1) * 3 * sizeof(int));
+    if (!buf) return -1;
+    for (int i = 0; i < cells; i++) {
+        int *t = &buf[3 * i];
+        if (fscanf(in, "%d %d %d", &t[0], &t[1], &t[2]) != 3 || t[0] < 0 || t[0] >= n * n) {
+            free(buf);
+            return -1;
+        }
+    }
+    // Zásahy cieľov rozsahu (len s --target)
+    long long hits[TARGET_MAX];
+    for (int i = 0; i < S->ntargets; i++) {
+        if (fscanf(in, i == 0 ? " HITS %lld" : "%lld", &hits[i]) != 1) {
+            free(buf);
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&C->lock);
+    int active = C->active;
+    pthread_mutex_unlock(&C->lock);
+
+    TRACE_BEGIN(t0);
+    long long successes = 0;
+    pthread_mutex_lock(&S->lock);
+    for (int i = 0; i < cells; i++) {
+        const int *t = &buf[3 * i];
+        int x = t[0] % n, y = t[0] / n;
+        S->total_steps[y][x] += t[1];
+        S->success_count[y][x] += t[2];
+        if (S->pyr) pyramid_add_many(S->pyr, x, y, t[1], t[2]);
+        successes += t[2];
+    }
+    for (int i = 0; i < S->ntargets; i++) S->target_hits[i] += hits[i];
+    if (S->pyr) S->pyr->hdr->version++;
+    S->walks_done += walks;
+    S->steps_done += steps;
+    S->current_rep += count;  // počet hotových replikácií (rozsahy môžu dobiehať mimo poradia)
+
+    C->successes += successes;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    S->metrics.threads = active;  // pripojení workeri
+    S->metrics.steps = S->steps_done;
+    S->metrics.walks = S->walks_done;
+    S->metrics.successes = C->successes;
+    S->metrics.elapsed_ns = (now.tv_sec - C->start.tv_sec) * 1000000000ll +
+                            (now.tv_nsec - C->start.tv_nsec);
+    S->metrics.eta_s = -1.0;
+    if (S->ipc) S->ipc->metrics = S->metrics;
+
+    sync_stats_to_ipc(S);
+    sync_progress_to_ipc(S);
+    pthread_mutex_unlock(&S->lock);
+    TRACE_END(t0, "merge_range", first);
+
+    free(buf);
+    return 0;
+}
+
+// Obslúži jedno spojenie s workerom: pridelí rozsahy a zbiera ich výsledky.
+static void *coord_conn_thread(void *arg)
+{
+    CoordConn *cc = arg;
+    Coordinator *C = cc->C;
+    TRACE_THREAD("coord-conn");
+
+    int out_fd = dup(cc->fd);
+    FILE *in = fdopen(cc->fd, "r");
+    FILE *out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+
+    if (in && out && send_config(out, C->S) == 0) {
+        char line[64];
+        while (read_line(line, sizeof(line), in)) {
+            if (strncmp(line, "NEXT", 4) != 0) break;
+
+            CoordRange *r = take_range(C);
+            if (!r) {
+                fprintf(out, "DONE\n");
+                fflush(out);
+                break;
+            }
+            fprintf(out, "RANGE %d %d\n", r->first, r->count);
+            if (fflush(out) != 0 || receive_result(C, in, r) != 0) {
+                printf("[Coordinator] Worker %d lost, replications %d-%d will be reassigned.\n",
+                       cc->id, r->first, r->first + r->count - 1);
+                set_range_state(C, r, RANGE_PENDING);
+                break;
+            }
+            set_range_state(C, r, RANGE_DONE);
+        }
+    }
+
+    if (in) fclose(in);
+    else close(cc->fd);
+    if (out) fclose(out);
+    else if (out_fd >= 0) close(out_fd);
+
+    pthread_mutex_lock(&C->lock);
+    for (CoordConn **p = &C->conns; *p; p = &(*p)->next) {
+        if (*p == cc) {
+            *p = cc->next;
+            break;
+        }
+    }
+    C->active--;
+    pthread_cond_broadcast(&C->cond);
+    pthread_mutex_unlock(&C->lock);
+    printf("[Coordinator] Worker %d disconnected.\n", cc->id);
+    free(cc);
+    return NULL;
+}
+
+// Prijme nového workera a spustí preňho obslužné vlákno.
+static void accept_worker(Coordinator *C, int listen_fd)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    CoordConn *cc = calloc(1, sizeof(CoordConn));
+    if (!cc) {
+        close(fd);
+        return;
+    }
+    cc->C = C;
+    cc->fd = fd;
+
+    pthread_mutex_lock(&C->lock);
+    cc->id = ++C->next_id;
+    cc->next = C->conns;
+    C->conns = cc;
+    C->active++;
+    pthread_mutex_unlock(&C->lock);
+
+    pthread_t thr;
+    if (pthread_create(&thr, NULL, coord_conn_thread, cc) != 0) {
+        pthread_mutex_lock(&C->lock);
+        C->conns = cc->next;
+        C->active--;
+        pthread_mutex_unlock(&C->lock);
+        close(fd);
+        free(cc);
+        return;
+    }
+    pthread_detach(thr);
+    printf("[Coordinator] Worker %d connected.\n", cc->id);
+}
+
+// Počká, kým sa všetky spojenia ukončia; nečinných workerov po timeoute odpojí.
+static void drain_connections(Coordinator *C)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += COORD_DRAIN_TIMEOUT_S;
+
+    pthread_mutex_lock(&C->lock);
+    pthread_cond_broadcast(&C->cond);
+    while (C->active > 0) {
+        if (pthread_cond_timedwait(&C->cond, &C->lock, &deadline) != 0) {
+            for (CoordConn *cc = C->conns; cc; cc = cc->next)
+                shutdown(cc->fd, SHUT_RDWR);
+            while (C->active > 0)
+                pthread_cond_wait(&C->cond, &C->lock);
+        }
+    }
+    pthread_mutex_unlock(&C->lock);
+}
+
+// Hlavné vlákno koordinátora: rozdelí replikácie na rozsahy a prijíma workerov, kým nie sú hotové.
+void *coordinator_thread(void *arg)
+{
+    CoordArgs *A = arg;
+    SharedState *S = A->S;
+    TRACE_THREAD("coordinator");
+
+    Coordinator C;
+    memset(&C, 0, sizeof(C));
+    C.S = S;
+    pthread_mutex_init(&C.lock, NULL);
+    pthread_cond_init(&C.cond, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &C.start);
+
+    int chunk = A->chunk_reps > 0 ? A->chunk_reps : COORD_DEFAULT_CHUNK_REPS;
+    int start_rep = S->current_rep;
+    int total = S->replications - start_rep;
+    C.nranges = total > 0 ? (total + chunk - 1) / chunk : 0;
+    C.ranges = calloc(C.nranges > 0 ? C.nranges : 1, sizeof(CoordRange));
+    for (int i = 0; C.ranges && i < C.nranges; i++) {
+        C.ranges[i].first = start_rep + i * chunk;
+        C.ranges[i].count = (i == C.nranges - 1) ? total - i * chunk : chunk;
+        C.ranges[i].state = RANGE_PENDING;
+    }
+
+    int listen_fd = C.ranges ? ipc_listen_addr(A->addr) : -1;
+    if (listen_fd < 0) {
+        printf("[Coordinator] Error: could not listen on '%s'.\n", A->addr);
+    } else {
+        printf("[Coordinator] Listening on %s: %d replications in %d range(s) of up to %d.\n",
+               A->addr, total, C.nranges, chunk);
+        while (1) {
+            pthread_mutex_lock(&C.lock);
+            bool all_done = (C.done == C.nranges) || S->cancel;
+            pthread_mutex_unlock(&C.lock);
+            if (all_done) break;
+
+            struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+            if (poll(&pfd, 1, COORD_ACCEPT_POLL_MS) > 0 && (pfd.revents & POLLIN))
+                accept_worker(&C, listen_fd);
+        }
+        close(listen_fd);
+        const char *path = ipc_addr_unix_path(A->addr);
+        if (path) unlink(path);
+        drain_connections(&C);
+        printf("[Coordinator] All %d range(s) merged.\n", C.done);
+    }
+
+    pthread_mutex_lock(&S->lock);
+    S->finished = true;
+    sync_progress_to_ipc(S);
+    pthread_mutex_unlock(&S->lock);
+
+    free(C.ranges);
+    pthread_cond_destroy(&C.cond);
+    pthread_mutex_destroy(&C.lock);
+    return NULL;
+}
+
+// Načíta CONFIG od koordinátora a pripraví lokálny stav simulácie. Vráti 0 alebo -1.
+static int worker_load_config(FILE *in, SharedState *S)
+{
+    char line[256];
+    int n, max_steps;
+    unsigned long long seed;
+    if (!fgets(line, sizeof(line), in) ||
+        sscanf(line, "CONFIG %d %d %lf %lf %lf %lf %llu", &n, &max_steps,
+               &S->prob.up, &S->prob.down, &S->prob.left, &S->prob.right, &seed) != 7 ||
+        n <= 0 || max_steps <= 0)
+        return -1;
+
+    S->world_size = n;
+    S->max_steps = max_steps;
+    S->seed = seed;
+    allocate_world(S);
+    if (!S->grid_block) return -1;
+    initialize_world(S);
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            if (fscanf(in, "%d", &S->obstacles[y][x]) != 1) {
+                free_world(S);
+                return -1;
+            }
+            if (S->obstacles[y][x]) S->use_obstacles = true;
+        }
+    }
+    int has_field = 0;
+    if (fscanf(in, " FIELD %d", &has_field) != 1) {
+        free_world(S);
+        return -1;
+    }
+    if (has_field) {
+        size_t total = 4 * (size_t)n * n;
+        if (!probfield_alloc(S)) {
+            free_world(S);
+            return -1;
+        }
+        for (size_t i = 0; i < total; i++) {
+            if (fscanf(in, "%lf", &S->prob_field[i]) != 1) {
+                free_world(S);
+                return -1;
+            }
+        }
+        if (!probfield_build(S)) {
+            free_world(S);
+            return -1;
+        }
+    }
+    TargetRect targets[TARGET_MAX];
+    int ntargets = 0;
+    if (fscanf(in, " TARGETS %d", &ntargets) != 1 || ntargets < 0 || ntargets > TARGET_MAX) {
+        free_world(S);
+        return -1;
+    }
+    for (int i = 0; i < ntargets; i++) {
+        if (fscanf(in, "%d %d %d %d", &targets[i].x0, &targets[i].y0,
+                   &targets[i].x1, &targets[i].y1) != 4) {
+            free_world(S);
+            return -1;
+        }
+    }
+    if (target_setup(S, targets, ntargets) != 0) {
+        free_world(S);
+        return -1;
+    }
+    return 0;
+}
+
+// Hlavná funkcia workera: pýta si rozsahy, počíta ich lokálne a posiela späť čiastkové súčty.
+int worker_run(const ServerConfig *config)
+{
+    TRACE_START();
+    signal(SIGPIPE, SIG_IGN); // odpojený koordinátor sa prejaví chybou zápisu
+
+    int cpu_list[AFFINITY_MAX_CPUS];
+    int ncpus = server_cpu_plan(config, cpu_list, AFFINITY_MAX_CPUS);
+    if (ncpus < 0) return 1;
+
+    int fd = ipc_connect_addr(config->worker_addr);
+    if (fd < 0) {
+        printf("Error: Could not connect to coordinator '%s'.\n", config->worker_addr);
+        return 1;
+    }
+    int out_fd = dup(fd);
+    FILE *in = fdopen(fd, "r");
+    FILE *out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    if (!in || !out) {
+        printf("Error: Could not set up the coordinator connection.\n");
+        if (in) fclose(in);
+        else close(fd);
+        if (out) fclose(out);
+        else if (out_fd >= 0) close(out_fd);
+        return 1;
+    }
+
+    SharedState S;
+    memset(&S, 0, sizeof(S));
+    if (worker_load_config(in, &S) != 0) {
+        printf("Error: Invalid configuration from coordinator.\n");
+        fclose(in);
+        fclose(out);
+        return 1;
+    }
+    S.mode = 2;
+    S.threads = config->threads > 0 ? config->threads : 1;
+    S.batch = config->batch;
+    S.cpus = ncpus > 0 ? cpu_list : NULL;
+    S.ncpus = ncpus;
+    pthread_mutex_init(&S.lock, NULL);
+
+    int n = S.world_size;
+    size_t cells = (size_t)n * n;
+    printf("[Worker] Connected to %s: world %dx%d, %d max steps, %d thread(s).\n",
+           config->worker_addr, n, n, S.max_steps, S.threads);
+
+    int rc = 1, ranges = 0;
+    char line[64];
+    while (1) {
+        fprintf(out, "NEXT\n");
+        if (fflush(out) != 0 || !read_line(line, sizeof(line), in)) break;
+        if (strncmp(line, "DONE", 4) == 0) {
+            rc = 0;
+            break;
+        }
+        int first, count;
+        if (sscanf(line, "RANGE %d %d", &first, &count) != 2 || first < 0 || count <= 0) break;
+
+        // Každý rozsah začína s prázdnymi štatistikami; prúdy sú dané (seed, replikácia, bunka).
+        memset(S.grid_block + cells, 0, 2 * cells * sizeof(int));
+        S.current_rep = first;
+        S.replications = first + count;
+        S.walks_done = 0;
+        S.steps_done = 0;
+        S.finished = false;
+        if (S.ntargets > 0) memset(S.target_hits, 0, S.ntargets * sizeof(long long));
+        simulation_thread(&S);
+
+        int nonzero = 0;
+        for (size_t i = 0; i < cells; i++)
+            if (S.grid_block[2 * cells + i] > 0) nonzero++;
+        fprintf(out, "RESULT %d %d %lld %lld %d\n", first, count, S.steps_done, S.walks_done, nonzero);
+        for (size_t i = 0; i < cells; i++) {
+            int sc = S.grid_block[2 * cells + i];
+            if (sc > 0) fprintf(out, "%zu %d %d\n", i, S.grid_block[cells + i], sc);
+        }
+        if (S.ntargets > 0) {
+            fprintf(out, "HITS");
+            for (int i = 0; i < S.ntargets; i++) fprintf(out, " %lld", S.target_hits[i]);
+            fprintf(out, "\n");
+        }
+        if (fflush(out) != 0) break;
+        ranges++;
+        printf("[Worker] Replications %d-%d done.\n", first, first + count - 1);
+    }
+
+    printf("[Worker] %s after %d range(s).\n", rc == 0 ? "Finished" : "Connection lost", ranges);
+    fclose(in);
+    fclose(out);
+    pthread_mutex_destroy(&S.lock);
+    free_world(&S);
+    return rc;
+}
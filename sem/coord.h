@@ -0,0 +1,28 @@
+#ifndef COORD_H
+#define COORD_H
+
+#include "server.h"
+
+// Koordinátor rozdeľuje replikácie jedného behu medzi procesy workerov (--worker)
+// a ich čiastkové štatistiky zlučuje do stavu servera, ktorý publikuje bežné IPC.
+//
+// Protokol (textové riadky, po CONFIG/RESULT nasledujú čísla oddelené medzerami):
+//   K -> W  CONFIG <n> <max_steps> <up> <down> <left> <right> <seed>  + n*n čísel prekážok
+//   W -> K  NEXT
+//   K -> W  RANGE <first> <count>   alebo   DONE
+//   W -> K  RESULT <first> <count> <steps> <walks> <cells>  + cells trojíc "bunka kroky úspechy"
+
+#define COORD_DEFAULT_CHUNK_REPS 10
+
+typedef struct CoordArgs {
+    SharedState *S;
+    char addr[128];    // "unix:/cesta", "tcp:host:port" alebo cesta UNIX socketu
+    int chunk_reps;    // replikácií v jednom rozsahu (0 = COORD_DEFAULT_CHUNK_REPS)
+} CoordArgs;
+
+// Náhrada simulation_thread: beží, kým workeri neodovzdajú všetky rozsahy.
+void *coordinator_thread(void *arg);
+// Worker (--worker <adresa>): počíta pridelené rozsahy, kým koordinátor nepošle DONE.
+int worker_run(const ServerConfig *config);
+
+#endif // COORD_H
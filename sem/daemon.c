@@ -0,0 +1,655 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "daemon.h"
+#include "simulation.h"
+#include "walker.h"
+#include "world.h"
+#include "ipc.h"
+#include "pyramid.h"
+#include "netloop.h"
+#include "utils.h"
+#include "trace.h"
+
+// Démon servera: fronta úloh s prioritami, bazén pracovných vlákien a príkazy cez socket.
+#define DAEMON_KEEP_FINISHED 64   // koľko dokončených úloh si drží shm pre pozorovateľov
+#define DAEMON_POLL_MS 100
+#define DAEMON_MAX_WORLD 16384
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+    JOB_CANCELLED
+} JobState;
+
+static const char *job_state_name[] = { "queued", "running", "done", "failed", "cancelled" };
+
+typedef struct Job {
+    int id;
+    int priority;          // vyššie číslo = skôr
+    JobState state;
+    ServerConfig cfg;      // world_size, replications, max_steps, prob_*, output_file
+    int *map;              // n * n prekážok (NULL = torus bez prekážok)
+    SharedState *S;        // stav počas behu a po ňom, kým ho démon neuvoľní
+    Pyramid pyr;
+    bool has_pyr;
+    char shm_name[64];
+    char pyr_name[64];
+    char result_path[512];
+    double run_s;
+} Job;
+
+struct JobDraft {
+    Job *job;
+    int rows_read;         // koľko riadkov mapy už prišlo
+};
+
+struct Daemon {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Job **jobs;            // index = id - 1
+    int count;
+    int capacity;
+    int workers;
+    pthread_t *threads;
+    bool stopping;
+    pid_t pid;
+};
+
+static volatile sig_atomic_t daemon_signal = 0;
+
+static void handle_stop_signal(int sig) { (void)sig; daemon_signal = 1; }
+
+// Rozdiel dvoch časov v sekundách.
+static double elapsed_s(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+// ============ ÚLOHY ============
+
+// Vyberie ďalšiu úlohu: najvyššia priorita, v rámci nej najstaršia. Volá sa pod d->lock.
+static Job *pick_next_job(Daemon *d)
+{
+    Job *best = NULL;
+    for (int i = 0; i < d->count; i++) {
+        Job *j = d->jobs[i];
+        if (j->state != JOB_QUEUED) continue;
+        if (!best || j->priority > best->priority) best = j;
+    }
+    return best;
+}
+
+// Uvoľní IPC a pamäť stavu úlohy (úloha už nebeží).
+static void job_release_state(Job *j, SharedState *S)
+{
+    if (!S) return;
+    free_world(S);
+    if (j->has_pyr) {
+        pyramid_close(&j->pyr);
+        pyramid_unlink(j->pyr_name);
+        j->has_pyr = false;
+    }
+    if (S->ipc) {
+        ipc_close_shared(S->ipc);
+        ipc_unlink_shared(j->shm_name);
+    }
+    pthread_mutex_destroy(&S->lock);
+    free(S);
+}
+
+// Pripraví stav simulácie úlohy vrátane zdieľanej pamäte pre pozorovateľov.
+static SharedState *job_prepare(Daemon *d, Job *j)
+{
+    SharedState *S = calloc(1, sizeof(SharedState));
+    if (!S) return NULL;
+
+    S->world_size = j->cfg.world_size;
+    S->replications = j->cfg.replications;
+    S->max_steps = j->cfg.max_steps;
+    S->prob.up = j->cfg.prob_up;
+    S->prob.down = j->cfg.prob_down;
+    S->prob.left = j->cfg.prob_left;
+    S->prob.right = j->cfg.prob_right;
+    S->use_obstacles = (j->map != NULL);
+    S->threads = 1; // paralelizmus démona je medzi úlohami, nie v nich
+    S->seed = walk_rng_mix((uint64_t)time(NULL) ^ ((uint64_t)d->pid << 32) ^ (uint64_t)j->id);
+    S->mode = 2;
+    S->summary_view = 0;
+
+    allocate_world(S);
+    initialize_world(S);
+    if (j->map) {
+        for (int y = 0; y < S->world_size; y++)
+            memcpy(S->obstacles[y], j->map + (size_t)y * S->world_size, S->world_size * sizeof(int));
+    }
+    walker_init(&S->walker, S->world_size / 2, S->world_size / 2);
+    pthread_mutex_init(&S->lock, NULL);
+
+    snprintf(j->shm_name, sizeof(j->shm_name), "/pos_shm_%d_%d", (int)d->pid, j->id);
+    snprintf(j->pyr_name, sizeof(j->pyr_name), "/pos_pyr_%d_%d", (int)d->pid, j->id);
+
+    IPCShared *ipc = NULL;
+    if (ipc_create_shared(j->shm_name, &ipc) == 0) {
+        S->ipc = ipc;
+        if (pyramid_create(j->pyr_name, S->world_size, &j->pyr) == 0) {
+            world_rebind(S, j->pyr.grid);
+            pyramid_rebuild(&j->pyr);
+            j->has_pyr = true;
+            S->pyr = &j->pyr;
+            safe_strcpy(ipc->pyramid_shm, j->pyr_name, sizeof(ipc->pyramid_shm));
+        }
+        sync_obstacles_to_ipc(S);
+        sync_stats_to_ipc(S);
+        sync_basic_to_ipc(S);
+    } else {
+        j->shm_name[0] = '\0';
+    }
+    return S;
+}
+
+// Spustí úlohu na aktuálnom pracovnom vlákne až do konca (alebo zrušenia).
+static void run_job(Daemon *d, Job *j)
+{
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    SharedState *S = job_prepare(d, j);
+    if (!S) {
+        pthread_mutex_lock(&d->lock);
+        j->state = JOB_FAILED;
+        pthread_mutex_unlock(&d->lock);
+        return;
+    }
+
+    pthread_mutex_lock(&d->lock);
+    j->S = S; // od teraz sa k úlohe dá pripojiť
+    pthread_mutex_unlock(&d->lock);
+
+    TRACE_BEGIN(job_t0);
+    simulation_thread(S);
+    TRACE_END(job_t0, "job", j->id);
+
+    bool ok = true;
+    if (!S->cancel && j->cfg.output_file[0] != '\0') {
+        TRACE_BEGIN(save_t0);
+        ok = save_simulation_results(S, j->cfg.output_file);
+        TRACE_END(save_t0, "save_results", j->id);
+        if (ok)
+            snprintf(j->result_path, sizeof(j->result_path), "%s/%s", SAVED_DIR, j->cfg.output_file);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    pthread_mutex_lock(&d->lock);
+    j->run_s = elapsed_s(&t0, &t1);
+    j->state = S->cancel ? JOB_CANCELLED : (ok ? JOB_DONE : JOB_FAILED);
+    pthread_mutex_unlock(&d->lock);
+
+    printf("[Daemon] Job %d %s in %.2f s.\n", j->id, job_state_name[j->state], j->run_s);
+}
+
+// Pracovné vlákno bazéna: berie úlohy z fronty, kým démon nekončí.
+static void *worker_thread(void *arg)
+{
+    Daemon *d = arg;
+    while (1) {
+        pthread_mutex_lock(&d->lock);
+        Job *j = NULL;
+        while (!d->stopping && !(j = pick_next_job(d)))
+            pthread_cond_wait(&d->cond, &d->lock);
+        if (d->stopping) {
+            pthread_mutex_unlock(&d->lock);
+            return NULL;
+        }
+        j->state = JOB_RUNNING;
+        pthread_mutex_unlock(&d->lock);
+
+        run_job(d, j);
+    }
+}
+
+// Zaradí hotový návrh úlohy do fronty a vráti jej ID.
+static int enqueue_job(Daemon *d, Job *j)
+{
+    pthread_mutex_lock(&d->lock);
+    if (d->count == d->capacity) {
+        int cap = d->capacity ? d->capacity * 2 : 32;
+        Job **jobs = realloc(d->jobs, cap * sizeof(Job *));
+        if (!jobs) {
+            pthread_mutex_unlock(&d->lock);
+            return -1;
+        }
+        d->jobs = jobs;
+        d->capacity = cap;
+    }
+    j->id = d->count + 1;
+    j->state = JOB_QUEUED;
+    d->jobs[d->count++] = j;
+    pthread_cond_signal(&d->cond);
+    pthread_mutex_unlock(&d->lock);
+    return j->id;
+}
+
+static void job_free(Job *j)
+{
+    if (!j) return;
+    free(j->map);
+    free(j);
+}
+
+// ============ PRÍKAZY ============
+
+// Nájde úlohu podľa ID. Volá sa pod d->lock.
+static Job *find_job(Daemon *d, int id)
+{
+    return (id >= 1 && id <= d->count) ? d->jobs[id - 1] : NULL;
+}
+
+// Naformátuje stavový riadok úlohy. Volá sa pod d->lock.
+static void format_job(const Job *j, char *buf, size_t size)
+{
+    int rep = 0;
+    if (j->S) {
+        pthread_mutex_lock(&j->S->lock);
+        rep = j->S->current_rep;
+        pthread_mutex_unlock(&j->S->lock);
+    } else if (j->state == JOB_DONE) {
+        rep = j->cfg.replications;
+    }
+    snprintf(buf, size, "JOB %d %s prio=%d size=%d rep=%d/%d steps=%d shm=%s result=%s\n",
+             j->id, job_state_name[j->state], j->priority, j->cfg.world_size,
+             rep, j->cfg.replications, j->cfg.max_steps,
+             (j->S && j->shm_name[0]) ? j->shm_name : "-",
+             j->result_path[0] ? j->result_path : "-");
+}
+
+// Rozparsuje parametre SUBMIT (kľúč=hodnota) do novej úlohy.
+static Job *parse_submit(const char *args, int *map_rows)
+{
+    Job *j = calloc(1, sizeof(Job));
+    if (!j) return NULL;
+    j->cfg.world_size = 10;
+    j->cfg.replications = 1000;
+    j->cfg.max_steps = 100;
+    j->cfg.prob_up = j->cfg.prob_down = j->cfg.prob_left = j->cfg.prob_right = 0.25;
+    *map_rows = 0;
+
+    char buf[1024];
+    safe_strcpy(buf, args, sizeof(buf));
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        char *eq = strchr(tok, '=');
+        if (!eq) goto bad;
+        *eq = '\0';
+        const char *key = tok, *val = eq + 1;
+        if (!strcmp(key, "size")) j->cfg.world_size = atoi(val);
+        else if (!strcmp(key, "reps")) j->cfg.replications = atoi(val);
+        else if (!strcmp(key, "steps")) j->cfg.max_steps = atoi(val);
+        else if (!strcmp(key, "prio")) j->priority = atoi(val);
+        else if (!strcmp(key, "out")) safe_strcpy(j->cfg.output_file, val, sizeof(j->cfg.output_file));
+        else if (!strcmp(key, "map")) *map_rows = atoi(val);
+        else if (!strcmp(key, "prob")) {
+            if (sscanf(val, "%lf,%lf,%lf,%lf", &j->cfg.prob_up, &j->cfg.prob_down,
+                       &j->cfg.prob_left, &j->cfg.prob_right) != 4) goto bad;
+        } else goto bad;
+    }
+
+    if (*map_rows > 0) j->cfg.world_size = *map_rows;
+    if (j->cfg.world_size <= 0 || j->cfg.world_size > DAEMON_MAX_WORLD ||
+        j->cfg.replications <= 0 || j->cfg.max_steps <= 0 || *map_rows < 0) goto bad;
+    if (strchr(j->cfg.output_file, '/')) goto bad; // výsledky len do saved/
+    return j;
+
+bad:
+    free(j);
+    return NULL;
+}
+
+// Má event loop skončiť?
+bool daemon_stopping(Daemon *d)
+{
+    pthread_mutex_lock(&d->lock);
+    bool stop = d->stopping;
+    pthread_mutex_unlock(&d->lock);
+    return stop;
+}
+
+// Spracuje príkaz démona: SUBMIT, JOBS, STATUS, RESULT, ATTACH, CANCEL, SHUTDOWN.
+bool daemon_command(Daemon *d, const char *line, JobDraft **draft, SharedState **attach,
+                    DaemonReplyFn reply, void *ctx)
+{
+    char cmd[16] = {0};
+    int id = 0;
+    char out[640];
+    if (sscanf(line, "%15s", cmd) != 1) return false;
+
+    if (!strcmp(cmd, "SUBMIT")) {
+        int rows = 0;
+        Job *j = parse_submit(line + strlen("SUBMIT"), &rows);
+        if (!j) {
+            reply(ctx, "ERR bad job\n");
+            return true;
+        }
+        if (rows == 0) {
+            int new_id = enqueue_job(d, j);
+            if (new_id < 0) {
+                job_free(j);
+                reply(ctx, "ERR no mem\n");
+                return true;
+            }
+            snprintf(out, sizeof(out), "OK %d\n", new_id);
+            reply(ctx, out);
+            return true;
+        }
+        // Mapa prekážok príde v nasledujúcich riadkoch.
+        j->map = calloc((size_t)rows * rows, sizeof(int));
+        *draft = calloc(1, sizeof(JobDraft));
+        if (!j->map || !*draft) {
+            job_free(j);
+            free(*draft);
+            *draft = NULL;
+            reply(ctx, "ERR no mem\n");
+            return true;
+        }
+        (*draft)->job = j;
+        return true;
+    }
+
+    if (!strcmp(cmd, "JOBS")) {
+        pthread_mutex_lock(&d->lock);
+        for (int i = 0; i < d->count; i++) {
+            format_job(d->jobs[i], out, sizeof(out));
+            reply(ctx, out);
+        }
+        pthread_mutex_unlock(&d->lock);
+        reply(ctx, "END\n");
+        return true;
+    }
+
+    if (!strcmp(cmd, "SHUTDOWN")) {
+        pthread_mutex_lock(&d->lock);
+        d->stopping = true;
+        pthread_mutex_unlock(&d->lock);
+        reply(ctx, "OK\n");
+        return true;
+    }
+
+    if (strcmp(cmd, "STATUS") && strcmp(cmd, "RESULT") &&
+        strcmp(cmd, "ATTACH") && strcmp(cmd, "CANCEL"))
+        return false;
+
+    if (sscanf(line, "%*s %d", &id) != 1) {
+        reply(ctx, "ERR\n");
+        return true;
+    }
+
+    pthread_mutex_lock(&d->lock);
+    Job *j = find_job(d, id);
+    if (!j) {
+        snprintf(out, sizeof(out), "ERR no such job\n");
+    } else if (!strcmp(cmd, "STATUS")) {
+        format_job(j, out, sizeof(out));
+    } else if (!strcmp(cmd, "RESULT")) {
+        if (j->state != JOB_DONE) snprintf(out, sizeof(out), "ERR job %s\n", job_state_name[j->state]);
+        else if (!j->result_path[0]) snprintf(out, sizeof(out), "ERR no output file\n");
+        else snprintf(out, sizeof(out), "RESULT %d %s\n", j->id, j->result_path);
+    } else if (!strcmp(cmd, "ATTACH")) {
+        if (!j->S || !j->S->ipc) {
+            bool released = j->state != JOB_QUEUED && j->state != JOB_RUNNING;
+            snprintf(out, sizeof(out), "ERR job %s\n", released ? "released" : job_state_name[j->state]);
+        } else {
+            *attach = j->S;
+            snprintf(out, sizeof(out), "OK %s\n", j->shm_name);
+        }
+    } else { // CANCEL
+        if (j->state == JOB_QUEUED) {
+            j->state = JOB_CANCELLED;
+            snprintf(out, sizeof(out), "OK\n");
+        } else if (j->state == JOB_RUNNING && j->S) {
+            j->S->cancel = 1;
+            snprintf(out, sizeof(out), "OK\n");
+        } else {
+            snprintf(out, sizeof(out), "ERR job %s\n", job_state_name[j->state]);
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+    reply(ctx, out);
+    return true;
+}
+
+// Prijme ďalší riadok mapy prekážok (n čísel 0/1) pre rozpracovaný SUBMIT.
+void daemon_draft_line(Daemon *d, JobDraft **draft, const char *line,
+                       DaemonReplyFn reply, void *ctx)
+{
+    JobDraft *dr = *draft;
+    Job *j = dr->job;
+    int n = j->cfg.world_size;
+    int *row = j->map + (size_t)dr->rows_read * n;
+
+    const char *p = line;
+    for (int x = 0; x < n; x++) {
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p || (v != 0 && v != 1)) {
+            reply(ctx, "ERR bad map row\n");
+            daemon_draft_free(dr);
+            *draft = NULL;
+            return;
+        }
+        row[x] = (int)v;
+        p = end;
+    }
+
+    if (++dr->rows_read < n) return;
+
+    // Stred (cieľ) nesmie byť zablokovaný, rovnako ako pri load_obstacles.
+    j->map[(size_t)(n / 2) * n + n / 2] = 0;
+    dr->job = NULL;
+    daemon_draft_free(dr);
+    *draft = NULL;
+
+    char out[32];
+    int id = enqueue_job(d, j);
+    if (id < 0) {
+        job_free(j);
+        reply(ctx, "ERR no mem\n");
+        return;
+    }
+    snprintf(out, sizeof(out), "OK %d\n", id);
+    reply(ctx, out);
+}
+
+void daemon_draft_free(JobDraft *draft)
+{
+    if (!draft) return;
+    job_free(draft->job);
+    free(draft);
+}
+
+// Uvoľní stav najstarších dokončených úloh nad limit DAEMON_KEEP_FINISHED.
+void daemon_reap(Daemon *d, void (*detach)(void *ctx, SharedState *S), void *ctx)
+{
+    while (1) {
+        pthread_mutex_lock(&d->lock);
+        int retained = 0;
+        Job *oldest = NULL;
+        for (int i = 0; i < d->count; i++) {
+            Job *j = d->jobs[i];
+            if (!j->S || j->state == JOB_RUNNING || j->state == JOB_QUEUED) continue;
+            if (!oldest) oldest = j;
+            retained++;
+        }
+        if (retained <= DAEMON_KEEP_FINISHED) {
+            pthread_mutex_unlock(&d->lock);
+            return;
+        }
+        SharedState *S = oldest->S;
+        oldest->S = NULL;
+        pthread_mutex_unlock(&d->lock);
+
+        detach(ctx, S);
+        job_release_state(oldest, S);
+    }
+}
+
+// ============ BEH DÉMONA ============
+
+// Hlavná funkcia démona: socket, bazén pracovníkov, čakanie na ukončenie.
+int daemon_run(const ServerConfig *config)
+{
+    Daemon d;
+    memset(&d, 0, sizeof(d));
+    pthread_mutex_init(&d.lock, NULL);
+    pthread_cond_init(&d.cond, NULL);
+    d.pid = getpid();
+
+    d.workers = config->workers;
+    if (d.workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        d.workers = cpus > 0 ? (int)cpus : 1;
+    }
+
+    TRACE_START(); // pred vznikom ďalších vlákien (maska SIGUSR2)
+    srand(time(NULL));
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    char sock_path[128];
+    snprintf(sock_path, sizeof(sock_path), "/tmp/pos_socket_%d", (int)d.pid);
+
+    printf("Starting daemon:\n");
+    printf("  Workers = %d\n", d.workers);
+    printf("  Server PID = %d\n", (int)d.pid);
+    printf("  Socket path = %s\n", sock_path);
+
+    SocketThreadArgs *sock_args = malloc(sizeof(SocketThreadArgs));
+    d.threads = malloc(d.workers * sizeof(pthread_t));
+    if (!sock_args || !d.threads) {
+        printf("Chyba: nepodarilo sa alokovať pamäť pre démona.\n");
+        free(sock_args);
+        free(d.threads);
+        return 1;
+    }
+    sock_args->S = NULL;
+    sock_args->daemon = &d;
+    sock_args->sock_path = strdup(sock_path);
+    // Démon nemá vlastnú shm; klient si zvolí úlohu cez JOBS/ATTACH.
+    safe_strcpy(sock_args->shm_name, "-", sizeof(sock_args->shm_name));
+    sock_args->ready_fd = config->ready_fd;
+
+    pthread_t sock_thr;
+    pthread_create(&sock_thr, NULL, socket_thread, sock_args);
+    for (int i = 0; i < d.workers; i++)
+        pthread_create(&d.threads[i], NULL, worker_thread, &d);
+
+    while (!daemon_stopping(&d)) {
+        if (daemon_signal) {
+            pthread_mutex_lock(&d.lock);
+            d.stopping = true;
+            pthread_mutex_unlock(&d.lock);
+            break;
+        }
+        struct timespec ts = {0, DAEMON_POLL_MS * 1000000L};
+        nanosleep(&ts, NULL);
+    }
+
+    // Ukončenie: zruš bežiace úlohy, zobuď čakajúcich pracovníkov a počkaj na všetkých.
+    printf("[Daemon] Shutting down...\n");
+    pthread_mutex_lock(&d.lock);
+    for (int i = 0; i < d.count; i++) {
+        if (d.jobs[i]->state == JOB_RUNNING && d.jobs[i]->S) d.jobs[i]->S->cancel = 1;
+    }
+    pthread_cond_broadcast(&d.cond);
+    pthread_mutex_unlock(&d.lock);
+
+    for (int i = 0; i < d.workers; i++)
+        pthread_join(d.threads[i], NULL);
+    pthread_join(sock_thr, NULL);
+
+    for (int i = 0; i < d.count; i++) {
+        job_release_state(d.jobs[i], d.jobs[i]->S);
+        job_free(d.jobs[i]);
+    }
+    free(d.jobs);
+    free(d.threads);
+    pthread_cond_destroy(&d.cond);
+    pthread_mutex_destroy(&d.lock);
+    return 0;
+}
+
+// ============ SUBMIT (klientská strana) ============
+
+// Odošle úlohu bežiacemu démonovi a vypíše pridelené ID.
+int daemon_submit(const ServerConfig *config)
+{
+    char sock_path[128];
+    snprintf(sock_path, sizeof(sock_path), "/tmp/pos_socket_%d", config->submit_pid);
+
+    int n = config->world_size;
+    int *map = NULL;
+    if (config->obstacles_file[0] != '\0') {
+        n = get_world_size_from_obstacles(config->obstacles_file);
+        FILE *f = fopen(config->obstacles_file, "r");
+        map = (n > 0 && f) ? malloc((size_t)n * n * sizeof(int)) : NULL;
+        int size = 0;
+        bool ok = map && fscanf(f, "%d", &size) == 1;
+        for (size_t i = 0; ok && i < (size_t)n * n; i++)
+            ok = fscanf(f, "%d", &map[i]) == 1;
+        if (f) fclose(f);
+        if (!ok) {
+            printf("Error: Could not read obstacles file '%s'.\n", config->obstacles_file);
+            free(map);
+            return 1;
+        }
+    }
+
+    int fd = ipc_connect_socket(sock_path);
+    if (fd < 0) {
+        printf("Error: Could not connect to daemon %d.\n", config->submit_pid);
+        free(map);
+        return 1;
+    }
+
+    FILE *sock = fdopen(fd, "r+");
+    if (!sock) {
+        printf("Error: Could not open connection to daemon %d.\n", config->submit_pid);
+        close(fd);
+        free(map);
+        return 1;
+    }
+    fprintf(sock, "SUBMIT size=%d reps=%d steps=%d prob=%f,%f,%f,%f prio=%d map=%d",
+            n, config->replications, config->max_steps,
+            config->prob_up, config->prob_down, config->prob_left, config->prob_right,
+            config->priority, map ? n : 0);
+    if (config->output_file[0] != '\0') fprintf(sock, " out=%s", config->output_file);
+    fputc('\n', sock);
+    for (int y = 0; map && y < n; y++) {
+        for (int x = 0; x < n; x++)
+            fprintf(sock, "%d ", map[(size_t)y * n + x] ? 1 : 0);
+        fputc('\n', sock);
+    }
+    fflush(sock);
+    free(map);
+
+    char line[128];
+    line[0] = '\0';
+    int id = -1;
+    if (!fgets(line, sizeof(line), sock)) {
+        printf("Error: Daemon %d closed connection without a reply.\n", config->submit_pid);
+    } else if (sscanf(line, "OK %d", &id) == 1) {
+        printf("%d\n", id);
+    } else {
+        printf("Error: Daemon rejected the job: %s", line);
+    }
+    fclose(sock);
+    return id > 0 ? 0 : 1;
+}
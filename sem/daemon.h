@@ -0,0 +1,33 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stdbool.h>
+#include "server.h"
+
+// Dlhožijúci démon: fronta úloh s prioritami a pevný bazén pracovných vlákien.
+// Úlohy (konfigurácia + mapa prekážok) prichádzajú cez socket príkazom SUBMIT.
+typedef struct Daemon Daemon;
+typedef struct JobDraft JobDraft;
+
+// Zápis textovej odpovede klientovi.
+typedef void (*DaemonReplyFn)(void *ctx, const char *text);
+
+// Spustí server v móde démona (--daemon).
+int daemon_run(const ServerConfig *config);
+// Odošle úlohu bežiacemu démonovi (--submit <pid>) a vypíše pridelené ID.
+int daemon_submit(const ServerConfig *config);
+
+// Rozhranie pre event loop (netloop.c).
+bool daemon_stopping(Daemon *d);
+// Spracuje príkaz démona. Vráti false, ak príkaz démonovi nepatrí (MODE, SUMMARY, ...).
+// Pri ATTACH vráti cez *attach stav úlohy, ku ktorej sa má spojenie pripojiť.
+bool daemon_command(Daemon *d, const char *line, JobDraft **draft, SharedState **attach,
+                    DaemonReplyFn reply, void *ctx);
+// Prijme ďalší riadok mapy prekážok pre rozpracovaný SUBMIT.
+void daemon_draft_line(Daemon *d, JobDraft **draft, const char *line,
+                       DaemonReplyFn reply, void *ctx);
+void daemon_draft_free(JobDraft *draft);
+// Uvoľní stav najstarších dokončených úloh; detach najprv odpojí ich pozorovateľov.
+void daemon_reap(Daemon *d, void (*detach)(void *ctx, SharedState *S), void *ctx);
+
+#endif // DAEMON_H
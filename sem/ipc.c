@@ -6,9 +6,15 @@
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <dirent.h>
 
 // Správa zdieľanej pamäte a UNIX socketov pre komunikáciu server-klient.
 // Vytvorí zdieľanú pamäť a vynuluje ju.
@@ -37,6 +43,37 @@ int ipc_create_shared(const char *name, IPCShared **out)
 	return 0;
 }
 
+// Zapíše ďalšiu pozíciu chodca do stopy (jediný zapisovateľ, bez zámku).
+void ipc_trail_push(IPCShared *ipc, int x, int y)
+{
+	unsigned long long h = atomic_load_explicit(&ipc->trail_head, memory_order_relaxed);
+	IPCTrailPoint *p = &ipc->trail[h % IPC_TRAIL_LEN];
+	p->x = x;
+	p->y = y;
+	atomic_store_explicit(&ipc->trail_head, h + 1, memory_order_release);
+}
+
+// Skopíruje posledné pozície stopy pred end; po kópii zahodí tie, ktoré zapisovateľ mohol prepísať.
+int ipc_trail_read(const IPCShared *ipc, uint64_t end, IPCTrailPoint *out, int max, uint64_t *head)
+{
+	uint64_t h1 = atomic_load_explicit((atomic_ullong *)&ipc->trail_head, memory_order_acquire);
+	if (head) *head = h1;
+	if (end == 0 || end > h1) end = h1;
+	if (max > IPC_TRAIL_LEN) max = IPC_TRAIL_LEN;
+	uint64_t start = end > (uint64_t)max ? end - max : 0;
+	if (h1 > IPC_TRAIL_LEN && start < h1 - IPC_TRAIL_LEN) start = h1 - IPC_TRAIL_LEN;
+	for (uint64_t i = start; i < end; i++)
+		out[i - start] = ipc->trail[i % IPC_TRAIL_LEN];
+
+	atomic_thread_fence(memory_order_acquire);
+	uint64_t h2 = atomic_load_explicit((atomic_ullong *)&ipc->trail_head, memory_order_relaxed);
+	uint64_t valid = start;
+	if (h2 >= IPC_TRAIL_LEN && h2 - IPC_TRAIL_LEN + 1 > valid) valid = h2 - IPC_TRAIL_LEN + 1;
+	if (valid >= end) return 0;
+	if (valid > start) memmove(out, out + (valid - start), (end - valid) * sizeof(IPCTrailPoint));
+	return (int)(end - valid);
+}
+
 // Otvorí existujúcu zdieľanú pamäť (len čítanie alebo aj zápis).
 int ipc_open_shared(const char *name, IPCShared **out, bool writeable)
 {
@@ -87,7 +124,7 @@ int ipc_listen_socket(const char *path)
 		return -1;
 	}
 
-	if (listen(fd, 8) == -1) {
+	if (listen(fd, IPC_LISTEN_BACKLOG) == -1) {
 		close(fd);
 		return -1;
 	}
@@ -95,6 +132,118 @@ int ipc_listen_socket(const char *path)
 	return fd;
 }
 
+// Cesta k záznamu servera v registri.
+static void registry_path(int pid, char *buf, size_t size)
+{
+	snprintf(buf, size, "%s/%d", IPC_REGISTRY_DIR, pid);
+}
+
+// Zapíše záznam servera atomicky (dočasný súbor + rename), takže čitateľ nikdy nevidí polovičný riadok.
+int ipc_registry_add(int pid, const char *shm_name, const char *sock_path)
+{
+	if (!shm_name || !sock_path) return -1;
+	if (mkdir(IPC_REGISTRY_DIR, 01777) == 0)
+		chmod(IPC_REGISTRY_DIR, 01777); // umask by inak vzal ostatným právo zápisu
+	else if (errno != EEXIST)
+		return -1;
+
+	char tmp[128], path[128];
+	snprintf(tmp, sizeof(tmp), "%s/.%d.tmp", IPC_REGISTRY_DIR, pid);
+	registry_path(pid, path, sizeof(path));
+
+	FILE *f = fopen(tmp, "w");
+	if (!f) return -1;
+	fprintf(f, "PID=%d SHM=%s SOCK=%s\n", pid, shm_name, sock_path);
+	if (fclose(f) != 0 || rename(tmp, path) != 0) {
+		unlink(tmp);
+		return -1;
+	}
+	return 0;
+}
+
+// Odstráni záznam servera z registra.
+int ipc_registry_remove(int pid)
+{
+	char path[128];
+	registry_path(pid, path, sizeof(path));
+	return (unlink(path) == 0 || errno == ENOENT) ? 0 : -1;
+}
+
+// Načíta jeden záznam registra.
+static int registry_read(const char *path, IPCServerEntry *out)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) return -1;
+	int ok = fscanf(f, "PID=%d SHM=%63s SOCK=%107s", &out->pid, out->shm_name, out->sock_path) == 3;
+	fclose(f);
+	return ok ? 0 : -1;
+}
+
+// Beží ešte proces s daným PID?
+static bool process_alive(int pid)
+{
+	return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Uprace po mŕtvom serveri: záznam, socket a všetky jeho segmenty /pos_*_<pid>[_*].
+static void registry_cleanup(const IPCServerEntry *e)
+{
+	ipc_registry_remove(e->pid);
+	unlink(e->sock_path);
+
+	DIR *dir = opendir("/dev/shm");
+	if (!dir) return;
+	struct dirent *ent;
+	while ((ent = readdir(dir)) != NULL) {
+		int owner = -1;
+		if (strncmp(ent->d_name, "pos_", 4) != 0) continue;
+		if (sscanf(ent->d_name, "pos_%*[a-z]_%d", &owner) != 1 || owner != e->pid) continue;
+		char name[300];
+		snprintf(name, sizeof(name), "/%s", ent->d_name);
+		shm_unlink(name);
+	}
+	closedir(dir);
+}
+
+// Nájde živý server podľa PID. Vráti 0 alebo -1 (neexistuje/nebeží).
+int ipc_registry_find(int pid, IPCServerEntry *out)
+{
+	char path[128];
+	registry_path(pid, path, sizeof(path));
+	if (!out || registry_read(path, out) != 0) return -1;
+	if (!process_alive(out->pid)) {
+		registry_cleanup(out);
+		return -1;
+	}
+	return 0;
+}
+
+static int entry_cmp(const void *a, const void *b)
+{
+	return ((const IPCServerEntry *)a)->pid - ((const IPCServerEntry *)b)->pid;
+}
+
+// Vypíše živé servery (zoradené podľa PID); záznamy mŕtvych procesov cestou odstráni.
+int ipc_registry_list(IPCServerEntry *out, int max)
+{
+	if (!out || max <= 0) return 0;
+	DIR *dir = opendir(IPC_REGISTRY_DIR);
+	if (!dir) return 0;
+
+	int count = 0;
+	struct dirent *ent;
+	while (count < max && (ent = readdir(dir)) != NULL) {
+		char *end;
+		long pid = strtol(ent->d_name, &end, 10);
+		if (end == ent->d_name || *end != '\0') continue; // ".", "..", dočasné súbory
+		if (ipc_registry_find((int)pid, &out[count]) == 0)
+			count++;
+	}
+	closedir(dir);
+	qsort(out, count, sizeof(IPCServerEntry), entry_cmp);
+	return count;
+}
+
 // Prijme nové pripojenie na počúvajúcom sockete.
 int ipc_accept_socket(int listen_fd)
 {
@@ -122,8 +271,280 @@ int ipc_connect_socket(const char *path)
 	return fd;
 }
 
+// Rozdelí "tcp:host:port" na host a port (host "" alebo "*" = všetky rozhrania).
+static int split_tcp_addr(const char *addr, char *host, size_t host_size, const char **port)
+{
+	const char *rest = addr + 4;
+	const char *colon = strrchr(rest, ':');
+	if (!colon || colon[1] == '\0') return -1;
+	size_t len = (size_t)(colon - rest);
+	if (len >= host_size) return -1;
+	memcpy(host, rest, len);
+	host[len] = '\0';
+	if (strcmp(host, "*") == 0) host[0] = '\0';
+	*port = colon + 1;
+	return 0;
+}
+
+// Cesta UNIX socketu pre adresu ("unix:/cesta" alebo "/cesta"), NULL pre TCP.
+const char *ipc_addr_unix_path(const char *addr)
+{
+	if (!addr || strncmp(addr, "tcp:", 4) == 0) return NULL;
+	return strncmp(addr, "unix:", 5) == 0 ? addr + 5 : addr;
+}
+
+// Počúva na adrese "unix:/cesta", "tcp:host:port" alebo priamo na ceste UNIX socketu.
+int ipc_listen_addr(const char *addr)
+{
+	if (!addr) return -1;
+	const char *path = ipc_addr_unix_path(addr);
+	if (path) return ipc_listen_socket(path);
+
+	char host[256];
+	const char *port;
+	if (split_tcp_addr(addr, host, sizeof(host), &port) != 0) return -1;
+
+	struct addrinfo hints, *res = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+	if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res) != 0) return -1;
+
+	int fd = -1;
+	for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd == -1) continue;
+		int one = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, IPC_LISTEN_BACKLOG) == 0)
+			break;
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	return fd;
+}
+
+// Pripojí sa na adresu v rovnakom tvare ako ipc_listen_addr.
+// Pri TCP zapne keepalive, aby sa mŕtvy vzdialený stroj časom prejavil ako chyba spojenia.
+int ipc_connect_addr(const char *addr)
+{
+	if (!addr) return -1;
+	const char *path = ipc_addr_unix_path(addr);
+	if (path) return ipc_connect_socket(path);
+
+	char host[256];
+	const char *port;
+	if (split_tcp_addr(addr, host, sizeof(host), &port) != 0) return -1;
+
+	struct addrinfo hints, *res = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host[0] ? host : "127.0.0.1", port, &hints, &res) != 0) return -1;
+
+	int fd = -1;
+	for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd == -1) continue;
+		if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			int one = 1;
+			setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+			break;
+		}
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	return fd;
+}
+
 // Zavrie otvorený socket.
 void ipc_close_socket(int fd)
 {
 	if (fd >= 0) close(fd);
 }
+
+// Zapíše nezáporné číslo ako LEB128 varint.
+static uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+	while (v >= 0x80) {
+		*p++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+
+// Prečíta LEB128 varint; vráti NULL pri prekročení konca bufferu.
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *out)
+{
+	uint32_t v = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (p >= end) return NULL;
+		uint8_t b = *p++;
+		v |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) {
+			*out = v;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Bity bunky pre stream (prekážka, cieľ, prepočítavaná bunka).
+static uint32_t cell_bits(const IPCShared *s, int x, int y)
+{
+	return (s->obstacles[y][x] ? IPC_CELL_OBSTACLE : 0) | (s->target[y][x] ? IPC_CELL_TARGET : 0) |
+	       (s->stale[y][x] ? IPC_CELL_STALE : 0);
+}
+
+static void set_cell_bits(IPCShared *s, int x, int y, uint32_t bits)
+{
+	s->obstacles[y][x] = (bits & IPC_CELL_OBSTACLE) != 0;
+	s->target[y][x] = (bits & IPC_CELL_TARGET) != 0;
+	s->stale[y][x] = (bits & IPC_CELL_STALE) != 0;
+}
+
+static int32_t frame_flags(const IPCShared *s)
+{
+	return (s->has_targets ? IPC_FRAME_HAS_TARGETS : 0) |
+	       (s->edits_allowed ? IPC_FRAME_EDITS_ALLOWED : 0);
+}
+
+// Zakóduje rámec zo snímky cur voči naposledy odoslanej prev (prev sa aktualizuje).
+int ipc_frame_encode(const IPCShared *cur, IPCShared *prev, bool key, uint32_t seq,
+		     IPCFrameHeader *hdr, uint8_t *payload)
+{
+	if (!cur || !prev || !hdr || !payload) return -1;
+	int n = cur->world_size;
+	if (n < 0 || n > IPC_MAX_WORLD) return -1;
+	if (n != prev->world_size) key = true;
+
+	bool meta_changed = key ||
+		cur->walker_x != prev->walker_x || cur->walker_y != prev->walker_y ||
+		cur->mode != prev->mode || cur->summary_view != prev->summary_view ||
+		cur->current_rep != prev->current_rep ||
+		cur->replications != prev->replications ||
+		cur->finished != prev->finished ||
+		cur->has_targets != prev->has_targets ||
+		cur->edits_allowed != prev->edits_allowed ||
+		cur->stale_cells != prev->stale_cells;
+
+	uint8_t *p = payload;
+	int last = -1;
+	for (int y = 0; y < n; y++) {
+		for (int x = 0; x < n; x++) {
+			uint32_t bits = cell_bits(cur, x, y);
+			int ts = cur->total_steps[y][x];
+			int sc = cur->success_count[y][x];
+			if (key) {
+				p = put_varint(p, bits);
+				p = put_varint(p, (uint32_t)ts);
+				p = put_varint(p, (uint32_t)sc);
+			} else if (bits != cell_bits(prev, x, y) ||
+				   ts != prev->total_steps[y][x] ||
+				   sc != prev->success_count[y][x]) {
+				int idx = y * n + x;
+				p = put_varint(p, (uint32_t)(idx - last - 1));
+				p = put_varint(p, bits);
+				p = put_varint(p, zigzag(ts - prev->total_steps[y][x]));
+				p = put_varint(p, zigzag(sc - prev->success_count[y][x]));
+				last = idx;
+			} else {
+				continue;
+			}
+			set_cell_bits(prev, x, y, bits);
+			prev->total_steps[y][x] = ts;
+			prev->success_count[y][x] = sc;
+		}
+	}
+
+	if (!key && !meta_changed && p == payload) return -1;
+
+	prev->world_size = n;
+	prev->walker_x = cur->walker_x;
+	prev->walker_y = cur->walker_y;
+	prev->mode = cur->mode;
+	prev->summary_view = cur->summary_view;
+	prev->current_rep = cur->current_rep;
+	prev->replications = cur->replications;
+	prev->finished = cur->finished;
+	prev->has_targets = cur->has_targets;
+	prev->edits_allowed = cur->edits_allowed;
+	prev->stale_cells = cur->stale_cells;
+
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic = IPC_FRAME_MAGIC;
+	hdr->type = key ? IPC_FRAME_KEY : IPC_FRAME_DELTA;
+	hdr->world_size = (uint16_t)n;
+	hdr->seq = seq;
+	hdr->payload_len = (uint32_t)(p - payload);
+	hdr->walker_x = cur->walker_x;
+	hdr->walker_y = cur->walker_y;
+	hdr->mode = cur->mode;
+	hdr->summary_view = cur->summary_view;
+	hdr->current_rep = cur->current_rep;
+	hdr->replications = cur->replications;
+	hdr->finished = cur->finished;
+	hdr->flags = frame_flags(cur);
+	hdr->stale_cells = (int32_t)cur->stale_cells;
+	return (int)hdr->payload_len;
+}
+
+// Aplikuje prijatý rámec na lokálnu kópiu stavu.
+int ipc_frame_apply(IPCShared *dst, const IPCFrameHeader *hdr, const uint8_t *payload)
+{
+	if (!dst || !hdr || hdr->magic != IPC_FRAME_MAGIC) return -1;
+	int n = hdr->world_size;
+	if (n > IPC_MAX_WORLD || hdr->payload_len > IPC_FRAME_MAX_PAYLOAD) return -1;
+	if (hdr->type == IPC_FRAME_DELTA && n != dst->world_size) return -1;
+
+	const uint8_t *p = payload;
+	const uint8_t *end = payload + hdr->payload_len;
+	uint32_t ob, ts, sc, gap;
+
+	if (hdr->type == IPC_FRAME_KEY) {
+		for (int i = 0; i < n * n; i++) {
+			if (!(p = get_varint(p, end, &ob)) ||
+			    !(p = get_varint(p, end, &ts)) ||
+			    !(p = get_varint(p, end, &sc))) return -1;
+			set_cell_bits(dst, i % n, i / n, ob);
+			dst->total_steps[i / n][i % n] = (int)ts;
+			dst->success_count[i / n][i % n] = (int)sc;
+		}
+	} else if (hdr->type == IPC_FRAME_DELTA) {
+		int idx = -1;
+		while (p < end) {
+			if (!(p = get_varint(p, end, &gap)) ||
+			    !(p = get_varint(p, end, &ob)) ||
+			    !(p = get_varint(p, end, &ts)) ||
+			    !(p = get_varint(p, end, &sc))) return -1;
+			idx += (int)gap + 1;
+			if (idx >= n * n) return -1;
+			set_cell_bits(dst, idx % n, idx / n, ob);
+			dst->total_steps[idx / n][idx % n] += unzigzag(ts);
+			dst->success_count[idx / n][idx % n] += unzigzag(sc);
+		}
+	} else {
+		return -1;
+	}
+
+	dst->world_size = n;
+	dst->walker_x = hdr->walker_x;
+	dst->walker_y = hdr->walker_y;
+	dst->mode = hdr->mode;
+	dst->summary_view = hdr->summary_view;
+	dst->current_rep = hdr->current_rep;
+	dst->replications = hdr->replications;
+	dst->finished = hdr->finished;
+	dst->has_targets = (hdr->flags & IPC_FRAME_HAS_TARGETS) != 0;
+	dst->edits_allowed = (hdr->flags & IPC_FRAME_EDITS_ALLOWED) != 0;
+	dst->stale_cells = hdr->stale_cells;
+	dst->version++;
+	return 0;
+}
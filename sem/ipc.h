@@ -4,11 +4,44 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 
 #define IPC_MAX_WORLD 64
+// Dĺžka fronty čakajúcich spojení (veľa pozorovateľov naraz).
+#define IPC_LISTEN_BACKLOG 512
 
 // Zdieľaná štruktúra prenosu stavu medzi serverom a klientom.
+#define IPC_METRICS_THREADS 64
+
+// Metriky behu simulácie; server ich obnovuje zhruba každých 100 ms.
+typedef struct IPCMetrics {
+	int threads;
+	long long steps;
+	long long walks;
+	long long successes;
+	long long lock_wait_ns;    // súčet čakania simulačných vlákien na S->lock
+	long long publish_time_ns; // čas strávený kopírovaním štatistík do IPC
+	long long elapsed_ns;      // od začiatku behu simulácie
+	double rate_1s;            // kroky/s v kĺzavých oknách
+	double rate_10s;
+	double rate_60s;
+	double eta_s;              // odhad zostávajúceho času (-1 = neznámy)
+	long long thread_steps[IPC_METRICS_THREADS];
+	long long thread_lock_wait_ns[IPC_METRICS_THREADS];
+} IPCMetrics;
+
+// Stopa interaktívneho chodca: kruhový buffer s jediným zapisovateľom (vlákno chodca).
+// Čitateľ si skopíruje posledné pozície a podľa trail_head zahodí tie, ktoré medzitým prepísal
+// zápis (ipc_trail_read). Súradnice sú skutočné súradnice sveta.
+#define IPC_TRAIL_LEN 1024
+
+typedef struct IPCTrailPoint {
+	int32_t x;
+	int32_t y;
+} IPCTrailPoint;
+
 typedef struct IPCShared {
 	int world_size;
 	int walker_x;
@@ -18,21 +51,101 @@ typedef struct IPCShared {
 	int replications;
 	int summary_view; // 0 = average steps, 1 = probability
 	int finished;
+	int has_occupancy;    // 1 = server zbiera mapu obsadenosti (pole occupancy je platné)
+	int has_targets;      // 1 = cieľom nie je stred, ale bunky označené v target
+	int edits_allowed;    // 1 = server prijíma OBSTACLE (klient ukáže klávesy úprav)
+	unsigned int version; // zvyšuje sa pri každej publikácii (klient kreslí len pri zmene)
+	uint64_t publish_ns;  // CLOCK_MONOTONIC poslednej publikácie (meranie oneskorenia pozorovateľov)
+	long long steps_done; // kroky odsimulované v tomto behu, aktualizované po replikáciách
+	long long stale_cells; // bunky, ktoré sa po úprave prekážok (OBSTACLE) ešte prepočítavajú
+	IPCMetrics metrics;
+	char pyramid_shm[32]; // názov segmentu s pyramídou štatistík (prázdny = nie je)
+	atomic_ullong trail_head;  // počet zapísaných pozícií stopy (nikdy neklesá)
+	IPCTrailPoint trail[IPC_TRAIL_LEN];
 	int obstacles[IPC_MAX_WORLD][IPC_MAX_WORLD];
+	unsigned char target[IPC_MAX_WORLD][IPC_MAX_WORLD]; // 1 = cieľová bunka (--target)
+	unsigned char stale[IPC_MAX_WORLD][IPC_MAX_WORLD];  // 1 = výsledok bunky sa prepočítava
 	int total_steps[IPC_MAX_WORLD][IPC_MAX_WORLD];
 	int success_count[IPC_MAX_WORLD][IPC_MAX_WORLD];
+	long long occupancy[2][IPC_MAX_WORLD][IPC_MAX_WORLD]; // návštevy: [0] úspešné, [1] neúspešné prechádzky
 } IPCShared;
 
+// Binárny stream stavu cez socket (príkaz SUBSCRIBE <interval_ms>).
+// Každý rámec = IPCFrameHeader + payload_len bajtov. Kľúčový rámec nesie
+// všetky bunky (bity bunky, total_steps, success_count ako varinty),
+// rozdielový len zmenené bunky (medzera v indexe, bity bunky, zigzag rozdiely).
+// Bity bunky: IPC_CELL_OBSTACLE | IPC_CELL_TARGET | IPC_CELL_STALE.
+#define IPC_FRAME_MAGIC 0x47534F50u /* "POSG" */
+#define IPC_FRAME_KEY 1
+#define IPC_FRAME_DELTA 2
+#define IPC_FRAME_REPLY 3  // textová odpoveď na príkaz odberateľa (payload = riadok)
+#define IPC_CELL_OBSTACLE 1
+#define IPC_CELL_TARGET 2
+#define IPC_CELL_STALE 4   // výsledok bunky sa po úprave prekážok prepočítava
+// Príznaky v IPCFrameHeader.flags
+#define IPC_FRAME_HAS_TARGETS 1
+#define IPC_FRAME_EDITS_ALLOWED 2
+#define IPC_FRAME_MAX_PAYLOAD (IPC_MAX_WORLD * IPC_MAX_WORLD * 16)
+
+typedef struct IPCFrameHeader {
+	uint32_t magic;
+	uint16_t type;
+	uint16_t world_size;
+	uint32_t seq;
+	uint32_t payload_len;
+	int32_t walker_x;
+	int32_t walker_y;
+	int32_t mode;
+	int32_t summary_view;
+	int32_t current_rep;
+	int32_t replications;
+	int32_t finished;
+	int32_t flags;        // IPC_FRAME_HAS_TARGETS | IPC_FRAME_EDITS_ALLOWED
+	int32_t stale_cells;  // bunky, ktoré sa ešte prepočítavajú (OBSTACLE)
+} IPCFrameHeader;
+
+// Zakóduje rámec zo snímky cur voči naposledy odoslanej prev (prev sa aktualizuje).
+// Vráti dĺžku payloadu, alebo -1 ak rozdielový rámec nenesie žiadnu zmenu.
+int ipc_frame_encode(const IPCShared *cur, IPCShared *prev, bool key, uint32_t seq,
+		     IPCFrameHeader *hdr, uint8_t *payload);
+// Aplikuje prijatý rámec na lokálnu kópiu stavu. Vráti 0 alebo -1 pri chybe.
+int ipc_frame_apply(IPCShared *dst, const IPCFrameHeader *hdr, const uint8_t *payload);
+
+// Zapíše ďalšiu pozíciu chodca do stopy (volá len vlákno chodca, bez zámku).
+void ipc_trail_push(IPCShared *ipc, int x, int y);
+// Skopíruje pozície [end - max, end) stopy, ktoré ešte nie sú prepísané (najstaršia prvá);
+// end = 0 znamená po najnovšiu. Vráti počet skopírovaných a v *head počet zapísaných celkovo.
+int ipc_trail_read(const IPCShared *ipc, uint64_t end, IPCTrailPoint *out, int max, uint64_t *head);
+
 // Zdieľaná pamäť
 int ipc_create_shared(const char *name, IPCShared **out);
 int ipc_open_shared(const char *name, IPCShared **out, bool writeable);
 void ipc_close_shared(IPCShared *ptr);
 int ipc_unlink_shared(const char *name);
 
+// Register bežiacich serverov: jeden súbor na server v IPC_REGISTRY_DIR.
+#define IPC_REGISTRY_DIR "/tmp/pos_servers"
+
+typedef struct IPCServerEntry {
+	int pid;
+	char shm_name[64];   // "-" = démon (každá úloha má vlastnú shm)
+	char sock_path[108];
+} IPCServerEntry;
+
+int ipc_registry_add(int pid, const char *shm_name, const char *sock_path);
+int ipc_registry_remove(int pid);
+int ipc_registry_find(int pid, IPCServerEntry *out);
+int ipc_registry_list(IPCServerEntry *out, int max);
+
 // Sockety
 int ipc_listen_socket(const char *path);
 int ipc_accept_socket(int listen_fd);
 int ipc_connect_socket(const char *path);
 void ipc_close_socket(int fd);
 
+// Adresy "unix:/cesta", "tcp:host:port" alebo holá cesta UNIX socketu (koordinátor/worker).
+int ipc_listen_addr(const char *addr);
+int ipc_connect_addr(const char *addr);
+const char *ipc_addr_unix_path(const char *addr);
+
 #endif // IPC_H
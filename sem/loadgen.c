@@ -0,0 +1,360 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "loadgen.h"
+#include "ipc.h"
+#include "utils.h"
+
+// Generátor záťaže: syntetickí klienti posielajú MODE/SUMMARY a čítajú snímku IPCShared,
+// merá sa čas odozvy príkazov, oneskorenie snímky a spomalenie simulácie servera.
+#define LOADGEN_POLL_US 1000
+#define LOADGEN_CONNECT_TIMEOUT_S 5.0
+
+typedef struct SampleBuf {
+    double *v;
+    int count;
+    int capacity;
+} SampleBuf;
+
+typedef struct LoadClient {
+    pthread_t thread;
+    int fd;
+    const IPCShared *ipc;
+    const LoadgenConfig *config;
+    atomic_bool *stop;
+    SampleBuf rtt_us;       // odozva príkazov
+    SampleBuf stale_ms;     // vek snímky v momente, keď klient uvidel novú verziu
+    long long commands;
+    long long errors;
+} LoadClient;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_us(long us)
+{
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static void samples_add(SampleBuf *b, double v)
+{
+    if (b->count == b->capacity) {
+        int cap = b->capacity ? b->capacity * 2 : 1024;
+        double *nv = realloc(b->v, cap * sizeof(double));
+        if (!nv) return;
+        b->v = nv;
+        b->capacity = cap;
+    }
+    b->v[b->count++] = v;
+}
+
+static void samples_append(SampleBuf *dst, const SampleBuf *src)
+{
+    for (int i = 0; i < src->count; i++) samples_add(dst, src->v[i]);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil podľa najbližšieho poradia (pole musí byť zoradené); 0 pri prázdnom poli.
+static double percentile(const SampleBuf *b, double p)
+{
+    if (b->count == 0) return 0.0;
+    int idx = (int)(p * b->count + 0.999999) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= b->count) idx = b->count - 1;
+    return b->v[idx];
+}
+
+// Prečíta jeden riadok odpovede servera. Vráti 0 alebo -1.
+static int read_reply(int fd, char *line, size_t size)
+{
+    size_t len = 0;
+    while (len < size - 1) {
+        ssize_t n = read(fd, &line[len], 1);
+        if (n <= 0) return -1;
+        if (line[len] == '\n') break;
+        len++;
+    }
+    line[len] = '\0';
+    return 0;
+}
+
+// Pošle príkaz a počká na odpoveď; vráti 0 pri "OK", inak -1.
+static int command(int fd, const char *cmd, char *reply, size_t size)
+{
+    size_t len = strlen(cmd);
+    if (write(fd, cmd, len) != (ssize_t)len) return -1;
+    if (read_reply(fd, reply, size) != 0) return -1;
+    return strncmp(reply, "OK", 2) == 0 ? 0 : -1;
+}
+
+// Pripojí sa k socketu servera (pri démonovi aj k úlohe).
+static int connect_client(const char *sock_path, int job)
+{
+    int fd = ipc_connect_socket(sock_path);
+    if (fd < 0 || job <= 0) return fd;
+
+    char cmd[32], reply[128];
+    snprintf(cmd, sizeof(cmd), "ATTACH %d\n", job);
+    if (command(fd, cmd, reply, sizeof(reply)) != 0) {
+        ipc_close_socket(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Syntetický klient: striedavo MODE/SUMMARY (bez zmeny stavu) a čítanie celej snímky.
+static void *client_thread(void *arg)
+{
+    LoadClient *c = arg;
+    IPCShared *snap = malloc(sizeof(IPCShared));
+    if (!snap) return NULL;
+    unsigned int last_version = c->ipc->version;
+    char cmd[32], reply[64] = "";
+
+    while (!atomic_load(c->stop)) {
+        // Pošli tú istú hodnotu, ktorú server práve má, aby sme nerušili skutočných klientov.
+        if (c->commands % 2 == 0)
+            snprintf(cmd, sizeof(cmd), "MODE %d\n", c->ipc->mode == 1 ? 1 : 2);
+        else
+            snprintf(cmd, sizeof(cmd), "SUMMARY %d\n", c->ipc->summary_view == 1 ? 1 : 0);
+
+        double t0 = now_s();
+        if (command(c->fd, cmd, reply, sizeof(reply)) != 0) {
+            c->errors++;
+            if (reply[0] == '\0') break; // spojenie padlo
+        } else {
+            samples_add(&c->rtt_us, (now_s() - t0) * 1e6);
+        }
+        c->commands++;
+
+        // Rovnaké čítanie ako klient pri kreslení: celá snímka.
+        memcpy(snap, c->ipc, sizeof(IPCShared));
+        if (snap->version != last_version) {
+            last_version = snap->version;
+            uint64_t now = now_ns();
+            if (snap->publish_ns > 0 && now >= snap->publish_ns)
+                samples_add(&c->stale_ms, (now - snap->publish_ns) / 1e6);
+        }
+
+        if (c->config->interval_us > 0) sleep_us(c->config->interval_us);
+        reply[0] = '\0';
+    }
+    free(snap);
+    return NULL;
+}
+
+// Rýchlosť simulácie počas okna: zmeny steps_done medzi prvou a poslednou pozorovanou replikáciou.
+// Vráti -1, ak sa počas okna nestihli dokončiť aspoň dve replikácie.
+static double measure_rate(const IPCShared *ipc, double seconds)
+{
+    double end = now_s() + seconds;
+    long long last = ipc->steps_done;
+    long long first_steps = -1, last_steps = -1;
+    double first_t = 0, last_t = 0;
+
+    while (now_s() < end && !ipc->finished) {
+        long long cur = ipc->steps_done;
+        if (cur != last) {
+            double t = now_s();
+            if (first_steps < 0) {
+                first_steps = cur;
+                first_t = t;
+            }
+            last_steps = cur;
+            last_t = t;
+            last = cur;
+        }
+        sleep_us(LOADGEN_POLL_US);
+    }
+    if (first_steps < 0 || last_t <= first_t) return -1.0;
+    return (last_steps - first_steps) / (last_t - first_t);
+}
+
+// Zapíše rovnaký text na stdout aj do voliteľného súboru.
+static void emit(FILE *file, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    fflush(stdout);
+    if (file) {
+        va_start(ap, fmt);
+        vfprintf(file, fmt, ap);
+        va_end(ap);
+    }
+}
+
+// Jedna fáza s n klientmi; výsledky vypíše ako riadok CSV.
+static int run_phase(const LoadgenConfig *config, const IPCServerEntry *server, const IPCShared *ipc,
+                     int n, double base_rate, FILE *out)
+{
+    LoadClient *clients = calloc(n, sizeof(LoadClient));
+    if (!clients) return -1;
+    atomic_bool stop = false;
+
+    int started = 0;
+    for (int i = 0; i < n; i++) {
+        clients[i].fd = connect_client(server->sock_path, config->job);
+        if (clients[i].fd < 0) {
+            fprintf(stderr, "[Loadgen] Client %d could not connect.\n", i);
+            break;
+        }
+        clients[i].ipc = ipc;
+        clients[i].config = config;
+        clients[i].stop = &stop;
+        if (pthread_create(&clients[i].thread, NULL, client_thread, &clients[i]) != 0) {
+            fprintf(stderr, "[Loadgen] Client %d could not start a thread.\n", i);
+            ipc_close_socket(clients[i].fd);
+            break;
+        }
+        started++;
+    }
+
+    double t0 = now_s();
+    double rate = measure_rate(ipc, config->duration_s);
+    atomic_store(&stop, true);
+    double elapsed = now_s() - t0;
+
+    SampleBuf rtt = {0}, stale = {0};
+    long long commands = 0, errors = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(clients[i].thread, NULL);
+        ipc_close_socket(clients[i].fd);
+        samples_append(&rtt, &clients[i].rtt_us);
+        samples_append(&stale, &clients[i].stale_ms);
+        commands += clients[i].commands;
+        errors += clients[i].errors;
+        free(clients[i].rtt_us.v);
+        free(clients[i].stale_ms.v);
+    }
+    free(clients);
+
+    qsort(rtt.v, rtt.count, sizeof(double), cmp_double);
+    qsort(stale.v, stale.count, sizeof(double), cmp_double);
+
+    double loss = (base_rate > 0 && rate >= 0) ? (1.0 - rate / base_rate) * 100.0 : 0.0;
+    emit(out, "%d,%.2f,%lld,%.1f,%lld,%.1f,%.1f,%.1f,%.1f,%.3f,%.3f,%d,%.1f,%.2f,%.3f\n",
+         started, elapsed, commands, elapsed > 0 ? commands / elapsed : 0.0, errors,
+         percentile(&rtt, 0.50), percentile(&rtt, 0.90), percentile(&rtt, 0.99),
+         rtt.count ? rtt.v[rtt.count - 1] : 0.0,
+         percentile(&stale, 0.50), percentile(&stale, 0.99), stale.count,
+         rate, loss, started > 0 ? loss / started : 0.0);
+    if (rate < 0)
+        fprintf(stderr, "[Loadgen] Warning: fewer than two replications finished in %d-client phase; "
+                        "use a longer --duration.\n", started);
+
+    free(rtt.v);
+    free(stale.v);
+    return started == n ? 0 : -1;
+}
+
+// Nájde cieľový server v registri.
+static int resolve_server(const LoadgenConfig *config, IPCServerEntry *out)
+{
+    if (config->pid > 0) return ipc_registry_find(config->pid, out);
+
+    IPCServerEntry servers[64];
+    int count = ipc_registry_list(servers, 64);
+    if (count == 0) return -1;
+    *out = servers[count - 1];
+    return 0;
+}
+
+// Hlavná funkcia generátora záťaže.
+int loadgen_run(const LoadgenConfig *config)
+{
+    IPCServerEntry server;
+    if (resolve_server(config, &server) != 0) {
+        fprintf(stderr, "Error: No running server found.\n");
+        return 1;
+    }
+
+    // Riadiace spojenie: odštartuje server čakajúci na klienta a pri démonovi zistí shm úlohy.
+    int ctl = ipc_connect_socket(server.sock_path);
+    if (ctl < 0) {
+        fprintf(stderr, "Error: Could not connect to '%s'.\n", server.sock_path);
+        return 1;
+    }
+    char shm_name[64];
+    safe_strcpy(shm_name, server.shm_name, sizeof(shm_name));
+    if (strcmp(shm_name, "-") == 0) {
+        char cmd[32], reply[128];
+        snprintf(cmd, sizeof(cmd), "ATTACH %d\n", config->job);
+        if (config->job <= 0 || command(ctl, cmd, reply, sizeof(reply)) != 0 ||
+            sscanf(reply, "OK %63s", shm_name) != 1) {
+            fprintf(stderr, "Error: Server %d is a daemon; pass a running job with --job.\n", server.pid);
+            ipc_close_socket(ctl);
+            return 1;
+        }
+    }
+
+    IPCShared *ipc = NULL;
+    double deadline = now_s() + LOADGEN_CONNECT_TIMEOUT_S;
+    while (ipc_open_shared(shm_name, &ipc, false) != 0 && now_s() < deadline)
+        sleep_us(100000);
+    if (!ipc) {
+        fprintf(stderr, "Error: Could not open shared memory '%s'.\n", shm_name);
+        ipc_close_socket(ctl);
+        return 1;
+    }
+
+    FILE *out = NULL;
+    if (config->out_file[0] != '\0' && !(out = fopen(config->out_file, "w"))) {
+        fprintf(stderr, "Error: Could not open '%s' for writing.\n", config->out_file);
+        ipc_close_shared(ipc);
+        ipc_close_socket(ctl);
+        return 1;
+    }
+
+    fprintf(stderr, "[Loadgen] Server %d (%s), %d phases of %.1f s\n",
+            server.pid, shm_name, config->phases, config->duration_s);
+    emit(out, "clients,duration_s,commands,commands_per_s,errors,rtt_p50_us,rtt_p90_us,rtt_p99_us,"
+              "rtt_max_us,stale_p50_ms,stale_p99_ms,snapshots,steps_per_s,loss_pct,loss_per_client_pct\n");
+
+    // Baseline: simulácia bez syntetických klientov.
+    double base_rate = measure_rate(ipc, config->duration_s);
+    emit(out, "0,%.2f,0,0.0,0,0.0,0.0,0.0,0.0,0.000,0.000,0,%.1f,0.00,0.000\n",
+         config->duration_s, base_rate);
+    if (base_rate < 0)
+        fprintf(stderr, "[Loadgen] Warning: baseline saw fewer than two replications; "
+                        "throughput loss is not available.\n");
+
+    int rc = 0;
+    for (int i = 0; i < config->phases; i++) {
+        if (ipc->finished) {
+            fprintf(stderr, "[Loadgen] Simulation finished; skipping remaining phases.\n");
+            break;
+        }
+        if (run_phase(config, &server, ipc, config->clients[i], base_rate, out) != 0) rc = 1;
+    }
+
+    if (out) fclose(out);
+    ipc_close_shared(ipc);
+    ipc_close_socket(ctl);
+    return rc;
+}
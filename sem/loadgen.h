@@ -0,0 +1,20 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#define LOADGEN_MAX_PHASES 16
+
+// Generátor záťaže: N syntetických klientov proti bežiacemu serveru.
+typedef struct LoadgenConfig {
+    int pid;                          // cieľový server (0 = najnovší z registra)
+    int job;                          // úloha démona, ku ktorej sa pripojiť (ATTACH)
+    int clients[LOADGEN_MAX_PHASES];  // počty klientov jednotlivých fáz
+    int phases;
+    double duration_s;                // dĺžka jednej fázy
+    int interval_us;                  // pauza medzi príkazmi klienta (0 = bez pauzy)
+    char out_file[256];               // CSV navyše aj do súboru
+} LoadgenConfig;
+
+// Odmeria baseline bez klientov a potom všetky fázy; vráti 0 alebo 1 pri chybe.
+int loadgen_run(const LoadgenConfig *config);
+
+#endif // LOADGEN_H
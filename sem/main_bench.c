@@ -0,0 +1,70 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+// Vstupný bod benchmarku: parsovanie argumentov a spustenie sady prípadov.
+int main(int argc, char *argv[])
+{
+    BenchConfig config;
+    memset(&config, 0, sizeof(config));
+    config.samples = 7;
+    config.target_steps = 20000000;
+    config.threshold_pct = 5.0;
+
+    static const struct option long_opts[] = {
+        {"quick", no_argument, NULL, 'q'},
+        {"samples", required_argument, NULL, 'n'},
+        {"steps", required_argument, NULL, 'k'},
+        {"threads", required_argument, NULL, 't'},
+        {"filter", required_argument, NULL, 'f'},
+        {"out", required_argument, NULL, 'o'},
+        {"baseline", required_argument, NULL, 'b'},
+        {"threshold", required_argument, NULL, 'T'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'q':
+                config.quick = 1;
+                config.samples = 5;
+                config.target_steps = 5000000;
+                break;
+            case 'n':
+                config.samples = atoi(optarg);
+                break;
+            case 'k':
+                config.target_steps = atoll(optarg);
+                break;
+            case 't':
+                config.max_threads = atoi(optarg);
+                break;
+            case 'f':
+                strncpy(config.filter, optarg, sizeof(config.filter) - 1);
+                break;
+            case 'o':
+                strncpy(config.out_file, optarg, sizeof(config.out_file) - 1);
+                break;
+            case 'b':
+                strncpy(config.baseline_file, optarg, sizeof(config.baseline_file) - 1);
+                break;
+            case 'T':
+                config.threshold_pct = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [--quick] [--samples n] [--steps n] [--threads max] "
+                                "[--filter s] [--out file.csv] [--baseline file.csv] [--threshold pct]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (config.samples < 1 || config.target_steps < 1) {
+        fprintf(stderr, "Error: --samples and --steps must be positive.\n");
+        return 1;
+    }
+
+    return bench_run(&config);
+}
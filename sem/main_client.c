@@ -1,7 +1,47 @@
 #include "client.h"
+#include "ipc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
 
-// Vstupný bod klienta: spustí interaktívne klientské UI.
-int main(void)
+// Vstupný bod klienta: parsovanie argumentov a spustenie interaktívneho UI.
+int main(int argc, char *argv[])
 {
-    return client_run();
+    ClientConfig config = {0};
+    config.use_stream = 0;
+    config.stream_interval_ms = 100;
+
+    static const struct option long_opts[] = {
+        {"stream", optional_argument, NULL, 'S'},
+        {"stats", no_argument, NULL, 'm'},
+        {"trail", required_argument, NULL, 't'},
+        {"replay", required_argument, NULL, 'r'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'S':
+                config.use_stream = 1;
+                if (optarg) config.stream_interval_ms = atoi(optarg);
+                break;
+            case 'm':
+                config.show_stats = 1;
+                break;
+            case 't':
+                config.trail_len = atoi(optarg);
+                if (config.trail_len < 0) config.trail_len = 0;
+                if (config.trail_len >= IPC_TRAIL_LEN) config.trail_len = IPC_TRAIL_LEN - 1;
+                break;
+            case 'r':
+                config.replay_ms = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [--stream[=interval_ms]] [--stats] [--trail N] [--replay ms]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    return client_run(&config);
 }
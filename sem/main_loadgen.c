@@ -0,0 +1,72 @@
+#include "loadgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+// Vstupný bod generátora záťaže: parsovanie argumentov a spustenie fáz.
+int main(int argc, char *argv[])
+{
+    LoadgenConfig config;
+    memset(&config, 0, sizeof(config));
+    config.duration_s = 5.0;
+    static const int default_clients[] = { 1, 4, 16, 64 };
+    config.phases = 4;
+    memcpy(config.clients, default_clients, sizeof(default_clients));
+
+    static const struct option long_opts[] = {
+        {"pid", required_argument, NULL, 'p'},
+        {"job", required_argument, NULL, 'j'},
+        {"clients", required_argument, NULL, 'c'},
+        {"duration", required_argument, NULL, 'd'},
+        {"interval-us", required_argument, NULL, 'i'},
+        {"out", required_argument, NULL, 'o'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'p':
+                config.pid = atoi(optarg);
+                break;
+            case 'j':
+                config.job = atoi(optarg);
+                break;
+            case 'c': {
+                // Zoznam počtov klientov oddelený čiarkami, napr. 1,4,16
+                config.phases = 0;
+                char *save = NULL;
+                for (char *tok = strtok_r(optarg, ",", &save);
+                     tok && config.phases < LOADGEN_MAX_PHASES; tok = strtok_r(NULL, ",", &save)) {
+                    int n = atoi(tok);
+                    if (n <= 0) {
+                        fprintf(stderr, "Error: --clients expects positive numbers.\n");
+                        return 1;
+                    }
+                    config.clients[config.phases++] = n;
+                }
+                break;
+            }
+            case 'd':
+                config.duration_s = atof(optarg);
+                break;
+            case 'i':
+                config.interval_us = atoi(optarg);
+                break;
+            case 'o':
+                strncpy(config.out_file, optarg, sizeof(config.out_file) - 1);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [--pid pid] [--job id] [--clients 1,4,16] "
+                                "[--duration s] [--interval-us us] [--out file.csv]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (config.phases == 0 || config.duration_s <= 0) {
+        fprintf(stderr, "Error: Need at least one phase and a positive --duration.\n");
+        return 1;
+    }
+
+    return loadgen_run(&config);
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "simulation.h"
+#include "world.h"
+
+// Nástroj na zlúčenie výsledkov shardov: ./merge_results -o spolu.txt a.txt b.txt ...
+// Súbory sa hľadajú v saved/ rovnako ako pri -l, výsledok ide tiež do saved/.
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s -o output.txt shard1.txt shard2.txt [...]\n", prog);
+    fprintf(stderr, "  Files are read from and written to %s/; the output can be resumed with -l.\n",
+            SAVED_DIR);
+}
+
+// Zhodné štatistiky dvoch shardov takmer vždy znamenajú rovnaký --seed.
+static int same_stats(const SharedState *a, const SharedState *b)
+{
+    size_t cells = (size_t)a->world_size * a->world_size;
+    return a->replications == b->replications &&
+           memcmp(a->grid_block + cells, b->grid_block + cells, 2 * cells * sizeof(int)) == 0;
+}
+
+// Vstupný bod: načíta shardy, overí konfiguráciu, sčíta štatistiky a uloží výsledok.
+int main(int argc, char *argv[])
+{
+    const char *output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:h")) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    int count = argc - optind;
+    if (!output || count < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    SharedState *shards = calloc(count, sizeof(SharedState));
+    if (!shards) {
+        printf("Error: Out of memory.\n");
+        return 1;
+    }
+
+    int loaded = 0;
+    int rc = 1;
+    for (int i = 0; i < count; i++) {
+        if (!load_previous_simulation(&shards[i], argv[optind + i])) goto out;
+        loaded++;
+        if (i > 0 && !world_compatible(&shards[0], &shards[i])) {
+            printf("Error: '%s' is not compatible with '%s'.\n", argv[optind + i], argv[optind]);
+            goto out;
+        }
+        for (int j = 0; j < i; j++) {
+            // Rovnaký seed = replikácie 0..R-1 oboch shardov sú tie isté prechádzky.
+            if (shards[i].seed && shards[i].seed == shards[j].seed)
+                printf("Warning: '%s' and '%s' were run with the same seed %llu; their replications "
+                       "repeat the same walks.\n", argv[optind + j], argv[optind + i],
+                       (unsigned long long)shards[i].seed);
+            else if (same_stats(&shards[j], &shards[i]))
+                printf("Warning: '%s' and '%s' have identical statistics (same seed?).\n",
+                       argv[optind + j], argv[optind + i]);
+        }
+    }
+
+    // Zlučuje sa do prvého shardu; prekážky a konfigurácia ostávajú jeho.
+    for (int i = 1; i < count; i++) {
+        if (!world_accumulate(&shards[0], &shards[i])) goto out;
+    }
+
+    printf("Merged %d shard(s): %d replications total.\n", count, shards[0].replications);
+    if (save_simulation_results(&shards[0], output)) rc = 0;
+
+out:
+    for (int i = 0; i < loaded; i++) free_world(&shards[i]);
+    free(shards);
+    return rc;
+}
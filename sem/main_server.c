@@ -1,4 +1,8 @@
 #include "server.h"
+#include "daemon.h"
+#include "coord.h"
+#include "sweep.h"
+#include "worldgen.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,9 +25,44 @@ int main(int argc, char *argv[])
     config.obstacles_file[0] = '\0';
     config.output_file[0] = '\0';
     config.resume_file[0] = '\0';
+    config.headless = 0;
+    config.headless_ipc = 0;
+    strcpy(config.summary_format, "json");
+    config.ready_fd = -1;
+
+    static const struct option long_opts[] = {
+        {"headless", no_argument, NULL, 'H'},
+        {"ipc", no_argument, NULL, 'I'},
+        {"summary", required_argument, NULL, 'J'},
+        {"daemon", no_argument, NULL, 'D'},
+        {"workers", required_argument, NULL, 'W'},
+        {"submit", required_argument, NULL, 'S'},
+        {"priority", required_argument, NULL, 'P'},
+        {"ready-fd", required_argument, NULL, 'R'},
+        {"seed", required_argument, NULL, 'E'},
+        {"batch", required_argument, NULL, 'B'},
+        {"coordinator", required_argument, NULL, 'C'},
+        {"worker", required_argument, NULL, 'K'},
+        {"chunk-reps", required_argument, NULL, 'N'},
+        {"sweep", required_argument, NULL, 'G'},
+        {"grid-file", required_argument, NULL, 'M'},
+        {"hugepages", no_argument, NULL, 'U'},
+        {"cpus", required_argument, NULL, 'X'},
+        {"numa", no_argument, NULL, 'Y'},
+        {"occupancy", no_argument, NULL, 'O'},
+        {"walker-interval", required_argument, NULL, 'V'},
+        {"walker-steps", required_argument, NULL, 'Q'},
+        {"generate", required_argument, NULL, 'A'},
+        {"export-map", required_argument, NULL, 'T'},
+        {"prob-field", required_argument, NULL, 'Z'},
+        {"target", required_argument, NULL, 'a'},
+        {"cache", no_argument, NULL, 'c'},
+        {"autotune", no_argument, NULL, 'u'},
+        {0, 0, 0, 0}
+    };
     
     int opt;
-    while ((opt = getopt(argc, argv, "s:r:k:p:f:l:o:h")) != -1) {
+    while ((opt = getopt_long(argc, argv, "s:r:k:p:f:l:o:t:h", long_opts, NULL)) != -1) {
         switch (opt) {
             case 's':
                 config.world_size = atoi(optarg);
@@ -54,8 +93,112 @@ int main(int argc, char *argv[])
             case 'o':
                 strncpy(config.output_file, optarg, sizeof(config.output_file) - 1);
                 break;
+            case 'H':
+                config.headless = 1;
+                break;
+            case 'I':
+                config.headless_ipc = 1;
+                break;
+            case 'J':
+                if (strcmp(optarg, "json") != 0 && strcmp(optarg, "csv") != 0) {
+                    fprintf(stderr, "Error: --summary must be 'json' or 'csv'.\n");
+                    return 1;
+                }
+                strncpy(config.summary_format, optarg, sizeof(config.summary_format) - 1);
+                break;
+            case 'D':
+                config.daemon = 1;
+                break;
+            case 'W':
+                config.workers = atoi(optarg);
+                break;
+            case 'S':
+                config.submit_pid = atoi(optarg);
+                break;
+            case 'P':
+                config.priority = atoi(optarg);
+                break;
+            case 't':
+                config.threads = atoi(optarg);
+                break;
+            case 'E':
+                config.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'B':
+                config.batch = atoi(optarg);
+                break;
+            case 'R':
+                config.ready_fd = atoi(optarg);
+                break;
+            case 'C':
+                strncpy(config.coordinator_addr, optarg, sizeof(config.coordinator_addr) - 1);
+                break;
+            case 'K':
+                strncpy(config.worker_addr, optarg, sizeof(config.worker_addr) - 1);
+                break;
+            case 'N':
+                config.chunk_reps = atoi(optarg);
+                break;
+            case 'G':
+                strncpy(config.sweep_file, optarg, sizeof(config.sweep_file) - 1);
+                break;
+            case 'M':
+                strncpy(config.grid_file, optarg, sizeof(config.grid_file) - 1);
+                break;
+            case 'U':
+                config.hugepages = 1;
+                break;
+            case 'X':
+                strncpy(config.cpus, optarg, sizeof(config.cpus) - 1);
+                break;
+            case 'Y':
+                config.numa = 1;
+                break;
+            case 'O':
+                config.occupancy = 1;
+                break;
+            case 'V':
+                config.walker_interval_ms = atoi(optarg);
+                break;
+            case 'Q':
+                config.walker_steps = atoll(optarg);
+                break;
+            case 'A':
+                strncpy(config.generate, optarg, sizeof(config.generate) - 1);
+                break;
+            case 'T':
+                strncpy(config.export_map, optarg, sizeof(config.export_map) - 1);
+                break;
+            case 'Z':
+                strncpy(config.prob_field, optarg, sizeof(config.prob_field) - 1);
+                break;
+            case 'a': {
+                // Opakované --target sa spoja do jedného zoznamu.
+                size_t len = strlen(config.targets);
+                snprintf(config.targets + len, sizeof(config.targets) - len, "%s%s", len ? ";" : "", optarg);
+                break;
+            }
+            case 'c':
+                config.cache = 1;
+                break;
+            case 'u':
+                config.autotune = 1;
+                break;
         }
     }
     
+    if (config.export_map[0] != '\0') return worldgen_export(&config);
+    if ((config.prob_field[0] != '\0' || config.targets[0] != '\0') && (config.daemon || config.submit_pid > 0)) {
+        printf("Error: --prob-field and --target are not supported by the daemon.\n");
+        return 1;
+    }
+    if ((config.cache || config.autotune) && (config.daemon || config.submit_pid > 0 || config.worker_addr[0] || config.sweep_file[0])) {
+        printf("Error: --cache and --autotune work only for a single server run.\n");
+        return 1;
+    }
+    if (config.daemon) return daemon_run(&config);
+    if (config.submit_pid > 0) return daemon_submit(&config);
+    if (config.worker_addr[0] != '\0') return worker_run(&config);
+    if (config.sweep_file[0] != '\0') return sweep_run(&config);
     return server_run(&config);
 }
@@ -0,0 +1,551 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#include "netloop.h"
+#include "ipc.h"
+#include "daemon.h"
+#include "trace.h"
+#include "affinity.h"
+
+#define EPOLL_TIMEOUT_MS 100
+#define EPOLL_MAX_EVENTS 64
+#define CONN_BUF_SIZE 256
+#define CONN_MAX_LINE 65536 // najdlhší riadok (riadok mapy prekážok pri SUBMIT)
+#define STREAM_MIN_INTERVAL_MS 20
+#define STREAM_MAX_INTERVAL_MS 5000
+
+// Stav jedného pripojeného klienta v event loope.
+typedef struct ClientConn {
+    int fd;
+    int index;                 // pozícia v ConnTable
+    char *inbuf;               // nespracované bajty (neukončený riadok)
+    size_t inlen;
+    size_t incap;
+    bool overflow;             // aktuálny riadok je dlhší ako CONN_MAX_LINE
+
+    SharedState *S;            // sledovaná simulácia (v móde démona po ATTACH)
+    struct JobDraft *draft;    // rozpracovaný SUBMIT, ktorý čaká na riadky mapy
+
+    // Binárny stream (SUBSCRIBE)
+    bool subscribed;
+    int interval_ms;
+    long long next_due_ms;
+    uint32_t seq;
+    IPCShared *last_sent;      // naposledy odoslaný stav (báza pre rozdiely)
+    uint8_t *outbuf;           // neodoslané bajty (pomalý odberateľ)
+    size_t outlen;
+    size_t outcap;
+    bool want_out;             // EPOLLOUT je zaregistrovaný
+} ClientConn;
+
+// Zoznam všetkých otvorených spojení (kvôli upratovaniu pri ukončení).
+typedef struct ConnTable {
+    ClientConn **items;
+    int count;
+    int capacity;
+    int epfd;
+} ConnTable;
+
+// Pošle textový reťazec na daný socket.
+static void send_str(int fd, const char *msg)
+{
+    if (fd < 0 || !msg) return;
+    ssize_t r = write(fd, msg, strlen(msg));
+    (void)r;
+}
+
+// Prepne deskriptor do neblokujúceho režimu.
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Monotónny čas v milisekundách.
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Zapne/vypne sledovanie EPOLLOUT podľa toho, či spojenie má neodoslané dáta.
+static void conn_update_events(int epfd, ClientConn *c)
+{
+    bool want = c->outlen > 0;
+    if (want == c->want_out) return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (want ? EPOLLOUT : 0);
+    ev.data.ptr = c;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->want_out = want;
+}
+
+// Pokúsi sa odoslať buffer spojenia. Vráti -1 pri chybe spojenia.
+static int conn_flush(ClientConn *c)
+{
+    size_t off = 0;
+    while (off < c->outlen) {
+        ssize_t n = write(c->fd, c->outbuf + off, c->outlen - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        off += (size_t)n;
+    }
+    memmove(c->outbuf, c->outbuf + off, c->outlen - off);
+    c->outlen -= off;
+    return 0;
+}
+
+// Pridá bajty do výstupného bufferu spojenia a hneď sa ich pokúsi odoslať.
+static int conn_queue(ClientConn *c, const void *data, size_t len)
+{
+    if (c->outlen + len > c->outcap) {
+        size_t cap = c->outcap ? c->outcap : 4096;
+        while (cap < c->outlen + len) cap *= 2;
+        uint8_t *buf = realloc(c->outbuf, cap);
+        if (!buf) return -1;
+        c->outbuf = buf;
+        c->outcap = cap;
+    }
+    memcpy(c->outbuf + c->outlen, data, len);
+    c->outlen += len;
+    return conn_flush(c);
+}
+
+// Textová odpoveď klientovi; odberateľ streamu ju dostane zabalenú v rámci IPC_FRAME_REPLY.
+static void conn_reply(void *ctx, const char *text)
+{
+    ClientConn *c = ctx;
+    if (!text) return;
+    if (!c->subscribed) {
+        conn_queue(c, text, strlen(text));
+        return;
+    }
+    IPCFrameHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = IPC_FRAME_MAGIC;
+    hdr.type = IPC_FRAME_REPLY;
+    hdr.payload_len = (uint32_t)strlen(text);
+    if (conn_queue(c, &hdr, sizeof(hdr)) == 0) conn_queue(c, text, hdr.payload_len);
+}
+
+// Odošle odberateľovi jeden rámec (kľúčový pri prvom odoslaní).
+static int stream_send_frame(ClientConn *c, const IPCShared *snap, uint8_t *payload)
+{
+    IPCFrameHeader hdr;
+    bool key = (c->seq == 0);
+    int len = ipc_frame_encode(snap, c->last_sent, key, c->seq, &hdr, payload);
+    if (len < 0) return 0; // nič sa nezmenilo
+    c->seq++;
+    if (conn_queue(c, &hdr, sizeof(hdr)) != 0) return -1;
+    if (len > 0 && conn_queue(c, payload, (size_t)len) != 0) return -1;
+    return 0;
+}
+
+// Spracuje jeden celý riadok (príkaz) od klienta: MODE/SUMMARY/SUBSCRIBE/STATS
+// a v móde démona aj príkazy fronty úloh (SUBMIT, JOBS, ATTACH, ...).
+static void handle_command(SocketThreadArgs *args, ClientConn *c, const char *line)
+{
+    char cmd[16];
+    int val = -1;
+
+    if (args->daemon) {
+        if (c->draft) {
+            daemon_draft_line(args->daemon, &c->draft, line, conn_reply, c);
+            return;
+        }
+        SharedState *attach = NULL;
+        if (daemon_command(args->daemon, line, &c->draft, &attach, conn_reply, c)) {
+            if (attach && attach != c->S) {
+                // Nová úloha: odberateľ dostane najprv kľúčový rámec.
+                c->S = attach;
+                c->seq = 0;
+            }
+            return;
+        }
+    }
+
+    SharedState *S = c->S;
+    if (!S) {
+        conn_reply(c, "ERR not attached\n");
+        return;
+    }
+
+    if (strncmp(line, "STATS", 5) == 0 && (line[5] == '\0' || line[5] == ' ')) {
+        // Posledná vzorka metrík behu v jednom riadku kľúč=hodnota.
+        pthread_mutex_lock(&S->lock);
+        IPCMetrics m = S->metrics;
+        pthread_mutex_unlock(&S->lock);
+        char reply[4096];
+        int len = snprintf(reply, sizeof(reply),
+            "STATS threads=%d steps=%lld walks=%lld successes=%lld lock_wait_ms=%.3f publish_ms=%.3f"
+            " elapsed_s=%.3f rate_1s=%.0f rate_10s=%.0f rate_60s=%.0f eta_s=%.1f per_thread=",
+            m.threads, m.steps, m.walks, m.successes, m.lock_wait_ns / 1e6, m.publish_time_ns / 1e6,
+            m.elapsed_ns / 1e9, m.rate_1s, m.rate_10s, m.rate_60s, m.eta_s);
+        int shown = m.threads < IPC_METRICS_THREADS ? m.threads : IPC_METRICS_THREADS;
+        for (int i = 0; i < shown && len < (int)sizeof(reply) - 64; i++)
+            len += snprintf(reply + len, sizeof(reply) - len, "%s%lld/%.3f", i ? "," : "",
+                            m.thread_steps[i], m.thread_lock_wait_ns[i] / 1e6);
+        snprintf(reply + len, sizeof(reply) - len, "\n");
+        conn_reply(c, reply);
+        return;
+    }
+
+    if (sscanf(line, "%15s %d", cmd, &val) == 2 && strcmp(cmd, "SUBSCRIBE") == 0) {
+        // Dohodni interval, odpovedz textom a ďalej posielaj už len binárne rámce.
+        if (!S->ipc || c->subscribed) {
+            conn_reply(c, "ERR\n");
+            return;
+        }
+        IPCShared *base = calloc(1, sizeof(IPCShared));
+        if (!base) {
+            conn_reply(c, "ERR no mem\n");
+            return;
+        }
+        if (val < STREAM_MIN_INTERVAL_MS) val = STREAM_MIN_INTERVAL_MS;
+        if (val > STREAM_MAX_INTERVAL_MS) val = STREAM_MAX_INTERVAL_MS;
+        char reply[32];
+        snprintf(reply, sizeof(reply), "OK %d\n", val);
+        conn_reply(c, reply);
+        c->last_sent = base;
+        c->interval_ms = val;
+        c->next_due_ms = 0;
+        c->seq = 0;
+        c->subscribed = true;
+        return;
+    }
+
+    int x, y;
+    if (sscanf(line, "%15s %d %d %d", cmd, &x, &y, &val) == 4 && strcmp(cmd, "OBSTACLE") == 0) {
+        // Úprava sa prejaví na najbližšej hranici replikácie.
+        const char *err = simulation_queue_edit(S, x, y, val);
+        char reply[64];
+        if (err) snprintf(reply, sizeof(reply), "ERR %s\n", err);
+        else snprintf(reply, sizeof(reply), "OK\n");
+        conn_reply(c, reply);
+        return;
+    }
+
+    if (sscanf(line, "%15s %d", cmd, &val) == 2) {
+        if (strcmp(cmd, "MODE") == 0 && (val == 1 || val == 2)) {
+            pthread_mutex_lock(&S->lock);
+            S->mode = val;
+            sync_progress_to_ipc(S);
+            pthread_mutex_unlock(&S->lock);
+            conn_reply(c, "OK\n");
+        } else if (strcmp(cmd, "SUMMARY") == 0 && (val == 0 || val == 1)) {
+            pthread_mutex_lock(&S->lock);
+            S->summary_view = val;
+            sync_progress_to_ipc(S);
+            pthread_mutex_unlock(&S->lock);
+            conn_reply(c, "OK\n");
+        } else {
+            conn_reply(c, "ERR\n");
+        }
+    } else {
+        conn_reply(c, "ERR\n");
+    }
+}
+
+// Pridá nové spojenie do tabuľky a zaregistruje ho v epolle.
+static ClientConn *conn_add(ConnTable *t, int fd, SharedState *S)
+{
+    if (t->count == t->capacity) {
+        int cap = t->capacity ? t->capacity * 2 : 16;
+        ClientConn **items = realloc(t->items, cap * sizeof(ClientConn *));
+        if (!items) return NULL;
+        t->items = items;
+        t->capacity = cap;
+    }
+
+    ClientConn *c = calloc(1, sizeof(ClientConn));
+    if (!c) return NULL;
+    c->incap = CONN_BUF_SIZE;
+    c->inbuf = malloc(c->incap);
+    if (!c->inbuf) {
+        free(c);
+        return NULL;
+    }
+    c->fd = fd;
+    c->S = S;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = c;
+    if (epoll_ctl(t->epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        free(c->inbuf);
+        free(c);
+        return NULL;
+    }
+
+    c->index = t->count;
+    t->items[t->count++] = c;
+    return c;
+}
+
+// Odregistruje, zavrie a uvoľní spojenie (swap-remove z tabuľky).
+static void conn_remove(ConnTable *t, ClientConn *c)
+{
+    epoll_ctl(t->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    ipc_close_socket(c->fd);
+
+    int last = t->count - 1;
+    if (c->index != last) {
+        t->items[c->index] = t->items[last];
+        t->items[c->index]->index = c->index;
+    }
+    t->count--;
+    daemon_draft_free(c->draft);
+    free(c->last_sent);
+    free(c->outbuf);
+    free(c->inbuf);
+    free(c);
+}
+
+// Prečíta všetko dostupné zo spojenia a spracuje ukončené riadky.
+// Vráti -1, ak sa klient odpojil alebo nastala chyba.
+static int conn_read(SocketThreadArgs *args, ClientConn *c)
+{
+    while (1) {
+        if (c->inlen == c->incap - 1 && c->incap < CONN_MAX_LINE) {
+            // Dlhý riadok (napr. mapa prekážok): zväčši buffer.
+            char *buf = realloc(c->inbuf, c->incap * 2);
+            if (!buf) return -1;
+            c->inbuf = buf;
+            c->incap *= 2;
+        }
+        ssize_t n = read(c->fd, c->inbuf + c->inlen, c->incap - 1 - c->inlen);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        c->inlen += (size_t)n;
+
+        // Rozdeľ buffer na riadky; každý riadok je jeden príkaz.
+        size_t start = 0;
+        for (size_t i = 0; i < c->inlen; i++) {
+            if (c->inbuf[i] != '\n') continue;
+            c->inbuf[i] = '\0';
+            if (i > start && c->inbuf[i - 1] == '\r') c->inbuf[i - 1] = '\0';
+            if (c->overflow) {
+                c->overflow = false;
+                conn_reply(c, "ERR\n");
+            } else {
+                TRACE_BEGIN(cmd_t0);
+                handle_command(args, c, c->inbuf + start);
+                TRACE_END_DETAIL(cmd_t0, "command", c->inbuf + start);
+            }
+            start = i + 1;
+        }
+
+        if (start > 0) {
+            memmove(c->inbuf, c->inbuf + start, c->inlen - start);
+            c->inlen -= start;
+        } else if (c->inlen == c->incap - 1 && c->incap >= CONN_MAX_LINE) {
+            // Príliš dlhý riadok bez '\n' – zahoď ho až po najbližší koniec riadku.
+            c->overflow = true;
+            c->inlen = 0;
+        }
+    }
+}
+
+// Pošle rámce všetkým odberateľom, ktorým uplynul interval (alebo všetkým pri force).
+// Snímka IPC sa kopíruje pod zámkom len raz, kódovanie beží mimo zámku.
+static void stream_tick(ConnTable *t, IPCShared *snap, uint8_t *payload, bool force)
+{
+    long long now = now_ms();
+    const SharedState *snap_src = NULL; // z ktorej simulácie je aktuálna snímka
+
+    for (int i = 0; i < t->count; i++) {
+        ClientConn *c = t->items[i];
+        if (!c->subscribed || !c->S || !c->S->ipc) continue;
+        // Pomalý odberateľ: kým nemá odoslané predošlé rámce, nové negeneruj.
+        // Ďalší rozdiel aj tak pokryje všetky zmeny od posledného odoslania.
+        if (!force && (c->outlen > 0 || now < c->next_due_ms)) continue;
+
+        if (snap_src != c->S) {
+            pthread_mutex_lock(&c->S->lock);
+            memcpy(snap, c->S->ipc, sizeof(IPCShared));
+            pthread_mutex_unlock(&c->S->lock);
+            snap_src = c->S;
+        }
+
+        c->next_due_ms = now + c->interval_ms;
+        if (stream_send_frame(c, snap, payload) != 0) {
+            conn_remove(t, c);
+            i--;
+            continue;
+        }
+        conn_update_events(t->epfd, c);
+    }
+}
+
+// Najkratší čas do ďalšieho rámca pre niektorého odberateľa (timeout pre epoll_wait).
+static int stream_timeout_ms(const ConnTable *t)
+{
+    long long now = now_ms();
+    long long timeout = EPOLL_TIMEOUT_MS;
+    for (int i = 0; i < t->count; i++) {
+        const ClientConn *c = t->items[i];
+        if (!c->subscribed || c->outlen > 0) continue;
+        long long left = c->next_due_ms - now;
+        if (left < timeout) timeout = left < 0 ? 0 : left;
+    }
+    return (int)timeout;
+}
+
+// Odpojí klientov od simulácie, ktorú démon uvoľňuje; odberateľov streamu zavrie.
+static void detach_conns(void *ctx, SharedState *S)
+{
+    ConnTable *t = ctx;
+    for (int i = 0; i < t->count; i++) {
+        ClientConn *c = t->items[i];
+        if (c->S != S) continue;
+        if (c->subscribed) {
+            conn_remove(t, c);
+            i--;
+        } else {
+            c->S = NULL;
+        }
+    }
+}
+
+// Má event loop skončiť? (koniec simulácie, alebo ukončenie démona)
+static bool loop_should_stop(const SocketThreadArgs *args)
+{
+    if (args->daemon) return daemon_stopping(args->daemon);
+    pthread_mutex_lock(&args->S->lock);
+    bool finished = args->S->finished;
+    pthread_mutex_unlock(&args->S->lock);
+    return finished;
+}
+
+// Event loop nad UNIX socketom: jedno vlákno obsluhuje listen socket aj všetkých klientov.
+void *socket_thread(void *arg)
+{
+    SocketThreadArgs *args = (SocketThreadArgs *)arg;
+    SharedState *S = args->S;
+    char *sock_path = args->sock_path;
+    TRACE_THREAD("socket");
+    if (S) affinity_exclude_self(S->cpus, S->ncpus);
+    
+    int listen_fd = ipc_listen_socket(sock_path);
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (listen_fd < 0 || epfd < 0 || set_nonblocking(listen_fd) == -1) {
+        if (listen_fd >= 0) ipc_close_socket(listen_fd);
+        if (epfd >= 0) close(epfd);
+        if (args->ready_fd >= 0) close(args->ready_fd); // EOF bez READY = štart zlyhal
+        free(sock_path);
+        free(args);
+        return NULL;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // NULL = listen socket
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+    // Až teraz sa dá pripojiť: zapíš sa do registra a ohlás pripravenosť rodičovi.
+    int pid = (int)getpid();
+    ipc_registry_add(pid, args->shm_name, sock_path);
+    if (args->ready_fd >= 0) {
+        char ready[32];
+        int len = snprintf(ready, sizeof(ready), "READY %d\n", pid);
+        if (write(args->ready_fd, ready, len) != len)
+            printf("[Server] Warning: readiness pipe closed.\n");
+        close(args->ready_fd);
+    }
+
+    ConnTable conns = {0};
+    conns.epfd = epfd;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int first_client = (S != NULL);
+
+    IPCShared *snap = malloc(sizeof(IPCShared));
+    uint8_t *payload = malloc(IPC_FRAME_MAX_PAYLOAD);
+
+    while (!loop_should_stop(args)) {
+        int nev = epoll_wait(epfd, events, EPOLL_MAX_EVENTS, stream_timeout_ms(&conns));
+        if (nev < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < nev; i++) {
+            ClientConn *c = events[i].data.ptr;
+
+            if (!c) {
+                // Prijmi všetky čakajúce spojenia naraz.
+                int cfd;
+                while ((cfd = ipc_accept_socket(listen_fd)) >= 0) {
+                    if (set_nonblocking(cfd) == -1 || !conn_add(&conns, cfd, S)) {
+                        send_str(cfd, "ERR no mem\n");
+                        ipc_close_socket(cfd);
+                        continue;
+                    }
+                    if (first_client) {
+                        pthread_mutex_lock(&S->lock);
+                        S->client_connected = 1;
+                        pthread_mutex_unlock(&S->lock);
+                        first_client = 0;
+                    }
+                }
+                continue;
+            }
+
+            bool drop = (events[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+            if (!drop && (events[i].events & (EPOLLIN | EPOLLRDHUP)))
+                drop = conn_read(args, c) != 0;
+            if (!drop && c->outlen > 0)
+                drop = conn_flush(c) != 0;
+            if (drop) {
+                printf("[Server] Klient sa odpojil.\n");
+                conn_remove(&conns, c);
+                continue;
+            }
+            conn_update_events(epfd, c);
+        }
+
+        if (snap && payload)
+            stream_tick(&conns, snap, payload, false);
+        if (args->daemon)
+            daemon_reap(args->daemon, detach_conns, &conns);
+    }
+
+    // Odberateľom pošli ešte finálny stav (best effort), potom zavri všetky spojenia.
+    if (snap && payload)
+        stream_tick(&conns, snap, payload, true);
+    free(snap);
+    free(payload);
+    while (conns.count > 0)
+        conn_remove(&conns, conns.items[conns.count - 1]);
+    free(conns.items);
+
+    close(epfd);
+    ipc_close_socket(listen_fd);
+    ipc_registry_remove(pid);
+    unlink(sock_path);
+    free(sock_path);
+    free(args);
+    return NULL;
+}
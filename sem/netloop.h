@@ -0,0 +1,20 @@
+#ifndef NETLOOP_H
+#define NETLOOP_H
+
+#include "simulation.h"
+
+struct Daemon;
+
+// Argumenty vlákna s event loopom (vlákno ich uvoľní).
+typedef struct SocketThreadArgs {
+    SharedState *S;          // simulácia servera (NULL v móde démona)
+    struct Daemon *daemon;   // fronta úloh v móde démona (inak NULL)
+    char *sock_path;
+    char shm_name[64];       // zapíše sa do registra ("-" pre démona)
+    int ready_fd;            // po spustení listen() sem príde "READY <pid>" (-1 = nie)
+} SocketThreadArgs;
+
+// Event loop nad UNIX socketom: jedno vlákno obsluhuje listen socket aj všetkých klientov.
+void *socket_thread(void *arg);
+
+#endif // NETLOOP_H
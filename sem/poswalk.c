@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "poswalk.h"
+#include "probfield.h"
+#include "target.h"
+#include "simulation.h"
+#include "walker.h"
+#include "world.h"
+
+// Verejné API knižnice nad SharedState a simulation_thread (bez IPC a pyramídy).
+
+#define POSWALK_CHECK_REPS 10  // po koľkých replikáciách run_until prepočíta presnosť
+#define POSWALK_MAX_WORLD 46340 // jadro indexuje bunky v int, n * n sa doň musí zmestiť
+
+struct PosWalk {
+    SharedState S;
+};
+
+// Posledná chyba API v tomto vlákne (knižnica nič nevypisuje, to nechá na volajúcom).
+static _Thread_local char last_error[256];
+
+static void set_error(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(last_error, sizeof(last_error), fmt, ap);
+    va_end(ap);
+}
+
+const char *poswalk_last_error(void)
+{
+    return last_error;
+}
+
+void poswalk_config_default(PosWalkConfig *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->world_size = 11;
+    cfg->max_steps = 1000;
+    cfg->prob_up = cfg->prob_down = cfg->prob_left = cfg->prob_right = 0.25;
+}
+
+// Nastavenia behu (seed, vlákna, blok) a zámok; svet už je alokovaný.
+static void setup_run(SharedState *S, const PosWalkConfig *run)
+{
+    S->mode = 2;
+    S->threads = (run && run->threads > 0) ? run->threads : 1;
+    S->batch = run ? run->batch : 0;
+    // Načítaný svet pokračuje v prúdoch svojho seedu, ak ho súbor nesie.
+    S->seed = (run && run->seed) ? run->seed
+            : S->seed ? S->seed
+                      : walk_rng_mix((uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32));
+    walker_init(&S->walker, S->world_size / 2, S->world_size / 2);
+    pthread_mutex_init(&S->lock, NULL);
+}
+
+static int setup_targets(SharedState *S, const char *spec)
+{
+    TargetRect targets[TARGET_MAX];
+    int count = target_parse(spec, targets, TARGET_MAX);
+    return count < 0 ? -1 : target_setup(S, targets, count);
+}
+
+PosWalk *poswalk_create(const PosWalkConfig *cfg)
+{
+    if (!cfg) {
+        set_error("missing configuration");
+        return NULL;
+    }
+    PosWalk *w = calloc(1, sizeof(PosWalk));
+    if (!w) {
+        set_error("out of memory");
+        return NULL;
+    }
+    SharedState *S = &w->S;
+
+    if (cfg->obstacles_file) {
+        S->world_size = get_world_size_from_obstacles(cfg->obstacles_file);
+        S->use_obstacles = true;
+    } else if (cfg->prob_field_file) {
+        S->world_size = get_world_size_from_obstacles(cfg->prob_field_file);
+    } else {
+        S->world_size = cfg->world_size;
+    }
+    if (S->world_size <= 0 || S->world_size > POSWALK_MAX_WORLD || cfg->max_steps <= 0) {
+        set_error("invalid world size or max steps");
+        free(w);
+        return NULL;
+    }
+    S->max_steps = cfg->max_steps;
+    S->prob = (Probabilities){ cfg->prob_up, cfg->prob_down, cfg->prob_left, cfg->prob_right };
+
+    allocate_world(S);
+    if (!S->grid_block) {
+        set_error("out of memory for a %dx%d world", S->world_size, S->world_size);
+        free(w);
+        return NULL;
+    }
+    initialize_world(S);
+    const char *err = (S->use_obstacles && !load_obstacles(S, cfg->obstacles_file)) ? "could not load obstacles file"
+                    : (cfg->prob_field_file && !probfield_load(S, cfg->prob_field_file)) ? "could not load probability field"
+                    : (cfg->targets && setup_targets(S, cfg->targets) != 0) ? "invalid targets"
+                    : (cfg->occupancy && !world_alloc_occupancy(S)) ? "out of memory for occupancy map" : NULL;
+    if (err) {
+        set_error("%s", err);
+        free_world(S);
+        free(w);
+        return NULL;
+    }
+    setup_run(S, cfg);
+    return w;
+}
+
+PosWalk *poswalk_load(const char *path, const PosWalkConfig *run)
+{
+    if (!path) {
+        set_error("missing path");
+        return NULL;
+    }
+    PosWalk *w = calloc(1, sizeof(PosWalk));
+    if (!w) {
+        set_error("out of memory");
+        return NULL;
+    }
+    if (!world_load_file(&w->S, path)) {
+        set_error("could not load '%s'", path);
+        free(w);
+        return NULL;
+    }
+    if (w->S.world_size > POSWALK_MAX_WORLD) {
+        set_error("world in '%s' is too large", path);
+        free_world(&w->S);
+        free(w);
+        return NULL;
+    }
+    w->S.current_rep = w->S.replications;
+    setup_run(&w->S, run);
+    return w;
+}
+
+void poswalk_destroy(PosWalk *w)
+{
+    if (!w) return;
+    pthread_mutex_destroy(&w->S.lock);
+    free_world(&w->S);
+    free(w);
+}
+
+int poswalk_run(PosWalk *w, int replications)
+{
+    if (!w || replications < 0) {
+        set_error("invalid arguments");
+        return -1;
+    }
+    SharedState *S = &w->S;
+    S->replications = S->current_rep + replications;
+    S->finished = false;
+    simulation_thread(S);
+    if (S->current_rep != S->replications) {
+        set_error("simulation stopped after %d of %d replications", S->current_rep, S->replications);
+        return -1;
+    }
+    return 0;
+}
+
+double poswalk_precision(const PosWalk *w)
+{
+    const SharedState *S = &w->S;
+    double r = S->current_rep + 4.0;
+    double worst = 0.0;
+    for (int y = 0; y < S->world_size; y++) {
+        for (int x = 0; x < S->world_size; x++) {
+            if (S->obstacles[y][x]) continue;
+            // Agresti–Coull: pri 0 alebo všetkých úspechoch nedá nulovú šírku.
+            double p = (S->success_count[y][x] + 2.0) / r;
+            double hw = 1.96 * sqrt(p * (1.0 - p) / r);
+            if (hw > worst) worst = hw;
+        }
+    }
+    return worst;
+}
+
+int poswalk_run_until(PosWalk *w, double half_width, int max_replications)
+{
+    if (!w || half_width <= 0.0) {
+        set_error("invalid arguments");
+        return -1;
+    }
+    while (poswalk_precision(w) > half_width) {
+        int left = max_replications - w->S.current_rep;
+        if (left <= 0) return 1;
+        if (poswalk_run(w, left < POSWALK_CHECK_REPS ? left : POSWALK_CHECK_REPS) != 0) return -1;
+    }
+    return 0;
+}
+
+int poswalk_world_size(const PosWalk *w)
+{
+    return w ? w->S.world_size : 0;
+}
+
+int poswalk_replications(const PosWalk *w)
+{
+    return w ? w->S.current_rep : 0;
+}
+
+const int32_t *poswalk_grid(const PosWalk *w, PosWalkGrid which)
+{
+    if (!w || which < POSWALK_OBSTACLES || which > POSWALK_SUCCESS_COUNT) return NULL;
+    size_t cells = (size_t)w->S.world_size * w->S.world_size;
+    return (const int32_t *)w->S.grid_block + (size_t)which * cells;
+}
+
+const long long *poswalk_occupancy(const PosWalk *w)
+{
+    return w ? w->S.occupancy : NULL;
+}
+
+const long long *poswalk_target_hits(const PosWalk *w, int *count)
+{
+    if (count) *count = w ? w->S.ntargets : 0;
+    return w ? w->S.target_hits : NULL;
+}
+
+int poswalk_save(const PosWalk *w, const char *path)
+{
+    if (!w || !path) {
+        set_error("invalid arguments");
+        return -1;
+    }
+    // Po každom dokončenom behu replications == current_rep, súbor teda nesie hotové replikácie.
+    if (!world_save_file(&w->S, path)) {
+        set_error("could not save '%s'", path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef POSWALK_H
+#define POSWALK_H
+
+#include <stdint.h>
+
+// libposwalk: jadro simulácie (svet, chodec, simulačné vlákna) ako knižnica bez servera,
+// zdieľanej pamäte a klienta. Server toto API nepoužíva, riadi jadro cez simulation.h.
+// Beh je synchrónny: funkcie poswalk_run* sa vrátia po dokončení replikácií. Výsledky sa
+// čítajú priamo z mriežok simulácie (bez kópie).
+//
+//   PosWalkConfig cfg;
+//   poswalk_config_default(&cfg);
+//   cfg.world_size = 101;
+//   cfg.threads = 8;
+//   PosWalk *w = poswalk_create(&cfg);
+//   if (!w) fprintf(stderr, "poswalk: %s\n", poswalk_last_error());
+//   poswalk_run_until(w, 0.01, 10000);              // 95 % interval každej bunky <= ±1 %
+//   const int32_t *succ = poswalk_grid(w, POSWALK_SUCCESS_COUNT);
+//   poswalk_save(w, "vysledok.txt");                // formát -l / merge_results
+//   poswalk_destroy(w);
+//
+// Funkcie vracajú 0 pri úspechu a -1 pri chybe (konštruktory NULL); dôvod vráti
+// poswalk_last_error(). Jadro zdieľané so serverom však na stdout vypíše (umlčať sa nedá):
+//   - poswalk_create: čítanie obstacles_file a prob_field_file (potvrdenie načítania, chyba
+//     formátu alebo veľkosti, odstránená prekážka v strede), kontrola targets (syntax, cieľ mimo
+//     sveta, priveľa cieľov, odstránené prekážky pod cieľmi) a alokácia mapy obsadenosti
+//     (svet väčší ako OCCUPANCY_MAX_WORLD, nedostatok pamäte),
+//   - poswalk_load: čítanie uloženého súboru vrátane voliteľných sekcií,
+//   - poswalk_run*: nedostatok pamäte pre simuláciu a menej spustených vlákien, ako je threads,
+//   - poswalk_save: súbor sa nedá otvoriť na zápis.
+
+#define POSWALK_API_VERSION 4
+
+typedef struct PosWalk PosWalk;
+
+typedef struct PosWalkConfig {
+    int world_size;             // ignoruje sa, ak je zadaný obstacles_file alebo prob_field_file
+    int max_steps;
+    double prob_up;
+    double prob_down;
+    double prob_left;
+    double prob_right;
+    const char *obstacles_file; // súbor v tvare obstacles.txt, NULL = svet bez prekážok
+    uint64_t seed;              // 0 = seed načítaného súboru, inak podľa času a PID
+    int threads;                // počet simulačných vlákien (<= 1 = jedno)
+    int batch;                  // buniek na jeden blok vlákna (0 = predvolené)
+    int occupancy;              // 1 = zbieraj mapu obsadenosti (poswalk_occupancy)
+    const char *prob_field_file; // pravdepodobnosti po bunkách (formát --prob-field), NULL = prob_*
+    const char *targets;        // cieľové bunky (formát --target), NULL = stred sveta
+} PosWalkConfig;
+
+// Mriežky výsledkov: world_size * world_size hodnôt po riadkoch (index y * n + x).
+typedef enum PosWalkGrid {
+    POSWALK_OBSTACLES = 0,      // 1 = prekážka
+    POSWALK_TOTAL_STEPS = 1,    // súčet krokov úspešných prechádzok zo štartu v bunke
+    POSWALK_SUCCESS_COUNT = 2   // počet úspešných prechádzok zo štartu v bunke
+} PosWalkGrid;
+
+// Predvolená konfigurácia: svet 11x11, 1000 krokov, rovnaké pravdepodobnosti, jedno vlákno.
+void poswalk_config_default(PosWalkConfig *cfg);
+
+// Nový svet podľa konfigurácie, zatiaľ bez replikácií.
+PosWalk *poswalk_create(const PosWalkConfig *cfg);
+// Svet a výsledky zo súboru uloženého serverom alebo poswalk_save (cesta, nie saved/).
+// Z run sa berú len seed, threads, batch (NULL = predvolené); ďalšie replikácie sa pripočítajú.
+PosWalk *poswalk_load(const char *path, const PosWalkConfig *run);
+void poswalk_destroy(PosWalk *w);
+
+// Odsimuluje ďalších replications replikácií.
+int poswalk_run(PosWalk *w, int replications);
+// Pridáva replikácie po blokoch, kým 95 % interval pravdepodobnosti úspechu v každej voľnej
+// bunke nie je najviac ±half_width, najviac však do max_replications replikácií spolu.
+// Vráti 0 ak sa presnosť dosiahla, 1 ak sa skončilo na max_replications, -1 pri chybe.
+int poswalk_run_until(PosWalk *w, double half_width, int max_replications);
+// Aktuálna polovičná šírka 95 % intervalu v najhoršej bunke (Agresti–Coull).
+double poswalk_precision(const PosWalk *w);
+
+int poswalk_world_size(const PosWalk *w);
+int poswalk_replications(const PosWalk *w);
+// Ukazovateľ do mriežky simulácie; platí do poswalk_destroy, obsah mení poswalk_run*.
+const int32_t *poswalk_grid(const PosWalk *w, PosWalkGrid which);
+// Mapa obsadenosti (2 * n * n: úspešné, potom neúspešné prechádzky) alebo NULL.
+const long long *poswalk_occupancy(const PosWalk *w);
+// Úspešné prechádzky podľa cieľa (v poradí z cfg.targets); *count = počet cieľov, bez cieľov NULL.
+const long long *poswalk_target_hits(const PosWalk *w, int *count);
+
+int poswalk_save(const PosWalk *w, const char *path);
+
+// Dôvod poslednej chyby API vo volajúcom vlákne ("" ak ešte žiadna nebola).
+const char *poswalk_last_error(void);
+
+#endif // POSWALK_H
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "probfield.h"
+#include "simulation.h"
+
+// Pole pravdepodobností: načítanie, normalizácia a alias tabuľky pre krok chodca.
+
+int probfield_alloc(SharedState *S)
+{
+    size_t cells = (size_t)S->world_size * S->world_size;
+    free(S->prob_field);
+    free(S->prob_alias);
+    S->prob_field = malloc(4 * cells * sizeof(double));
+    S->prob_alias = malloc(4 * cells * sizeof(uint32_t));
+    if (!S->prob_field || !S->prob_alias) {
+        printf("Error: Could not allocate probability field.\n");
+        free(S->prob_field);
+        free(S->prob_alias);
+        S->prob_field = NULL;
+        S->prob_alias = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+int probfield_load(SharedState *S, const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Could not open probability field '%s'.\n", filename);
+        return 0;
+    }
+    int size = 0;
+    if (fscanf(file, "%d", &size) != 1 || size != S->world_size) {
+        printf("Error: Probability field size %d does not match world size %d.\n", size, S->world_size);
+        fclose(file);
+        return 0;
+    }
+    if (!probfield_alloc(S)) {
+        fclose(file);
+        return 0;
+    }
+    size_t total = 4 * (size_t)size * size;
+    for (size_t i = 0; i < total; i++) {
+        if (fscanf(file, "%lf", &S->prob_field[i]) != 1) {
+            printf("Error: Invalid probability field format at position [%d][%d].\n",
+                   (int)(i / 4 / size), (int)(i / 4 % size));
+            fclose(file);
+            return 0;
+        }
+    }
+    fclose(file);
+    if (!probfield_build(S)) return 0;
+    printf("Probability field loaded successfully from '%s'.\n", filename);
+    return 1;
+}
+
+// Alias tabuľka (Vose) pre 4 smery v celých číslach: váhy so súčtom 2^32, stĺpec má kapacitu 2^30.
+static void build_cell(const double *p, uint32_t *out)
+{
+    uint64_t w[4];
+    uint64_t sum = 0;
+    int largest = 0;
+    for (int d = 0; d < 4; d++) {
+        w[d] = (uint64_t)(p[d] * 4294967296.0);
+        sum += w[d];
+        if (p[d] > p[largest]) largest = d;
+    }
+    w[largest] += (1ull << 32) - sum;  // zaokrúhľovacie zvyšky
+
+    int small[4], large[4], ns = 0, nl = 0;
+    for (int d = 0; d < 4; d++) {
+        if (w[d] < PROBFIELD_CUT_ONE) small[ns++] = d;
+        else large[nl++] = d;
+    }
+    while (ns > 0 && nl > 0) {
+        int s = small[--ns];
+        int l = large[nl - 1];
+        out[s] = ((uint32_t)l << PROBFIELD_CUT_BITS) | (uint32_t)w[s];
+        w[l] -= PROBFIELD_CUT_ONE - w[s];
+        if (w[l] < PROBFIELD_CUT_ONE) {
+            nl--;
+            small[ns++] = l;
+        }
+    }
+    // Plné stĺpce (a zvyšky po zaokrúhlení) vždy vrátia vlastný smer.
+    while (nl > 0) {
+        int d = large[--nl];
+        out[d] = ((uint32_t)d << PROBFIELD_CUT_BITS) | PROBFIELD_CUT_MASK;
+    }
+    while (ns > 0) {
+        int d = small[--ns];
+        out[d] = ((uint32_t)d << PROBFIELD_CUT_BITS) | PROBFIELD_CUT_MASK;
+    }
+}
+
+int probfield_build(SharedState *S)
+{
+    size_t cells = (size_t)S->world_size * S->world_size;
+    for (size_t c = 0; c < cells; c++) {
+        double *p = &S->prob_field[4 * c];
+        double sum = p[0] + p[1] + p[2] + p[3];
+        if (p[0] < 0.0 || p[1] < 0.0 || p[2] < 0.0 || p[3] < 0.0 || !(sum > 0.0)) {
+            printf("Error: Invalid move probabilities in field at [%d][%d].\n",
+                   (int)(c / S->world_size), (int)(c % S->world_size));
+            return 0;
+        }
+        for (int d = 0; d < 4; d++) p[d] /= sum;
+        build_cell(p, &S->prob_alias[4 * c]);
+    }
+    return 1;
+}
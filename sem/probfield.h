@@ -0,0 +1,37 @@
+#ifndef PROBFIELD_H
+#define PROBFIELD_H
+
+#include <stdint.h>
+
+// Pole pravdepodobností pohybu (--prob-field): vlastná štvorica up/down/left/right v každej bunke
+// namiesto jedného globálneho vektora (vietor, svahy, prúdy).
+// Súbor má tvar ako obstacles.txt: veľkosť N, potom N*N štvoríc "up down left right" po riadkoch.
+// Štvorice sa normalizujú na súčet 1.
+//
+// Krok nad poľom používa predpočítanú alias tabuľku v pevnej desatinnej čiarke: 4 slová na bunku
+// za sebou (index bunky * 4), v slove spodných 30 bitov hranica a horné 2 bity náhradný smer.
+// Horné 2 bity náhodného čísla vyberú slovo, spodných 30 bitov sa porovná s hranicou.
+
+#define PROBFIELD_CUT_BITS 30
+#define PROBFIELD_CUT_ONE (1u << PROBFIELD_CUT_BITS)
+#define PROBFIELD_CUT_MASK (PROBFIELD_CUT_ONE - 1)
+
+struct SharedState;
+
+// Smer kroku z alias tabuľky bunky (0 up, 1 down, 2 left, 3 right).
+static inline int probfield_sample(const uint32_t *cell, uint64_t u)
+{
+    uint32_t col = (uint32_t)(u >> 62);
+    uint32_t e = cell[col];
+    return ((uint32_t)u & PROBFIELD_CUT_MASK) < (e & PROBFIELD_CUT_MASK) ? (int)col
+                                                                         : (int)(e >> PROBFIELD_CUT_BITS);
+}
+
+// Alokuje S->prob_field (4 * n*n hodnôt) a S->prob_alias; uvoľní ich free_world. Vráti 1/0.
+int probfield_alloc(struct SharedState *S);
+// Načíta pole zo súboru (veľkosť musí sedieť so svetom) a postaví alias tabuľky. Vráti 1/0.
+int probfield_load(struct SharedState *S, const char *filename);
+// Znormalizuje S->prob_field a prepočíta z neho S->prob_alias. Vráti 1/0 (bunka so súčtom 0).
+int probfield_build(struct SharedState *S);
+
+#endif // PROBFIELD_H
@@ -0,0 +1,223 @@
+#define _POSIX_C_SOURCE 200809L
+#include "pyramid.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+
+// Pyramída štatistík: rozloženie segmentu, mapovanie a inkrementálna aktualizácia.
+
+// Zarovná veľkosť na 64 bajtov (začiatok každej úrovne na cache line).
+static uint64_t align64(uint64_t v)
+{
+	return (v + 63) & ~(uint64_t)63;
+}
+
+// Vypočíta rozmery a posuny úrovní; vráti celkovú veľkosť segmentu.
+static uint64_t pyramid_layout(int n, PyramidHeader *h)
+{
+	memset(h, 0, sizeof(*h));
+	h->magic = PYR_MAGIC;
+	h->world_size = n;
+
+	uint64_t off = align64(sizeof(PyramidHeader));
+	h->dim[0] = n;
+	h->offset[0] = off;
+	off = align64(off + 3 * (uint64_t)n * n * sizeof(int));
+	h->stale_offset = off;
+	off = align64(off + (uint64_t)n * n);
+
+	int k = 1;
+	int dim = n;
+	while (dim > 1 && k < PYR_MAX_LEVELS) {
+		dim = (dim + 1) / 2;
+		h->dim[k] = dim;
+		h->offset[k] = off;
+		off = align64(off + (uint64_t)dim * dim * sizeof(PyramidCell));
+		k++;
+	}
+	h->levels = k;
+	h->total_bytes = off;
+	return off;
+}
+
+// Naplní lokálny handle ukazovateľmi do namapovaného segmentu.
+static void pyramid_bind(Pyramid *p, void *addr, size_t size)
+{
+	memset(p, 0, sizeof(*p));
+	p->hdr = (PyramidHeader *)addr;
+	p->size = size;
+	p->grid = (int *)((char *)addr + p->hdr->offset[0]);
+	p->stale = (uint8_t *)addr + p->hdr->stale_offset;
+	for (int k = 1; k < p->hdr->levels; k++)
+		p->level[k] = (PyramidCell *)((char *)addr + p->hdr->offset[k]);
+}
+
+// Server: vytvorí segment pre svet n x n.
+int pyramid_create(const char *name, int world_size, Pyramid *out)
+{
+	if (!name || !out || world_size <= 0) return -1;
+
+	PyramidHeader h;
+	uint64_t size = pyramid_layout(world_size, &h);
+
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+	if (fd == -1) return -1;
+	if (ftruncate(fd, (off_t)size) == -1) {
+		close(fd);
+		shm_unlink(name);
+		return -1;
+	}
+
+	void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		shm_unlink(name);
+		return -1;
+	}
+
+	// ftruncate už segment vynuloval, stačí zapísať hlavičku.
+	memcpy(addr, &h, sizeof(h));
+	pyramid_bind(out, addr, size);
+	return 0;
+}
+
+// Klient: otvorí existujúci segment len na čítanie.
+int pyramid_open(const char *name, Pyramid *out)
+{
+	if (!name || !out) return -1;
+
+	int fd = shm_open(name, O_RDONLY, 0666);
+	if (fd == -1) return -1;
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(PyramidHeader)) {
+		close(fd);
+		return -1;
+	}
+
+	void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) return -1;
+
+	const PyramidHeader *h = addr;
+	if (h->magic != PYR_MAGIC || h->total_bytes > (uint64_t)st.st_size ||
+	    h->levels <= 0 || h->levels > PYR_MAX_LEVELS) {
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	pyramid_bind(out, addr, st.st_size);
+	return 0;
+}
+
+// Odmapuje segment z procesu.
+void pyramid_close(Pyramid *p)
+{
+	if (p && p->hdr) munmap(p->hdr, p->size);
+	if (p) memset(p, 0, sizeof(*p));
+}
+
+// Odstráni segment zo systému.
+int pyramid_unlink(const char *name)
+{
+	if (!name) return -1;
+	return shm_unlink(name);
+}
+
+// Prepočíta všetky úrovne > 0 z úrovne 0.
+void pyramid_rebuild(Pyramid *p)
+{
+	if (!p || !p->hdr) return;
+	int n = p->hdr->world_size;
+	size_t cells = (size_t)n * n;
+	const int *obst = p->grid;
+	const int *total = p->grid + cells;
+	const int *succ = p->grid + 2 * cells;
+
+	// Úroveň 1 priamo z mriežok, každá ďalšia zo 4 blokov predošlej.
+	for (int k = 1; k < p->hdr->levels; k++) {
+		int dim = p->hdr->dim[k];
+		int pdim = p->hdr->dim[k - 1];
+		PyramidCell *lv = p->level[k];
+		memset(lv, 0, (size_t)dim * dim * sizeof(PyramidCell));
+
+		for (int y = 0; y < pdim; y++) {
+			for (int x = 0; x < pdim; x++) {
+				PyramidCell *dst = &lv[(size_t)(y >> 1) * dim + (x >> 1)];
+				if (k == 1) {
+					size_t i = (size_t)y * n + x;
+					dst->total_steps += total[i];
+					dst->success_count += succ[i];
+					dst->free_cells += obst[i] ? 0 : 1;
+					dst->area += 1;
+					dst->stale_cells += p->stale[i];
+				} else {
+					const PyramidCell *src = &p->level[k - 1][(size_t)y * pdim + x];
+					dst->total_steps += src->total_steps;
+					dst->success_count += src->success_count;
+					dst->free_cells += src->free_cells;
+					dst->area += src->area;
+					dst->stale_cells += src->stale_cells;
+				}
+			}
+		}
+	}
+	p->hdr->version++;
+}
+
+// Inkrementálne pripočíta úspech z bunky (x, y) do všetkých vyšších úrovní.
+void pyramid_add(Pyramid *p, int x, int y, int steps)
+{
+	if (!p || !p->hdr) return;
+	for (int k = 1; k < p->hdr->levels; k++) {
+		PyramidCell *c = &p->level[k][(size_t)(y >> k) * p->hdr->dim[k] + (x >> k)];
+		c->total_steps += steps;
+		c->success_count += 1;
+	}
+}
+
+// Pripočíta viac úspechov z bunky naraz (zlúčenie čiastkových výsledkov workera).
+void pyramid_add_many(Pyramid *p, int x, int y, int64_t steps, int64_t successes)
+{
+	if (!p || !p->hdr) return;
+	for (int k = 1; k < p->hdr->levels; k++) {
+		PyramidCell *c = &p->level[k][(size_t)(y >> k) * p->hdr->dim[k] + (x >> k)];
+		c->total_steps += steps;
+		c->success_count += successes;
+	}
+}
+
+// Označí bunku ako prepočítavanú alebo hotovú; počty vyšších úrovní sa menia len pri zmene.
+void pyramid_set_stale(Pyramid *p, int x, int y, bool stale)
+{
+	if (!p || !p->hdr) return;
+	size_t i = (size_t)y * p->hdr->world_size + x;
+	if (p->stale[i] == (stale ? 1 : 0)) return;
+	p->stale[i] = stale ? 1 : 0;
+	for (int k = 1; k < p->hdr->levels; k++)
+		p->level[k][(size_t)(y >> k) * p->hdr->dim[k] + (x >> k)].stale_cells += stale ? 1 : -1;
+}
+
+// Vráti agregát bloku (bx, by) na úrovni k.
+bool pyramid_block(const Pyramid *p, int k, int bx, int by, PyramidCell *out)
+{
+	if (!p || !p->hdr || k < 0 || k >= p->hdr->levels) return false;
+	int dim = p->hdr->dim[k];
+	if (bx < 0 || by < 0 || bx >= dim || by >= dim) return false;
+
+	if (k == 0) {
+		size_t cells = (size_t)dim * dim;
+		size_t i = (size_t)by * dim + bx;
+		out->free_cells = p->grid[i] ? 0 : 1;
+		out->total_steps = p->grid[cells + i];
+		out->success_count = p->grid[2 * cells + i];
+		out->area = 1;
+		out->stale_cells = p->stale[i];
+	} else {
+		*out = p->level[k][(size_t)by * dim + bx];
+	}
+	return true;
+}
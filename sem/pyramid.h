@@ -0,0 +1,64 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Viacúrovňová pyramída štatistík v zdieľanej pamäti (mipmapa).
+// Úroveň 0 sú samotné mriežky sveta (obstacles, total_steps, success_count),
+// úroveň k > 0 sčítava bloky 2^k x 2^k. Klient tak číta len úroveň a výrez,
+// ktorý práve zobrazuje, bez ohľadu na veľkosť sveta.
+#define PYR_MAGIC 0x32595050u /* "PPY2" */
+#define PYR_MAX_LEVELS 24
+
+typedef struct PyramidCell {
+	int64_t total_steps;   // súčet krokov úspešných prechádzok v bloku
+	int64_t success_count; // súčet úspechov v bloku
+	int32_t free_cells;    // počet buniek bez prekážky
+	int32_t area;          // počet buniek bloku (okrajové bloky sú menšie)
+	int32_t stale_cells;   // bunky bloku, ktoré sa po úprave prekážok prepočítavajú
+} PyramidCell;
+
+typedef struct PyramidHeader {
+	uint32_t magic;
+	int32_t world_size;
+	int32_t levels;        // vrátane úrovne 0
+	uint32_t version;      // zvyšuje sa po každom dokončenom riadku simulácie
+	int32_t walker_x;      // skutočná (neorezaná) pozícia chodca
+	int32_t walker_y;
+	int32_t dim[PYR_MAX_LEVELS];      // rozmer úrovne = ceil(n / 2^k)
+	uint64_t offset[PYR_MAX_LEVELS];  // posun úrovne od začiatku segmentu
+	uint64_t stale_offset;            // príznaky prepočítavaných buniek úrovne 0 (n * n bajtov)
+	uint64_t total_bytes;
+} PyramidHeader;
+
+// Lokálny handle na namapovaný segment.
+typedef struct Pyramid {
+	PyramidHeader *hdr;
+	size_t size;
+	int *grid;             // úroveň 0: obstacles | total_steps | success_count (3 * n * n)
+	uint8_t *stale;        // úroveň 0: 1 = bunka sa prepočítava
+	PyramidCell *level[PYR_MAX_LEVELS]; // level[0] sa nepoužíva
+} Pyramid;
+
+// Server: vytvorí segment pre svet n x n.
+int pyramid_create(const char *name, int world_size, Pyramid *out);
+// Klient: otvorí existujúci segment len na čítanie.
+int pyramid_open(const char *name, Pyramid *out);
+void pyramid_close(Pyramid *p);
+int pyramid_unlink(const char *name);
+
+// Prepočíta všetky úrovne > 0 z úrovne 0 (po načítaní alebo zmene prekážok).
+void pyramid_rebuild(Pyramid *p);
+// Inkrementálne pripočíta úspech z bunky (x, y) do všetkých vyšších úrovní.
+void pyramid_add(Pyramid *p, int x, int y, int steps);
+void pyramid_add_many(Pyramid *p, int x, int y, int64_t steps, int64_t successes);
+// Označí bunku (x, y) ako prepočítavanú alebo hotovú a upraví počty vo vyšších úrovniach.
+void pyramid_set_stale(Pyramid *p, int x, int y, bool stale);
+// Vráti agregát bloku (bx, by) na úrovni k (pre k = 0 ho zostaví z mriežok).
+bool pyramid_block(const Pyramid *p, int k, int bx, int by, PyramidCell *out);
+
+#endif // PYRAMID_H
@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "render.h"
+#include "ipc.h"
+
+// Rozdielový renderer klienta: snímka v pamäti, porovnanie s predošlou, jeden zápis.
+#define RENDER_MAX_ROWS (IPC_MAX_WORLD + 24)
+#define RENDER_MAX_COLS (IPC_MAX_WORLD * 4 + 16)
+// Krátku nezmenenú medzeru je lacnejšie prepísať než posielať novú escape sekvenciu.
+#define RENDER_MERGE_GAP 6
+
+typedef struct Frame {
+    int rows;
+    int len[RENDER_MAX_ROWS];
+    char text[RENDER_MAX_ROWS][RENDER_MAX_COLS];
+} Frame;
+
+struct Renderer {
+    Frame frames[2];
+    int cur;          // index skladanej snímky
+    bool full;        // najbližšie prekreslenie celej obrazovky
+    char *out;        // výstupný buffer pre jeden write(2)
+    size_t out_len;
+    size_t out_cap;
+};
+
+// Vytvorí renderer; prvá snímka sa vykreslí celá.
+Renderer *render_create(void)
+{
+    Renderer *r = calloc(1, sizeof(Renderer));
+    if (!r) return NULL;
+    r->out_cap = RENDER_MAX_ROWS * (RENDER_MAX_COLS + 16);
+    r->out = malloc(r->out_cap);
+    if (!r->out) {
+        free(r);
+        return NULL;
+    }
+    r->full = true;
+    return r;
+}
+
+// Uvoľní renderer.
+void render_destroy(Renderer *r)
+{
+    if (!r) return;
+    free(r->out);
+    free(r);
+}
+
+// Pridá bajty do výstupného bufferu (kapacita pokrýva celú obrazovku s escape kódmi).
+static void out_append(Renderer *r, const char *data, size_t len)
+{
+    if (r->out_len + len > r->out_cap) {
+        size_t cap = r->out_cap * 2;
+        while (cap < r->out_len + len) cap *= 2;
+        char *buf = realloc(r->out, cap);
+        if (!buf) return;
+        r->out = buf;
+        r->out_cap = cap;
+    }
+    memcpy(r->out + r->out_len, data, len);
+    r->out_len += len;
+}
+
+// Reťazcový literál bez ručne rátanej dĺžky (bez koncovej nuly).
+#define OUT_LITERAL(r, s) out_append((r), (s), sizeof(s) - 1)
+
+// Presunie kurzor na riadok/stĺpec (číslované od 0).
+static void out_move(Renderer *r, int row, int col)
+{
+    char esc[32];
+    int n = snprintf(esc, sizeof(esc), "\033[%d;%dH", row + 1, col + 1);
+    out_append(r, esc, (size_t)n);
+}
+
+// Zapíše celý buffer na stdout (jeden write, opakuje len pri čiastočnom zápise).
+static void out_flush(Renderer *r)
+{
+    size_t off = 0;
+    while (off < r->out_len) {
+        ssize_t n = write(STDOUT_FILENO, r->out + off, r->out_len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        off += (size_t)n;
+    }
+    r->out_len = 0;
+}
+
+// Začne skladať novú snímku.
+void render_begin(Renderer *r)
+{
+    if (!r) return;
+    r->frames[r->cur].rows = 0;
+}
+
+// Pridá do snímky ďalší riadok (printf formát).
+void render_line(Renderer *r, const char *fmt, ...)
+{
+    if (!r) return;
+    Frame *f = &r->frames[r->cur];
+    if (f->rows >= RENDER_MAX_ROWS) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(f->text[f->rows], RENDER_MAX_COLS, fmt, ap);
+    va_end(ap);
+    if (n < 0) n = 0;
+    if (n >= RENDER_MAX_COLS) n = RENDER_MAX_COLS - 1;
+    f->len[f->rows++] = n;
+}
+
+// Vynúti prekreslenie celej obrazovky pri najbližšom render_present.
+void render_invalidate(Renderer *r)
+{
+    if (r) r->full = true;
+}
+
+// Porovná snímku s predošlou a vypíše len zmenené úseky riadkov.
+long render_present(Renderer *r)
+{
+    if (!r) return 0;
+    Frame *cur = &r->frames[r->cur];
+    Frame *prev = &r->frames[1 - r->cur];
+
+    if (r->full) {
+        // Skry kurzor, vyčisti obrazovku a vypíš všetko.
+        OUT_LITERAL(r, "\033[?25l\033[2J\033[H");
+        for (int y = 0; y < cur->rows; y++) {
+            out_append(r, cur->text[y], (size_t)cur->len[y]);
+            OUT_LITERAL(r, "\r\n");
+        }
+        r->full = false;
+    } else {
+        for (int y = 0; y < cur->rows || y < prev->rows; y++) {
+            int clen = y < cur->rows ? cur->len[y] : 0;
+            int plen = y < prev->rows ? prev->len[y] : 0;
+            const char *c = cur->text[y];
+            const char *p = prev->text[y];
+
+            int x = 0;
+            while (x < clen) {
+                if (x < plen && c[x] == p[x]) {
+                    x++;
+                    continue;
+                }
+                // Začiatok zmeneného úseku; zlúč ho s ďalšími, ak medzera je krátka.
+                int start = x;
+                int end = x + 1;
+                int same = 0;
+                for (x = end; x < clen && same < RENDER_MERGE_GAP; x++) {
+                    if (x < plen && c[x] == p[x]) {
+                        same++;
+                    } else {
+                        same = 0;
+                        end = x + 1;
+                    }
+                }
+                out_move(r, y, start);
+                out_append(r, c + start, (size_t)(end - start));
+                x = end;
+            }
+            if (clen < plen) {
+                // Riadok sa skrátil: zmaž zvyšok.
+                out_move(r, y, clen);
+                OUT_LITERAL(r, "\033[K");
+            }
+        }
+    }
+
+    long written = (long)r->out_len;
+    out_flush(r);
+    r->cur = 1 - r->cur;
+    return written;
+}
+
+// Obnoví kurzor a presunie ho pod poslednú snímku.
+void render_finish(Renderer *r)
+{
+    if (!r) return;
+    Frame *last = &r->frames[1 - r->cur];
+    out_move(r, last->rows, 0);
+    OUT_LITERAL(r, "\033[?25h");
+    out_flush(r);
+}
@@ -0,0 +1,24 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+
+// Terminálový renderer: snímka sa skladá po riadkoch do pamäte, porovná sa
+// s predošlou a na terminál sa jedným write(2) pošlú len zmenené úseky.
+typedef struct Renderer Renderer;
+
+Renderer *render_create(void);
+void render_destroy(Renderer *r);
+
+// Začne skladať novú snímku.
+void render_begin(Renderer *r);
+// Pridá do snímky ďalší riadok (printf formát).
+void render_line(Renderer *r, const char *fmt, ...);
+// Porovná snímku s predošlou a vypíše rozdiely. Vráti počet zapísaných bajtov.
+long render_present(Renderer *r);
+// Vynúti prekreslenie celej obrazovky pri najbližšom render_present.
+void render_invalidate(Renderer *r);
+// Obnoví kurzor a presunie ho pod poslednú snímku.
+void render_finish(Renderer *r);
+
+#endif // RENDER_H
@@ -1,204 +1,158 @@
 #define _POSIX_C_SOURCE 200809L
 #define _XOPEN_SOURCE 500
 #include <stdio.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <string.h>
-#include <sys/select.h>
-#include <sys/time.h>
 
 #include "server.h"
 #include "walker.h"
 #include "world.h"
 #include "ipc.h"
+#include "pyramid.h"
+#include "utils.h"
+#include "netloop.h"
+#include "coord.h"
+#include "trace.h"
+#include "affinity.h"
+#include "worldgen.h"
+#include "probfield.h"
+#include "target.h"
+#include "autotune.h"
+#include "cache.h"
 
 // Konštanty pre timeouty a intervaly
-#define SELECT_TIMEOUT_MS 100
-#define SOCKET_POLL_INTERVAL_MS 50
 #define MAIN_LOOP_INTERVAL_MS 100
 #define SERVER_SHUTDOWN_DELAY_MS 2000
 
-typedef struct ClientConn {
-    int fd;
-    SharedState *S;
-} ClientConn;
-
-typedef struct SocketThreadArgs {
-    SharedState *S;
-    char *sock_path;
-} SocketThreadArgs;
-
-// Orezá world_size na maximum, ktoré podporuje IPC buffer.
-static int clamp_world_size(const SharedState *S)
+// Rozdiel dvoch časov v sekundách.
+static double elapsed_s(const struct timespec *from, const struct timespec *to)
 {
-    if (!S) return 0;
-    return (S->world_size < IPC_MAX_WORLD) ? S->world_size : IPC_MAX_WORLD;
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
 }
 
-// Zapíše základné informácie do IPC (bez veľkých polí).
-static void sync_basic_to_ipc(SharedState *S)
+// Zapíše reťazec ako JSON string (úvodzovky, spätné lomky a riadiace znaky escapuje).
+static void json_string(FILE *f, const char *str)
 {
-    if (!S || !S->ipc) return;
-    int n = clamp_world_size(S);
-
-    int wx = S->walker.x;
-    int wy = S->walker.y;
-    if (wx >= n) wx %= n;
-    if (wy >= n) wy %= n;
-
-    S->ipc->world_size   = n;
-    S->ipc->walker_x     = wx;
-    S->ipc->walker_y     = wy;
-    S->ipc->mode         = S->mode;
-    S->ipc->summary_view = S->summary_view;
-    S->ipc->current_rep  = S->current_rep;
-    S->ipc->replications = S->replications;
-    S->ipc->finished     = S->finished ? 1 : 0;
-}
-
-// Prekážky kopíruj len zriedka (na začiatku alebo pri zmene).
-static void sync_obstacles_to_ipc(SharedState *S)
-{
-    if (!S || !S->ipc) return;
-    int n = clamp_world_size(S);
-    for (int y = 0; y < n; y++) {
-        for (int x = 0; x < n; x++) {
-            S->ipc->obstacles[y][x] = S->obstacles[y][x];
-        }
+    if (!str) {
+        fputs("null", f);
+        return;
     }
-}
-
-// Štatistiky sa kopírujú z vlákna simulácie podľa potreby.
-static void sync_stats_to_ipc(SharedState *S)
-{
-    if (!S || !S->ipc) return;
-    int n = clamp_world_size(S);
-    for (int y = 0; y < n; y++) {
-        for (int x = 0; x < n; x++) {
-            S->ipc->total_steps[y][x]   = S->total_steps[y][x];
-            S->ipc->success_count[y][x] = S->success_count[y][x];
-        }
+    fputc('"', f);
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(f, "\\%c", *p);
+        else if (*p < 0x20) fprintf(f, "\\u%04x", *p);
+        else fputc(*p, f);
     }
+    fputc('"', f);
 }
 
-// Pošle textový reťazec na daný socket.
-static void send_str(int fd, const char *msg)
+// Zapíše CSV pole; ak obsahuje čiarku, úvodzovky alebo nový riadok, dá ho do úvodzoviek.
+static void csv_field(FILE *f, const char *str)
 {
-    if (!msg) return;
-    write(fd, msg, strlen(msg));
+    if (!str) return;
+    if (!strpbrk(str, ",\"\n")) {
+        fputs(str, f);
+        return;
+    }
+    fputc('"', f);
+    for (const char *p = str; *p; p++) {
+        if (*p == '"') fputc('"', f);
+        fputc(*p, f);
+    }
+    fputc('"', f);
 }
 
-// Vlákno pre jedného klienta: spracuje príkazy MODE/SUMMARY.
-static void *client_handler_thread(void *arg)
+// Vypíše strojovo čitateľný súhrn behu (headless): konfigurácia, časy, priepustnosť, výsledný súbor.
+static void print_run_summary(FILE *out, const ServerConfig *config, const SharedState *S,
+                              double sim_s, double wall_s, const char *result_path, int cached_reps)
 {
-    ClientConn *ctx = (ClientConn *)arg;
-    int fd = ctx->fd;
-    SharedState *S = ctx->S;
-    char buf[256];
-    ssize_t nread;
-    while (1) {
-        pthread_mutex_lock(&S->lock);
-        bool finished = S->finished;
-        pthread_mutex_unlock(&S->lock);
-        if (finished) break;
-
-        nread = read(fd, buf, sizeof(buf)-1);
-        if (nread <= 0) {
-            break;
-        }
-        buf[nread] = '\0';
-
-        char cmd[16];
-        int val = -1;
-
-        if (sscanf(buf, "%15s %d", cmd, &val) == 2) {
-            if (strcmp(cmd, "MODE") == 0 && (val == 1 || val == 2)) {
-                pthread_mutex_lock(&S->lock);
-                S->mode = val;
-                sync_basic_to_ipc(S);
-                pthread_mutex_unlock(&S->lock);
-                send_str(fd, "OK\n");
-            } else if (strcmp(cmd, "SUMMARY") == 0 && (val == 0 || val == 1)) {
-                pthread_mutex_lock(&S->lock);
-                S->summary_view = val;
-                sync_basic_to_ipc(S);
-                pthread_mutex_unlock(&S->lock);
-                send_str(fd, "OK\n");
-            } else {
-                send_str(fd, "ERR\n");
-            }
-        } else {
-            send_str(fd, "ERR\n");
+    double steps_per_s = sim_s > 0 ? S->steps_done / sim_s : 0.0;
+    double walks_per_s = sim_s > 0 ? S->walks_done / sim_s : 0.0;
+    const char *obstacles = !S->use_obstacles ? NULL
+                            : config->generate[0] ? config->generate
+                            : config->obstacles_file[0] ? config->obstacles_file : NULL;
+    const char *resume = config->resume_file[0] ? config->resume_file : NULL;
+
+    if (strcmp(config->summary_format, "csv") == 0) {
+        fprintf(out, "world_size,replications,max_steps,prob_up,prob_down,prob_left,prob_right,"
+                     "obstacles_file,resume_file,walks,steps,sim_time_s,wall_time_s,"
+                     "steps_per_s,walks_per_s,result_file,threads,seed\n");
+        fprintf(out, "%d,%d,%d,%.6f,%.6f,%.6f,%.6f,",
+                S->world_size, S->replications, S->max_steps,
+                S->prob.up, S->prob.down, S->prob.left, S->prob.right);
+        csv_field(out, obstacles);
+        fputc(',', out);
+        csv_field(out, resume);
+        fprintf(out, ",%lld,%lld,%.6f,%.6f,%.1f,%.1f,",
+                S->walks_done, S->steps_done, sim_s, wall_s, steps_per_s, walks_per_s);
+        csv_field(out, result_path);
+        fprintf(out, ",%d,%llu\n", S->threads, (unsigned long long)S->seed);
+    } else {
+        fprintf(out, "{\"world_size\":%d,\"replications\":%d,\"max_steps\":%d,"
+                     "\"prob\":[%.6f,%.6f,%.6f,%.6f],\"obstacles_file\":",
+                S->world_size, S->replications, S->max_steps,
+                S->prob.up, S->prob.down, S->prob.left, S->prob.right);
+        json_string(out, obstacles);
+        fputs(",\"resume_file\":", out);
+        json_string(out, resume);
+        fprintf(out, ",\"walks\":%lld,\"steps\":%lld,\"sim_time_s\":%.6f,\"wall_time_s\":%.6f,"
+                     "\"steps_per_s\":%.1f,\"walks_per_s\":%.1f,\"result_file\":",
+                S->walks_done, S->steps_done, sim_s, wall_s, steps_per_s, walks_per_s);
+        json_string(out, result_path);
+        if (S->ntargets > 0) {
+            fputs(",\"target_hits\":[", out);
+            for (int i = 0; i < S->ntargets; i++) fprintf(out, "%s%lld", i ? "," : "", S->target_hits[i]);
+            fputc(']', out);
         }
+        if (cached_reps >= 0) fprintf(out, ",\"cached_reps\":%d", cached_reps);
+        fprintf(out, ",\"threads\":%d,\"seed\":%llu}\n", S->threads, (unsigned long long)S->seed);
     }
-
-    printf("[Server] Klient sa odpojil.\n");
-    ipc_close_socket(fd);
-    free(ctx);
-    return NULL;
+    fflush(out);
 }
 
-// Počúva na UNIX sockete a pre každého klienta spúšťa handler vlákno.
-static void *socket_thread(void *arg)
+// Zoznam CPU pre simulačné vlákna: --cpus priamo, --numa zoradené po uzloch
+// (spolu s --cpus len CPU zo zoznamu). Servisné vlákna potom bežia mimo nich.
+int server_cpu_plan(const ServerConfig *config, int *cpus, int max)
 {
-    SocketThreadArgs *args = (SocketThreadArgs *)arg;
-    SharedState *S = args->S;
-    char *sock_path = args->sock_path;
-    
-    int listen_fd = ipc_listen_socket(sock_path);
-    if (listen_fd < 0) {
-        free(sock_path);
-        free(args);
-        return NULL;
+    if (config->cpus[0] == '\0' && !config->numa) return 0;
+
+    int count = 0;
+    if (config->cpus[0] != '\0') {
+        count = affinity_parse_list(config->cpus, cpus, max);
+        if (count <= 0) {
+            printf("Error: Invalid --cpus list '%s'.\n", config->cpus);
+            return -1;
+        }
     }
-
-    int first_client = 1;
-    while (1) {
-        pthread_mutex_lock(&S->lock);
-        bool finished = S->finished;
-        pthread_mutex_unlock(&S->lock);
-        if (finished) break;
-
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(listen_fd, &read_fds);
-        struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = SELECT_TIMEOUT_MS * 1000;
-        int ret = select(listen_fd + 1, &read_fds, NULL, NULL, &timeout);
-        if (ret > 0 && FD_ISSET(listen_fd, &read_fds)) {
-            int cfd = ipc_accept_socket(listen_fd);
-            if (cfd >= 0) {
-                if (first_client) {
-                    pthread_mutex_lock(&S->lock);
-                    S->client_connected = 1;
-                    pthread_mutex_unlock(&S->lock);
-                    first_client = 0;
-                }
-                ClientConn *ctx = malloc(sizeof(ClientConn));
-                if (!ctx) {
-                    const char msg[] = "ERR no mem\n";
-                    write(cfd, msg, sizeof(msg) - 1);
-                    ipc_close_socket(cfd);
-                } else {
-                    ctx->fd = cfd;
-                    ctx->S = S;
-                    pthread_t th;
-                    pthread_create(&th, NULL, client_handler_thread, ctx);
-                    pthread_detach(th);
-                }
-            }
+    if (config->numa) {
+        int *all = malloc(2 * max * sizeof(int));
+        if (!all) return -1;
+        int *nodes = all + max;
+        int n = affinity_numa_cpus(all, nodes, max);
+        int kept = 0, last_node = -1, node_count = 0;
+        for (int i = 0; i < n; i++) {
+            bool wanted = (count == 0);
+            for (int j = 0; j < count && !wanted; j++) wanted = (cpus[j] == all[i]);
+            if (!wanted) continue;
+            if (nodes[i] != last_node) node_count++;
+            last_node = nodes[i];
+            all[kept++] = all[i];  // kept <= i, prepisujeme už spracované
+        }
+        memcpy(cpus, all, kept * sizeof(int));
+        free(all);
+        count = kept;
+        if (count == 0) {
+            printf("Error: No usable CPUs for --numa.\n");
+            return -1;
         }
+        printf("[Server] NUMA placement: %d CPU(s) on %d node(s).\n", count, node_count);
     }
-
-    ipc_close_socket(listen_fd);
-    unlink(sock_path);
-    free(sock_path);
-    free(args);
-    return NULL;
+    return count;
 }
 
 // Hlavná funkcia servera: inicializuje stav, IPC, spustí vlákna a uloží výsledky.
@@ -206,21 +160,44 @@ int server_run(const ServerConfig *config)
 {
     if (!config) return 1;
     
+    TRACE_START(); // pred vznikom ďalších vlákien (maska SIGUSR2)
     srand(time(NULL));
+    signal(SIGPIPE, SIG_IGN); // odpojený klient nesmie zhodiť server
+
+    struct timespec wall_start;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    // Headless: bez klienta a animácie; IPC len na požiadanie.
+    bool headless = config->headless != 0;
+    bool use_ipc = !headless || config->headless_ipc;
+
+    // V headless móde patrí stdout len strojovo čitateľnému súhrnu,
+    // bežné hlásenia servera idú na stderr.
+    FILE *summary_out = NULL;
+    if (headless) {
+        int out_fd = dup(STDOUT_FILENO);
+        if (out_fd >= 0) summary_out = fdopen(out_fd, "w");
+        fflush(stdout);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        setvbuf(stdout, NULL, _IOLBF, 0);
+    }
     
     // Generuj unikátne názvy pre IPC na základe PID
     pid_t pid = getpid();
     char shm_name[64];
+    char pyr_name[32];
     char sock_path[128];
     snprintf(shm_name, sizeof(shm_name), "/pos_shm_%d", pid);
+    snprintf(pyr_name, sizeof(pyr_name), "/pos_pyr_%d", pid);
     snprintf(sock_path, sizeof(sock_path), "/tmp/pos_socket_%d", pid);
     
-    // Zapíš info do súboru pre klientov
-    FILE *info_file = fopen("/tmp/pos_server_list.txt", "a");
-    if (info_file) {
-        fprintf(info_file, "PID=%d SHM=%s SOCK=%s\n", pid, shm_name, sock_path);
-        fclose(info_file);
-    }
+    // Do registra sa server zapíše až socket thread, keď už počúva.
+    if (!use_ipc && config->ready_fd >= 0) close(config->ready_fd);
+
+    int cpu_list[AFFINITY_MAX_CPUS];
+    int ncpus = server_cpu_plan(config, cpu_list, AFFINITY_MAX_CPUS);
+    WorldGenSpec gen;
+    if (ncpus < 0) return 1;
 
     SharedState S;
     memset(&S, 0, sizeof(S));
@@ -228,7 +205,10 @@ int server_run(const ServerConfig *config)
     // Ak je zadaný resume_file, načítaj predchádzajúcu simuláciu
     if (config->resume_file[0] != '\0') {
         printf("[Server] Loading previous simulation from '%s'...\n", config->resume_file);
-        if (!load_previous_simulation(&S, config->resume_file)) {
+        TRACE_BEGIN(load_t0);
+        int loaded = load_previous_simulation(&S, config->resume_file);
+        TRACE_END(load_t0, "load_simulation", loaded);
+        if (!loaded) {
             printf("[Server] Failed to load simulation. Exiting.\n");
             return 1;
         }
@@ -247,7 +227,15 @@ int server_run(const ServerConfig *config)
         // IPC setup bude nižšie
     } else {
         // Nová simulácia - použiť konfiguráciu z parametrov
-        if (config->obstacles_file[0] != '\0') {
+        if (config->generate[0] != '\0') {
+            if (config->obstacles_file[0] != '\0') {
+                printf("Error: --generate cannot be combined with -f.\n");
+                return 1;
+            }
+            if (worldgen_parse(config->generate, &gen) != 0) return 1;
+            S.use_obstacles = true;
+            S.world_size = gen.size;
+        } else if (config->obstacles_file[0] != '\0') {
             int size_from_file = get_world_size_from_obstacles(config->obstacles_file);
             if (size_from_file > 0) {
                 S.use_obstacles = true;
@@ -259,6 +247,14 @@ int server_run(const ServerConfig *config)
         } else {
             S.use_obstacles = false;
             S.world_size = config->world_size;
+            // Bez prekážok určuje veľkosť sveta pole pravdepodobností, ak je zadané.
+            if (config->prob_field[0] != '\0') {
+                S.world_size = get_world_size_from_obstacles(config->prob_field);
+                if (S.world_size <= 0) {
+                    printf("Error: Could not read probability field '%s'.\n", config->prob_field);
+                    return 1;
+                }
+            }
         }
 
         S.replications = config->replications;
@@ -272,20 +268,45 @@ int server_run(const ServerConfig *config)
     S.summary_view = 0;
     S.finished = false;
     S.client_connected = 0;
+    S.threads = config->threads > 0 ? config->threads : 1;
+    S.batch = config->batch;
+    S.cpus = ncpus > 0 ? cpu_list : NULL;
+    S.ncpus = ncpus;
+    // Resume pokračuje v prúdoch seedu uloženého v súbore: replikácie R.. sú nové prúdy toho istého
+    // seedu a výsledok je rovnaký ako jeden dlhší beh. Iný --seed je dovolený, len nie reprodukovateľný.
+    if (config->resume_file[0] && S.seed && config->seed && config->seed != S.seed)
+        printf("[Server] Note: '%s' was computed with seed %llu; continuing with seed %llu.\n",
+               config->resume_file, (unsigned long long)S.seed, (unsigned long long)config->seed);
+    S.seed = config->seed ? config->seed
+           : S.seed ? S.seed
+                    : walk_rng_mix((uint64_t)time(NULL) ^ ((uint64_t)pid << 32));
 
     printf("Starting simulation:\n");
     printf("  World size = %d\n", S.world_size);
     printf("  Replications = %d\n", S.replications);
     printf("  Maximum steps = %d\n", S.max_steps);
-    printf("  Move probabilities = %.2f/%.2f/%.2f/%.2f\n", S.prob.up, S.prob.down, S.prob.left, S.prob.right);
-    printf("  Obstacles = %s\n", S.use_obstacles ? config->obstacles_file : "none");
+    if (config->prob_field[0] || S.prob_field)
+        printf("  Move probabilities = field '%s'\n",
+               config->prob_field[0] ? config->prob_field : config->resume_file);
+    else
+        printf("  Move probabilities = %.2f/%.2f/%.2f/%.2f\n", S.prob.up, S.prob.down, S.prob.left, S.prob.right);
+    printf("  Obstacles = %s\n", !S.use_obstacles ? "none"
+                                : config->generate[0] ? config->generate : config->obstacles_file);
+    printf("  Threads = %d, seed = %llu\n", S.threads, (unsigned long long)S.seed);
+    if (S.ncpus > 0) {
+        printf("  Simulation CPUs =");
+        for (int i = 0; i < S.ncpus; i++) printf(" %d", S.cpus[i]);
+        printf("\n");
+    }
     printf("  Output file = %s\n", config->output_file[0] ? config->output_file : "(none)");
     printf("  Server PID = %d\n", pid);
-    printf("  SHM name = %s\n", shm_name);
-    printf("  Socket path = %s\n", sock_path);
+    if (use_ipc) {
+        printf("  SHM name = %s\n", shm_name);
+        printf("  Socket path = %s\n", sock_path);
+    }
 
     IPCShared *ipc = NULL;
-    if (ipc_create_shared(shm_name, &ipc) != 0) {
+    if (use_ipc && ipc_create_shared(shm_name, &ipc) != 0) {
         printf("Chyba: nepodarilo sa vytvoriť zdieľanú pamäť.\n");
         return 1;
     }
@@ -297,11 +318,17 @@ int server_run(const ServerConfig *config)
         initialize_world(&S);
 
         if (S.use_obstacles) {
-            if (!load_obstacles(&S, config->obstacles_file)) {
+            TRACE_BEGIN(load_t0);
+            int loaded = config->generate[0] ? worldgen_generate(&S, &gen, stdout) == 0
+                                             : load_obstacles(&S, config->obstacles_file);
+            TRACE_END(load_t0, "load_obstacles", loaded);
+            if (!loaded) {
                 printf("Failed to load obstacles. Exiting.\\n");
                 free_world(&S);
-                ipc_close_shared(ipc);
-                ipc_unlink_shared(shm_name);
+                if (ipc) {
+                    ipc_close_shared(ipc);
+                    ipc_unlink_shared(shm_name);
+                }
                 return 1;
             }
         }
@@ -311,6 +338,183 @@ int server_run(const ServerConfig *config)
         S.current_rep = 0;
     }
     walker_init(&S.walker, S.world_size/2, S.world_size/2);
+    S.walker_interval_ms = config->walker_interval_ms;
+    S.walker_horizon = config->walker_steps;
+
+    // Mriežky v mmap: súbor so živými výsledkami a/alebo hugepages (veľké svety).
+    bool grids_mapped = config->grid_file[0] != '\0' || config->hugepages;
+    if (grids_mapped) {
+        int mapped = -1;
+        // Koordinátor dokončuje rozsahy mimo poradia, hlavička súboru by neopísala stav.
+        if (config->grid_file[0] && config->coordinator_addr[0])
+            printf("Error: --grid-file cannot be combined with --coordinator.\n");
+        else
+            mapped = world_map_grids(&S, config->grid_file[0] ? config->grid_file : NULL,
+                                     config->hugepages != 0);
+        if (mapped < 0) {
+            free_world(&S);
+            if (ipc) {
+                ipc_close_shared(ipc);
+                ipc_unlink_shared(shm_name);
+            }
+            return 1;
+        }
+        if (mapped == 1) {
+            S.replications = S.current_rep + config->replications;
+            printf("[Server] Continuing grid file '%s' from %d replications (total %d).\n",
+                   config->grid_file, S.current_rep, S.replications);
+        }
+    }
+
+    // Pole pravdepodobností: z --prob-field pri novom behu, pri resume zo súboru výsledkov.
+    if (config->prob_field[0] || S.prob_field) {
+        bool ok = false;
+        if (config->grid_file[0])
+            printf("Error: --prob-field cannot be combined with --grid-file.\n");
+        else if (config->resume_file[0] && config->prob_field[0])
+            printf("Error: --prob-field cannot be changed when resuming (the field is stored in '%s').\n",
+                   config->resume_file);
+        else
+            ok = S.prob_field != NULL || probfield_load(&S, config->prob_field);
+        if (!ok) {
+            free_world(&S);
+            if (ipc) {
+                ipc_close_shared(ipc);
+                ipc_unlink_shared(shm_name);
+            }
+            return 1;
+        }
+    }
+
+    // Ciele: --target pri novom behu. Pri resume platia ciele zo súboru; iný cieľ sa dá zadať len
+    // na toruse s jedinou cieľovou bunkou, kde sa uložené výsledky iba posunú (bez nových prechádzok).
+    if (config->targets[0]) {
+        TargetRect targets[TARGET_MAX];
+        int count = target_parse(config->targets, targets, TARGET_MAX);
+        bool same = count == S.ntargets && count > 0 &&
+                    memcmp(targets, S.targets, count * sizeof(TargetRect)) == 0;
+        bool ok = count > 0;
+        if (ok && config->grid_file[0]) {
+            printf("Error: --target cannot be combined with --grid-file.\n");
+            ok = false;
+        } else if (ok && config->resume_file[0] && !same) {
+            if (target_translatable(&S, S.targets, S.ntargets) && target_translatable(&S, targets, count)) {
+                int fx = S.ntargets ? S.targets[0].x0 : S.world_size / 2;
+                int fy = S.ntargets ? S.targets[0].y0 : S.world_size / 2;
+                target_shift_results(&S, targets[0].x0 - fx, targets[0].y0 - fy);
+                printf("[Server] Reusing results for target %d,%d shifted to %d,%d (obstacle-free torus).\n",
+                       fx, fy, targets[0].x0, targets[0].y0);
+            } else {
+                printf("Error: '%s' was computed for other targets and cannot be shifted "
+                       "(obstacles, probability field or more than one target cell).\n", config->resume_file);
+                ok = false;
+            }
+        }
+        if (ok && !same) ok = target_setup(&S, targets, count) == 0;
+        if (!ok) {
+            free_world(&S);
+            if (ipc) {
+                ipc_close_shared(ipc);
+                ipc_unlink_shared(shm_name);
+            }
+            return 1;
+        }
+    }
+    if (S.ntargets > 0) {
+        char spec[256];
+        target_format(&S, spec, sizeof(spec));
+        printf("[Server] Targets: %s%s\n", spec, S.target_map ? "" : " (center results shifted on the torus)");
+    }
+
+    // Úložisko výsledkov (--cache): hotová konfigurácia sa neráta znova, kratší záznam sa len predĺži.
+    int cached_reps = -1;
+    if (config->cache) {
+        const char *other = config->resume_file[0] ? "-l"
+                          : config->grid_file[0] ? "--grid-file"
+                          : config->coordinator_addr[0] ? "--coordinator"
+                          : config->occupancy ? "--occupancy" : NULL;
+        if (other) {
+            printf("Error: --cache cannot be combined with %s.\n", other);
+            free_world(&S);
+            if (ipc) {
+                ipc_close_shared(ipc);
+                ipc_unlink_shared(shm_name);
+            }
+            return 1;
+        }
+        char path[256];
+        uint64_t seed;
+        int reps;
+        cached_reps = 0;
+        if (cache_lookup(&S, config->seed, path, sizeof(path), &seed, &reps)) {
+            S.seed = seed;  // bez --seed pokračuje v prúdoch záznamu
+            cached_reps = cache_load(&S, path);
+        }
+        if (cached_reps <= 0) {
+            cached_reps = 0;
+            printf("[Server] Cache miss (key %016llx).\n", (unsigned long long)cache_key(&S));
+        } else if (S.current_rep >= S.replications) {
+            printf("[Server] Cache hit: '%s' has %d replications (seed %llu), nothing to compute.\n",
+                   path, cached_reps, (unsigned long long)S.seed);
+        } else {
+            printf("[Server] Cache hit: '%s' has %d replications (seed %llu), computing %d more.\n",
+                   path, cached_reps, (unsigned long long)S.seed, S.replications - cached_reps);
+        }
+    }
+
+    // Automatické ladenie (--autotune): prepíše -t a --batch uloženou alebo nameranou voľbou.
+    if (config->autotune) {
+        if (config->coordinator_addr[0]) {
+            printf("[Server] Note: --autotune has no effect with --coordinator.\n");
+        } else if (S.current_rep >= S.replications) {
+            printf("[Server] Note: nothing to compute, skipping --autotune.\n");
+        } else {
+            int max_threads = S.ncpus > 0 ? S.ncpus : (int)sysconf(_SC_NPROCESSORS_ONLN);
+            autotune_run(&S, max_threads);
+        }
+    }
+
+    // Mapa obsadenosti: zapína ju --occupancy, pri resume pokračuje, ak ju súbor nesie.
+    if (config->occupancy || S.occupancy) {
+        bool ok = false;
+        if (config->coordinator_addr[0])
+            printf("Error: --occupancy cannot be combined with --coordinator.\n");
+        else if (config->grid_file[0])
+            printf("Error: --occupancy cannot be combined with --grid-file.\n");
+        else if (config->resume_file[0] && !S.occupancy)
+            printf("Error: '%s' has no occupancy map to continue.\n", config->resume_file);
+        else
+            ok = S.occupancy != NULL || world_alloc_occupancy(&S);
+        if (!ok) {
+            free_world(&S);
+            if (ipc) {
+                ipc_close_shared(ipc);
+                ipc_unlink_shared(shm_name);
+            }
+            return 1;
+        }
+        printf("[Server] Occupancy map enabled.\n");
+    }
+
+    // Mriežky presuň do segmentu pyramídy: úroveň 0 sú priamo štatistiky sveta,
+    // vyššie úrovne sa aktualizujú inkrementálne zo simulačného vlákna.
+    Pyramid pyr;
+    if (!use_ipc) {
+        // bez IPC nie je komu publikovať
+    } else if (grids_mapped) {
+        // mriežky ostávajú v mmap; pyramída by ich skopírovala do zdieľanej pamäte
+        printf("[Server] Note: grids are memory-mapped, stats pyramid disabled.\n");
+    } else if (pyramid_create(pyr_name, S.world_size, &pyr) == 0) {
+        world_rebind(&S, pyr.grid);
+        pyramid_rebuild(&pyr);
+        pyr.hdr->walker_x = S.walker.x;
+        pyr.hdr->walker_y = S.walker.y;
+        S.pyr = &pyr;
+        safe_strcpy(ipc->pyramid_shm, pyr_name, sizeof(ipc->pyramid_shm));
+    } else {
+        printf("[Server] Warning: stats pyramid unavailable, clients see only %dx%d.\n",
+               IPC_MAX_WORLD, IPC_MAX_WORLD);
+    }
     
     // Synchronizuj celý stav do IPC naraz
     sync_obstacles_to_ipc(&S);
@@ -320,20 +524,78 @@ int server_run(const ServerConfig *config)
     pthread_mutex_init(&S.lock, NULL);
 
     // Priprav argumenty pre socket thread
-    SocketThreadArgs *sock_args = malloc(sizeof(SocketThreadArgs));
-    if (!sock_args) {
+    SocketThreadArgs *sock_args = use_ipc ? malloc(sizeof(SocketThreadArgs)) : NULL;
+    if (use_ipc && !sock_args) {
         printf("Chyba: nepodarilo sa alokovať pamäť pre socket thread.\n");
         free_world(&S);
+        if (S.pyr) {
+            pyramid_close(S.pyr);
+            pyramid_unlink(pyr_name);
+        }
         ipc_close_shared(ipc);
         ipc_unlink_shared(shm_name);
         return 1;
     }
-    sock_args->S = &S;
-    sock_args->sock_path = strdup(sock_path);
+    pthread_t sim, walk, sock_thr;
 
+    // Koordinátor nahrádza simulačné vlákno: replikácie počítajú pripojení workeri.
+    bool coordinator = config->coordinator_addr[0] != '\0';
+    CoordArgs coord_args = { .S = &S, .chunk_reps = config->chunk_reps };
+    safe_strcpy(coord_args.addr, config->coordinator_addr, sizeof(coord_args.addr));
+    void *(*sim_fn)(void *) = coordinator ? coordinator_thread : simulation_thread;
+    void *sim_arg = coordinator ? (void *)&coord_args : (void *)&S;
+    // Úpravy prekážok (OBSTACLE) prepočítavajú bunky lokálne; obsadenosť ani posunutý či viacnásobný
+    // cieľ by sa z vynulovaných buniek nedali opraviť.
+    S.allow_edits = use_ipc && !coordinator && !S.occupancy && S.ntargets <= 1 &&
+                    S.shift_x == 0 && S.shift_y == 0;
+    if (use_ipc) ipc->edits_allowed = S.allow_edits;
+    if (sock_args) {
+        sock_args->S = &S;
+        sock_args->daemon = NULL;
+        sock_args->sock_path = strdup(sock_path);
+        safe_strcpy(sock_args->shm_name, shm_name, sizeof(sock_args->shm_name));
+        sock_args->ready_fd = config->ready_fd;
+        pthread_create(&sock_thr, NULL, socket_thread, sock_args);
+    }
 
-    pthread_t sim, walk, sock_thr;
-    pthread_create(&sock_thr, NULL, socket_thread, sock_args);
+    if (headless) {
+        // Batch beh: začni hneď, bez animácie chodca a bez doznievania na konci.
+        struct timespec sim_start, sim_end;
+        clock_gettime(CLOCK_MONOTONIC, &sim_start);
+        sim_fn(sim_arg);
+        clock_gettime(CLOCK_MONOTONIC, &sim_end);
+        if (config->cache && S.current_rep >= S.replications) cache_store(&S);
+
+        if (sock_args) pthread_join(sock_thr, NULL);
+        pthread_mutex_destroy(&S.lock);
+
+        bool saved = false;
+        char result_path[512];
+        if (config->output_file[0] != '\0') {
+            TRACE_BEGIN(save_t0);
+            saved = save_simulation_results(&S, config->output_file);
+            TRACE_END(save_t0, "save_results", saved);
+            snprintf(result_path, sizeof(result_path), "%s/%s", SAVED_DIR, config->output_file);
+        }
+
+        struct timespec wall_end;
+        clock_gettime(CLOCK_MONOTONIC, &wall_end);
+        print_run_summary(summary_out ? summary_out : stderr, config, &S,
+                          elapsed_s(&sim_start, &sim_end), elapsed_s(&wall_start, &wall_end),
+                          saved ? result_path : NULL, cached_reps);
+        if (summary_out) fclose(summary_out);
+
+        free_world(&S);
+        if (S.pyr) {
+            pyramid_close(S.pyr);
+            pyramid_unlink(pyr_name);
+        }
+        if (ipc) {
+            ipc_close_shared(ipc);
+            ipc_unlink_shared(shm_name);
+        }
+        return (config->output_file[0] != '\0' && !saved) ? 1 : 0;
+    }
 
     // Čakaj na pripojenie klienta
     printf("[Server] Waiting for client to connect before starting simulation...\n");
@@ -346,7 +608,7 @@ int server_run(const ServerConfig *config)
     }
     printf("[Server] Client connected! Starting simulation...\n");
 
-    pthread_create(&sim, NULL, simulation_thread, &S);
+    pthread_create(&sim, NULL, sim_fn, sim_arg);
     pthread_create(&walk, NULL, walker_thread, &S);
 
     bool finished_noted = false;
@@ -377,19 +639,24 @@ int server_run(const ServerConfig *config)
 
     pthread_mutex_lock(&S.lock);
     S.finished = true;
-    sync_basic_to_ipc(&S);
+    sync_progress_to_ipc(&S);
     pthread_mutex_unlock(&S.lock);
+    S.walker_stop = 1;
 
     pthread_join(sim, NULL);
     pthread_join(walk, NULL);
     pthread_join(sock_thr, NULL);
+    if (config->cache && S.current_rep >= S.replications) cache_store(&S);
 
     pthread_mutex_destroy(&S.lock);
 
     // Ulož výsledky do súboru
     if (config->output_file[0] != '\0') {
         printf("[Server] Saving results to '%s'...\n", config->output_file);
-        if (save_simulation_results(&S, config->output_file)) {
+        TRACE_BEGIN(save_t0);
+        int saved = save_simulation_results(&S, config->output_file);
+        TRACE_END(save_t0, "save_results", saved);
+        if (saved) {
             printf("[Server] Results saved successfully.\n");
         } else {
             printf("[Server] Failed to save results.\n");
@@ -397,29 +664,14 @@ int server_run(const ServerConfig *config)
     }
 
     free_world(&S);
+    if (S.pyr) {
+        pyramid_close(S.pyr);
+        pyramid_unlink(pyr_name);
+    }
 
     ipc_close_shared(ipc);
     ipc_unlink_shared(shm_name);
-    
-    // Odstráň tento server zo zoznamu
-    FILE *list = fopen("/tmp/pos_server_list.txt", "r");
-    FILE *temp = fopen("/tmp/pos_server_list_temp.txt", "w");
-    if (list && temp) {
-        char line[256];
-        int line_pid;
-        while (fgets(line, sizeof(line), list)) {
-            if (sscanf(line, "PID=%d", &line_pid) == 1 && line_pid != pid) {
-                fputs(line, temp);
-            }
-        }
-        fclose(list);
-        fclose(temp);
-        remove("/tmp/pos_server_list.txt");
-        rename("/tmp/pos_server_list_temp.txt", "/tmp/pos_server_list.txt");
-    } else {
-        if (list) fclose(list);
-        if (temp) fclose(temp);
-    }
 
     return 0;
 }
+
@@ -14,9 +14,39 @@ typedef struct ServerConfig {
     char obstacles_file[256];
     char output_file[256];
     char resume_file[256];
+    int headless;          // 1 = bez čakania na klienta, bez animácie chodca
+    int headless_ipc;      // v headless móde aj tak vytvor shm/socket
+    char summary_format[8]; // "json" alebo "csv" (súhrn na stdout v headless móde)
+    int daemon;            // 1 = dlhožijúci démon s frontou úloh
+    int workers;           // počet pracovných vlákien démona (0 = počet CPU)
+    int submit_pid;        // > 0 = odošli úlohu démonovi s týmto PID
+    int priority;          // priorita odosielanej úlohy (vyššia = skôr)
+    int threads;           // -t: počet simulačných vlákien
+    int batch;             // --batch: koľko buniek si vlákno naraz vezme (0 = predvolené)
+    unsigned long long seed; // --seed: základ náhodných prúdov (0 = podľa času a PID)
+    int ready_fd;          // --ready-fd: po spustení socketu sem server zapíše "READY <pid>"
+    char coordinator_addr[128]; // --coordinator: replikácie počítajú workeri pripojení sem
+    char worker_addr[128];      // --worker: beží ako worker koordinátora na tejto adrese
+    int chunk_reps;             // --chunk-reps: replikácií v jednom pridelenom rozsahu
+    char sweep_file[256];       // --sweep: súbor s bodmi sweepu (pozri sweep.h)
+    char grid_file[256];        // --grid-file: mriežky v mmap súbore (živé výsledky, pokračovanie)
+    int hugepages;              // --hugepages: mriežky na veľkých stránkach (madvise / MAP_HUGETLB)
+    char cpus[256];             // --cpus: CPU pre simulačné vlákna, napr. "0-7,16-23"
+    int numa;                   // --numa: CPU pre simulačné vlákna zoradené po NUMA uzloch
+    int occupancy;              // --occupancy: zbieraj mapu návštev buniek (úspešné/neúspešné prechádzky)
+    int walker_interval_ms;     // --walker-interval: perióda krokov interaktívneho chodca (0 = predvolená)
+    long long walker_steps;     // --walker-steps: horizont chodca v krokoch (0 = do konca behu servera)
+    char generate[128];         // --generate: procedurálny svet namiesto obstacles.txt (pozri worldgen.h)
+    char export_map[256];       // --export-map: len ulož vygenerovaný svet do saved/ a skonči
+    char prob_field[256];       // --prob-field: pravdepodobnosti pohybu po bunkách (pozri probfield.h)
+    char targets[256];          // --target: cieľové bunky/obdĺžniky namiesto stredu (pozri target.h)
+    int cache;                  // --cache: výsledky z/do saved/cache/ podľa hashu konfigurácie (pozri cache.h)
+    int autotune;               // --autotune: vlákna a blok z kalibrácie pri štarte (pozri autotune.h)
 } ServerConfig;
 
 // Spustí server so zadanou konfiguráciou.
 int server_run(const ServerConfig *config);
+// Zoznam CPU pre simulačné vlákna podľa --cpus / --numa. Vráti počet (0 = nepripínať) alebo -1.
+int server_cpu_plan(const ServerConfig *config, int *cpus, int max);
 
 #endif // SERVER_H
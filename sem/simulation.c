@@ -1,15 +1,22 @@
 #define _POSIX_C_SOURCE 200809L
 #define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <time.h>
 #include "simulation.h"
 #include "walker.h"
 #include "ipc.h"
+#include "pyramid.h"
+#include "trace.h"
+#include "world.h"
+#include "affinity.h"
 
 // Simulačné vlákna: výpočet štatistík a priebežný pohyb chodca do IPC.
 // Konštanty pre timeouty
-#define WALKER_UPDATE_INTERVAL_MS 300
-#define WALKER_SLEEP_INTERVAL_US 1000
+#define WALKER_SLEEP_SLICE_NS 50000000ull
 
 // Orezáva world_size na maximum, ktoré vie IPC niesť.
 static int clamp_world_size(const SharedState *S)
@@ -18,10 +25,35 @@ static int clamp_world_size(const SharedState *S)
     return (S->world_size < IPC_MAX_WORLD) ? S->world_size : IPC_MAX_WORLD;
 }
 
+// Označí novú publikáciu stavu v IPC (verzia + čas publikácie).
+static void ipc_publish(SharedState *S)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    S->ipc->publish_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    S->ipc->version++;
+}
+
+// Skopíruje výrez mapy obsadenosti (n x n) do zdieľanej pamäte.
+static void copy_occupancy_to_ipc(SharedState *S, int n)
+{
+    S->ipc->has_occupancy = S->occupancy ? 1 : 0;
+    if (!S->occupancy) return;
+    size_t cells = (size_t)S->world_size * S->world_size;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            size_t c = (size_t)y * S->world_size + x;
+            S->ipc->occupancy[0][y][x] = S->occupancy[c];
+            S->ipc->occupancy[1][y][x] = S->occupancy[cells + c];
+        }
+    }
+}
+
 // Skopíruje sumárne štatistiky (kroky/úspechy) do zdieľanej pamäte.
 static void copy_summary_to_ipc(SharedState *S)
 {
     if (!S || !S->ipc) return;
+    TRACE_BEGIN(t0);
     int n = clamp_world_size(S);
     for (int y = 0; y < n; y++) {
         for (int x = 0; x < n; x++) {
@@ -29,12 +61,15 @@ static void copy_summary_to_ipc(SharedState *S)
             S->ipc->success_count[y][x] = S->success_count[y][x];
         }
     }
+    copy_occupancy_to_ipc(S, n);
+    TRACE_END(t0, "copy_summary_to_ipc", n);
 }
 
 // Zapíše metadáta priebehu do zdieľanej pamäte (replikácie, mód, finished).
-static void sync_progress_to_ipc(SharedState *S)
+void sync_progress_to_ipc(SharedState *S)
 {
     if (!S || !S->ipc) return;
+    TRACE_BEGIN(t0);
     int n = clamp_world_size(S);
     S->ipc->world_size = n;
     S->ipc->mode = S->mode;
@@ -42,12 +77,97 @@ static void sync_progress_to_ipc(SharedState *S)
     S->ipc->current_rep = S->current_rep;
     S->ipc->replications = S->replications;
     S->ipc->finished = S->finished ? 1 : 0;
+    S->ipc->steps_done = S->steps_done;
+    S->ipc->stale_cells = S->stale_cells;
+    ipc_publish(S);
+    TRACE_END(t0, "sync_progress_to_ipc", n);
+}
+
+// Zapíše základné informácie do IPC (bez veľkých polí) vrátane štartu chodca; ďalšie
+// pozície publikuje už len vlákno chodca.
+void sync_basic_to_ipc(SharedState *S)
+{
+    if (!S || !S->ipc) return;
+    TRACE_BEGIN(t0);
+    int n = clamp_world_size(S);
+
+    int wx = S->walker.x;
+    int wy = S->walker.y;
+    if (wx >= n) wx %= n;
+    if (wy >= n) wy %= n;
+
+    S->ipc->world_size   = n;
+    S->ipc->walker_x     = wx;
+    S->ipc->walker_y     = wy;
+    S->ipc->mode         = S->mode;
+    S->ipc->summary_view = S->summary_view;
+    S->ipc->current_rep  = S->current_rep;
+    S->ipc->replications = S->replications;
+    S->ipc->finished     = S->finished ? 1 : 0;
+    ipc_publish(S);
+    TRACE_END(t0, "sync_basic_to_ipc", n);
+}
+
+// Prekážky kopíruj len zriedka (na začiatku alebo pri zmene).
+void sync_obstacles_to_ipc(SharedState *S)
+{
+    if (!S || !S->ipc) return;
+    TRACE_BEGIN(t0);
+    int n = clamp_world_size(S);
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            S->ipc->obstacles[y][x] = S->obstacles[y][x];
+            S->ipc->target[y][x] = S->target_map && S->target_map[(size_t)y * S->world_size + x];
+            S->ipc->stale[y][x] = S->stale && S->stale[(size_t)y * S->world_size + x];
+        }
+    }
+    // Cieľ bez mapy (posun na toruse) je jediná bunka.
+    S->ipc->has_targets = S->ntargets > 0;
+    if (S->ntargets > 0 && !S->target_map && S->targets[0].x0 < n && S->targets[0].y0 < n)
+        S->ipc->target[S->targets[0].y0][S->targets[0].x0] = 1;
+    TRACE_END(t0, "sync_obstacles_to_ipc", n);
+}
+
+// Štatistiky sa kopírujú z vlákna simulácie podľa potreby.
+void sync_stats_to_ipc(SharedState *S)
+{
+    if (!S || !S->ipc) return;
+    TRACE_BEGIN(t0);
+    int n = clamp_world_size(S);
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            S->ipc->total_steps[y][x]   = S->total_steps[y][x];
+            S->ipc->success_count[y][x] = S->success_count[y][x];
+        }
+    }
+    copy_occupancy_to_ipc(S, n);
+    TRACE_END(t0, "sync_stats_to_ipc", n);
 }
 
 // Simuluje náhodnú prechádzku z daného bodu a vráti počet krokov alebo -1.
-static int simulate_from(SharedState *S, Walker start)
+// Ak trail != NULL, zapíše doň po každom kroku index bunky, v ktorej chodec stojí.
+// Ak hit != NULL, zapíše doň index zasiahnutého cieľa (bez mapy cieľov 0).
+static inline int walk_from(SharedState *S, Walker start, WalkRng *rng, int *trail, int *hit)
 {
     Walker w = start;
+    const unsigned char *map = S->target_map;
+    if (map) {
+        int n = S->world_size;
+        int t = map[start.y * n + start.x];
+        for (int step = 1; t == 0 && step <= S->max_steps; step++) {
+            random_walk(S, &w, rng);
+            if (trail) trail[step - 1] = w.y * n + w.x;
+            t = map[w.y * n + w.x];
+            if (t) {
+                if (hit) *hit = t - 1;
+                return step;
+            }
+        }
+        if (t && hit) *hit = t - 1;  // štart priamo v cieli
+        return t ? 0 : -1;
+    }
+
+    if (hit) *hit = 0;
     int center_x = S->world_size / 2;
     int center_y = S->world_size / 2;
 
@@ -57,8 +177,9 @@ static int simulate_from(SharedState *S, Walker start)
 
     // Simuluj kroky
     for (int step = 1; step <= S->max_steps; step++) {
-        random_walk(S, &w);  // Vykonaj krok
-        
+        random_walk(S, &w, rng);  // Vykonaj krok
+        if (trail) trail[step - 1] = w.y * S->world_size + w.x;
+
         // Skontroluj, či walker dosiahol stred
         if (w.x == center_x && w.y == center_y)
             return step;  // Úspech! Vráti počet krokov
@@ -67,41 +188,658 @@ static int simulate_from(SharedState *S, Walker start)
     return -1;  // Neúspech - walker nedosiahol stred za max_steps
 }
 
+int simulate_from(SharedState *S, Walker start, WalkRng *rng)
+{
+    return walk_from(S, start, rng, NULL, NULL);
+}
+
+#define METRICS_INTERVAL_NS 100000000ull  // ako často vlákno 0 zbiera metriky
+#define METRICS_WINDOW_SAMPLES 640          // > 60 s histórie pri 100 ms
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Počítadlá jedného simulačného vlákna: píše len vlastník, vzorkovač ich číta bez zámku.
+typedef struct SimCounters {
+    _Alignas(64) atomic_llong steps;
+    atomic_llong walks;
+    atomic_llong successes;
+    atomic_llong lock_wait_ns;
+} SimCounters;
+
+static inline void counter_add(atomic_llong *c, long long v)
+{
+    // Jediný zapisovateľ: stačí relaxed load + store (bez zamknutej inštrukcie).
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + v, memory_order_relaxed);
+}
+
+// História súčtov pre kĺzavé okná (vedie ju len vlákno 0).
+typedef struct MetricsWindow {
+    uint64_t t[METRICS_WINDOW_SAMPLES];
+    long long steps[METRICS_WINDOW_SAMPLES];
+    long long walks[METRICS_WINDOW_SAMPLES];
+    int head;                 // index najnovšej vzorky
+    int count;
+    uint64_t start_ns;
+    uint64_t last_ns;
+    long long publish_time_ns;
+    long long walks_target;   // prechádzok, ktoré má tento beh urobiť
+} MetricsWindow;
+
+// Spoločný stav simulačných vlákien jedného behu.
+typedef struct SimPool {
+    SharedState *S;
+    pthread_barrier_t barrier;  // začiatok a koniec každej replikácie
+    pthread_mutex_t start_lock; // pomocné vlákna čakajú, kým sa bariéra nastaví na spustený počet
+    atomic_int next_cell;       // prvá ešte nepridelená bunka aktuálnej replikácie
+    atomic_int next_tid;        // pridelenie indexov pomocným vláknam
+    int rep;                    // aktuálna replikácia
+    int *catchup;               // bunky na prepočet po úprave prekážok (apply_edits)
+    int ncatchup;
+    int catchup_reps;           // koľko už hotových replikácií sa pre ne simuluje znova
+    atomic_int next_catchup;    // prvá ešte nepridelená bunka prepočtu
+    int batch;
+    int threads;
+    bool stop;
+    SimCounters *counters;      // jedno na vlákno
+    MetricsWindow win;
+} SimPool;
+
+// Súkromné buffre simulačného vlákna (alokuje ich vlákno samo, až po pripnutí).
+typedef struct SimScratch {
+    int *steps_buf;         // výsledky prechádzok bloku
+    int *hit_buf;           // zasiahnuté ciele prechádzok bloku (len s mapou cieľov)
+    int *trail;             // bunky aktuálnej prechádzky (len s mapou obsadenosti)
+    uint32_t *occ;          // lokálne biny obsadenosti v rozložení S->occupancy
+    long long occ_pending;  // návštevy v lokálnych binoch od posledného vyprázdnenia
+} SimScratch;
+
+// Vráti 0 alebo -1, ak sa nepodarilo alokovať.
+static int scratch_init(SimScratch *sc, const SharedState *S, int batch)
+{
+    memset(sc, 0, sizeof(*sc));
+    sc->steps_buf = malloc(batch * sizeof(int));
+    if (!sc->steps_buf) return -1;
+    if (S->target_map && !(sc->hit_buf = malloc(batch * sizeof(int)))) return -1;
+    if (!S->occupancy) return 0;
+    sc->trail = malloc((size_t)S->max_steps * sizeof(int));
+    sc->occ = calloc(2 * (size_t)S->world_size * S->world_size, sizeof(uint32_t));
+    return (sc->trail && sc->occ) ? 0 : -1;
+}
+
+static void scratch_free(SimScratch *sc)
+{
+    free(sc->steps_buf);
+    free(sc->hit_buf);
+    free(sc->trail);
+    free(sc->occ);
+}
+
+// Pripočíta lokálne biny do S->occupancy pod jedným zamknutím a vynuluje ich.
+static void occupancy_flush(SharedState *S, SimScratch *sc)
+{
+    if (!sc->occ || sc->occ_pending == 0) return;
+    TRACE_BEGIN(t0);
+    int n = S->world_size;
+    size_t cells = (size_t)n * n;
+    size_t total = 2 * cells;
+    pthread_mutex_lock(&S->lock);
+    if (S->shift_x == 0 && S->shift_y == 0) {
+        for (size_t c = 0; c < total; c++) S->occupancy[c] += sc->occ[c];
+    } else {
+        // Posunutý cieľ: biny sú v súradniciach prechádzky do stredu.
+        for (size_t h = 0; h < total; h += cells)
+            for (int y = 0; y < n; y++) {
+                long long *dst = S->occupancy + h + (size_t)((y + S->shift_y) % n) * n;
+                const uint32_t *src = sc->occ + h + (size_t)y * n;
+                for (int x = 0; x < n; x++) dst[(x + S->shift_x) % n] += src[x];
+            }
+    }
+    pthread_mutex_unlock(&S->lock);
+    memset(sc->occ, 0, total * sizeof(uint32_t));
+    sc->occ_pending = 0;
+    TRACE_END(t0, "occupancy_flush", (long long)total);
+}
+
+// Rýchlosť za posledných window_ns podľa histórie (values = steps alebo walks).
+static double window_rate(const MetricsWindow *w, const long long *values, uint64_t window_ns)
+{
+    if (w->count < 2) return 0.0;
+    int newest = w->head;
+    int idx = newest;
+    for (int i = 1; i < w->count; i++) {
+        int prev = (newest - i + METRICS_WINDOW_SAMPLES) % METRICS_WINDOW_SAMPLES;
+        idx = prev;
+        if (w->t[newest] - w->t[prev] >= window_ns) break;
+    }
+    uint64_t dt = w->t[newest] - w->t[idx];
+    return dt > 0 ? (values[newest] - values[idx]) * 1e9 / dt : 0.0;
+}
+
+// Zozbiera počítadlá vlákien, prepočíta okná a ETA a zverejní ich v S->metrics aj v IPC.
+static void metrics_sample(SimPool *P, bool force)
+{
+    MetricsWindow *w = &P->win;
+    uint64_t now = now_ns();
+    if (!force && now - w->last_ns < METRICS_INTERVAL_NS) return;
+    w->last_ns = now;
+
+    IPCMetrics m;
+    memset(&m, 0, sizeof(m));
+    m.threads = P->threads;
+    for (int i = 0; i < P->threads; i++) {
+        long long steps = atomic_load_explicit(&P->counters[i].steps, memory_order_relaxed);
+        long long wait = atomic_load_explicit(&P->counters[i].lock_wait_ns, memory_order_relaxed);
+        m.steps += steps;
+        m.walks += atomic_load_explicit(&P->counters[i].walks, memory_order_relaxed);
+        m.successes += atomic_load_explicit(&P->counters[i].successes, memory_order_relaxed);
+        m.lock_wait_ns += wait;
+        if (i < IPC_METRICS_THREADS) {
+            m.thread_steps[i] = steps;
+            m.thread_lock_wait_ns[i] = wait;
+        }
+    }
+
+    w->head = (w->head + 1) % METRICS_WINDOW_SAMPLES;
+    w->t[w->head] = now;
+    w->steps[w->head] = m.steps;
+    w->walks[w->head] = m.walks;
+    if (w->count < METRICS_WINDOW_SAMPLES) w->count++;
+
+    m.publish_time_ns = w->publish_time_ns;
+    m.elapsed_ns = (long long)(now - w->start_ns);
+    m.rate_1s = window_rate(w, w->steps, 1000000000ull);
+    m.rate_10s = window_rate(w, w->steps, 10000000000ull);
+    m.rate_60s = window_rate(w, w->steps, 60000000000ull);
+    double walk_rate = window_rate(w, w->walks, 10000000000ull);
+    long long remaining = w->walks_target - m.walks;
+    if (remaining <= 0) m.eta_s = 0.0;
+    else m.eta_s = walk_rate > 0 ? remaining / walk_rate : -1.0;
+
+    SharedState *S = P->S;
+    pthread_mutex_lock(&S->lock);
+    S->metrics = m;
+    if (S->ipc) S->ipc->metrics = m;
+    pthread_mutex_unlock(&S->lock);
+}
+
+// Bunka, z ktorej sa prechádzka naozaj simuluje: na toruse s posunutým cieľom bunka posunutá
+// o (-shift_x, -shift_y) s cieľom v strede (aj jej prúd náhodných čísel).
+static inline int walk_cell(const SharedState *S, int cell)
+{
+    if (S->shift_x == 0 && S->shift_y == 0) return cell;
+    int n = S->world_size;
+    int x = (cell % n - S->shift_x + n) % n;
+    int y = (cell / n - S->shift_y + n) % n;
+    return y * n + x;
+}
+
+// Odsimuluje blok buniek a výsledky zapíše naraz pod jedným zamknutím.
+static void run_chunk(SimPool *P, int tid, int first, int count, SimScratch *sc)
+{
+    SharedState *S = P->S;
+    SimCounters *ctr = &P->counters[tid];
+    int n = S->world_size;
+    int *steps_buf = sc->steps_buf;
+    int *hit_buf = sc->hit_buf;
+    TRACE_BEGIN(chunk_t0);
+
+    if (sc->occ) {
+        // Lokálne biny sú 32-bitové: vyprázdni ich skôr, ako by blok mohol niektorý pretiecť.
+        if (sc->occ_pending + (long long)count * S->max_steps > UINT32_MAX)
+            occupancy_flush(S, sc);
+        uint32_t *fail_bins = sc->occ + (size_t)n * n;
+        for (int i = 0; i < count; i++) {
+            int cell = walk_cell(S, first + i);
+            WalkRng rng;
+            walk_rng_seed(&rng, S->seed, (uint64_t)P->rep, (uint64_t)cell);
+            Walker start = { cell % n, cell / n };
+            int steps = walk_from(S, start, &rng, sc->trail, hit_buf ? &hit_buf[i] : NULL);
+            steps_buf[i] = steps;
+            // Výsledok prechádzky je známy až na konci, preto sa stopa roztriedi až teraz.
+            uint32_t *bins = (steps == -1) ? fail_bins : sc->occ;
+            int len = (steps == -1) ? S->max_steps : steps;
+            for (int k = 0; k < len; k++) bins[sc->trail[k]]++;
+            sc->occ_pending += len;
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            int cell = walk_cell(S, first + i);
+            WalkRng rng;
+            walk_rng_seed(&rng, S->seed, (uint64_t)P->rep, (uint64_t)cell);
+            Walker start = { cell % n, cell / n };
+            steps_buf[i] = walk_from(S, start, &rng, NULL, hit_buf ? &hit_buf[i] : NULL);
+        }
+    }
+
+    long long steps_sum = 0, successes = 0;
+    uint64_t t0 = now_ns();
+    pthread_mutex_lock(&S->lock);
+    uint64_t waited = now_ns() - t0;
+    TRACE_END(t0, "stats_lock_wait", first);
+    for (int i = 0; i < count; i++) {
+        int x = (first + i) % n;
+        int y = (first + i) / n;
+        int steps = steps_buf[i];
+        steps_sum += (steps == -1) ? S->max_steps : steps;
+        if (steps != -1) {
+            successes++;
+            S->success_count[y][x]++;
+            S->total_steps[y][x] += steps;
+            if (S->pyr) pyramid_add(S->pyr, x, y, steps);
+            if (hit_buf) S->target_hits[hit_buf[i]]++;
+        }
+    }
+    if (!hit_buf && S->target_hits) S->target_hits[0] += successes;
+    S->walks_done += count;
+    S->steps_done += steps_sum;
+    if (S->pyr) S->pyr->hdr->version++;
+    pthread_mutex_unlock(&S->lock);
+    TRACE_END(chunk_t0, "chunk", first);
+
+    counter_add(&ctr->steps, steps_sum);
+    counter_add(&ctr->walks, count);
+    counter_add(&ctr->successes, successes);
+    counter_add(&ctr->lock_wait_ns, (long long)waited);
+    if (tid == 0) metrics_sample(P, false);
+}
+
+// Prepočet bunky po úprave prekážok: hotové replikácie sa odsimulujú znova s tými istými prúdmi
+// náhodných čísel, takže bunka skončí s rovnakým výsledkom ako beh s novou mapou od začiatku.
+static void run_catchup(SimPool *P, int tid, int cell)
+{
+    SharedState *S = P->S;
+    SimCounters *ctr = &P->counters[tid];
+    int n = S->world_size;
+    int x = cell % n;
+    int y = cell / n;
+    Walker start = { x, y };
+    long long steps_sum = 0, total = 0, successes = 0;
+    int r;
+    TRACE_BEGIN(t0);
+    for (r = 0; r < P->catchup_reps && !S->cancel; r++) {
+        WalkRng rng;
+        walk_rng_seed(&rng, S->seed, (uint64_t)r, (uint64_t)cell);
+        int steps = walk_from(S, start, &rng, NULL, NULL);
+        steps_sum += (steps == -1) ? S->max_steps : steps;
+        if (steps != -1) {
+            successes++;
+            total += steps;
+        }
+    }
+    if (r < P->catchup_reps) return;  // zrušené: bunka ostáva neplatná
+
+    pthread_mutex_lock(&S->lock);
+    S->success_count[y][x] += (int)successes;
+    S->total_steps[y][x] += (int)total;
+    if (S->pyr) {
+        pyramid_add_many(S->pyr, x, y, total, successes);
+        pyramid_set_stale(S->pyr, x, y, false);
+        S->pyr->hdr->version++;
+    }
+    if (S->target_hits) S->target_hits[0] += successes;
+    S->stale[cell] = 0;
+    S->stale_cells--;
+    if (S->ipc) {
+        if (x < IPC_MAX_WORLD && y < IPC_MAX_WORLD) S->ipc->stale[y][x] = 0;
+        S->ipc->stale_cells = S->stale_cells;
+    }
+    S->walks_done += r;
+    S->steps_done += steps_sum;
+    pthread_mutex_unlock(&S->lock);
+    TRACE_END(t0, "catchup", cell);
+
+    counter_add(&ctr->steps, steps_sum);
+    counter_add(&ctr->walks, r);
+    counter_add(&ctr->successes, successes);
+    if (tid == 0) metrics_sample(P, false);
+}
+
+// Berie najprv bunky prepočtu po úprave prekážok, potom bloky buniek aktuálnej replikácie,
+// kým nejaké zostávajú (dynamické plánovanie).
+// Na konci replikácie vyprázdni lokálne biny obsadenosti, aby ich zverejnenie bolo úplné.
+static void work_replication(SimPool *P, int tid, SimScratch *sc)
+{
+    SharedState *S = P->S;
+    int total = S->world_size * S->world_size;
+    while (!S->cancel) {
+        int i = atomic_fetch_add(&P->next_catchup, 1);
+        if (i >= P->ncatchup) break;
+        run_catchup(P, tid, P->catchup[i]);
+    }
+    while (!S->cancel) {
+        int first = atomic_fetch_add(&P->next_cell, P->batch);
+        if (first >= total) break;
+        int count = (total - first < P->batch) ? total - first : P->batch;
+        run_chunk(P, tid, first, count, sc);
+    }
+    occupancy_flush(S, sc);
+}
+
+// Pomocné simulačné vlákno: čaká na začiatok replikácie, pracuje a hlási koniec.
+static void *sim_worker(void *arg)
+{
+    SimPool *P = arg;
+    int tid = atomic_fetch_add(&P->next_tid, 1);
+    TRACE_THREAD("sim-worker");
+    // Najprv pripni, až potom alokuj: súkromný buffer sa prvým zápisom umiestni do uzla vlákna.
+    if (P->S->ncpus > 0) affinity_pin_self(P->S->cpus[tid % P->S->ncpus]);
+    SimScratch sc;
+    bool ok = scratch_init(&sc, P->S, P->batch) == 0;
+    pthread_mutex_lock(&P->start_lock);
+    pthread_mutex_unlock(&P->start_lock);
+    while (1) {
+        pthread_barrier_wait(&P->barrier);
+        if (P->stop) break;
+        if (ok) work_replication(P, tid, &sc);
+        pthread_barrier_wait(&P->barrier);
+    }
+    scratch_free(&sc);
+    return NULL;
+}
+
+const char *simulation_queue_edit(SharedState *S, int x, int y, int value)
+{
+    int n = S->world_size;
+    if (!S->allow_edits) return "editing disabled";
+    if (x < 0 || y < 0 || x >= n || y >= n || (value != 0 && value != 1)) return "bad cell";
+    if (S->target_map ? S->target_map[(size_t)y * n + x] != 0 : (x == n / 2 && y == n / 2))
+        return "target cell";
+    const char *err = NULL;
+    pthread_mutex_lock(&S->lock);
+    if (S->finished || S->current_rep >= S->replications) err = "finished";
+    else if (S->nedits >= EDIT_QUEUE_MAX) err = "queue full";
+    else S->edits[S->nedits++] = (ObstacleEdit){ x, y, value };
+    pthread_mutex_unlock(&S->lock);
+    return err;
+}
+
+// Na hranici replikácie (pomocné vlákna čakajú na bariére) aplikuje čakajúce úpravy prekážok.
+// Prechádzka zo štartu s sa upravenej bunky e dotkne len vtedy, ak sa k nej dostane za najviac
+// max_steps krokov, preto sa neplatné bunky nájdu ohraničeným BFS od upravených buniek
+// (cez bunky voľné v starej alebo novej mape, nie cez ciele). Tie sa vynulujú a v ďalšej fáze
+// prepočítajú za reps_done hotových replikácií (run_catchup). Vráti počet buniek na prepočet.
+static int apply_edits(SimPool *P, int reps_done)
+{
+    SharedState *S = P->S;
+    ObstacleEdit edits[EDIT_QUEUE_MAX];
+    pthread_mutex_lock(&S->lock);
+    int count = S->nedits;
+    memcpy(edits, S->edits, count * sizeof(ObstacleEdit));
+    S->nedits = 0;
+    pthread_mutex_unlock(&S->lock);
+    if (count == 0) return 0;
+
+    int n = S->world_size;
+    size_t cells = (size_t)n * n;
+    free(P->catchup);
+    P->catchup = NULL;
+    P->ncatchup = 0;
+    int *dist = malloc(cells * sizeof(int));
+    int *queue = malloc(cells * sizeof(int));
+    if (!S->stale) S->stale = calloc(cells, 1);
+    if (!dist || !queue || !S->stale) {
+        printf("Error: Could not allocate memory for obstacle edits, %d edit(s) dropped.\n", count);
+        free(dist);
+        free(queue);
+        return 0;
+    }
+    memset(dist, -1, cells * sizeof(int));
+
+    // Prekážky číta aj vlákno chodca bez zámku; zmena jednej bunky preň nie je nebezpečná.
+    int head = 0, tail = 0;
+    pthread_mutex_lock(&S->lock);
+    for (int i = 0; i < count; i++) {
+        int c = edits[i].y * n + edits[i].x;
+        if (S->obstacles[edits[i].y][edits[i].x] == edits[i].value) continue;
+        S->obstacles[edits[i].y][edits[i].x] = edits[i].value;
+        if (dist[c] < 0) {
+            dist[c] = 0;
+            queue[tail++] = c;
+        }
+    }
+    pthread_mutex_unlock(&S->lock);
+    int changed = tail;
+
+    static const int dx[4] = { 0, 0, -1, 1 };
+    static const int dy[4] = { -1, 1, 0, 0 };
+    int center = (n / 2) * n + n / 2;
+    while (head < tail) {
+        int c = queue[head++];
+        int x = c % n;
+        int y = c / n;
+        bool absorbing = S->target_map ? S->target_map[c] != 0 : c == center;
+        // Ďalej sa ide len cez bunky, do ktorých chodec vojde a pokračuje (upravené majú dist 0).
+        if (dist[c] >= S->max_steps || absorbing || (dist[c] > 0 && S->obstacles[y][x])) continue;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d];
+            int ny = y + dy[d];
+            if (S->use_obstacles) {
+                if (nx < 0 || ny < 0 || nx >= n || ny >= n) continue;
+            } else {
+                nx = (nx + n) % n;
+                ny = (ny + n) % n;
+            }
+            int nc = ny * n + nx;
+            if (dist[nc] < 0) {
+                dist[nc] = dist[c] + 1;
+                queue[tail++] = nc;
+            }
+        }
+    }
+    free(dist);
+
+    pthread_mutex_lock(&S->lock);
+    for (int i = 0; i < tail; i++) {
+        int x = queue[i] % n;
+        int y = queue[i] / n;
+        if (S->target_hits) S->target_hits[0] -= S->success_count[y][x];
+        S->success_count[y][x] = 0;
+        S->total_steps[y][x] = 0;
+        S->stale[queue[i]] = 1;
+        if (S->pyr) pyramid_set_stale(S->pyr, x, y, true);
+    }
+    S->stale_cells = tail;
+    if (S->pyr) pyramid_rebuild(S->pyr);  // zmenili sa aj voľné bunky blokov
+    sync_obstacles_to_ipc(S);
+    copy_summary_to_ipc(S);
+    sync_progress_to_ipc(S);
+    pthread_mutex_unlock(&S->lock);
+
+    P->catchup = queue;
+    P->ncatchup = tail;
+    P->catchup_reps = reps_done;
+    atomic_store(&P->next_catchup, 0);
+    P->win.walks_target += (long long)tail * reps_done;
+    if (changed > 0)
+        printf("[Server] Obstacles edited: %d cell(s) changed, %d cell(s) recomputed over %d replication(s).\n",
+               changed, tail, reps_done);
+    return tail;
+}
+
+// Kalibračný beh (--autotune): vlákna berú bloky buniek ako v replikácii a súčty zapisujú raz za blok
+// pod zámkom, ale len do vlastného počítadla. Prúdy replikácie CALIBRATION_REP riadny beh nepoužíva.
+#define CALIBRATION_REP (UINT64_MAX - 1)
+
+typedef struct BurstCtx {
+    SharedState *S;
+    pthread_mutex_t lock;
+    atomic_llong next;   // ďalšia nepridelená prechádzka
+    int batch;
+    uint64_t deadline;
+    long long steps;     // chránené lock
+} BurstCtx;
+
+static void *burst_worker(void *arg)
+{
+    BurstCtx *B = arg;
+    SharedState *S = B->S;
+    int n = S->world_size;
+    uint64_t total = (uint64_t)n * n;
+    int *steps_buf = malloc(B->batch * sizeof(int));
+    if (!steps_buf) return NULL;
+    bool done = false;
+    while (!done) {
+        long long first = atomic_fetch_add(&B->next, B->batch);
+        int count = 0;
+        for (; count < B->batch; count++) {
+            if (now_ns() >= B->deadline) {
+                done = true;
+                break;
+            }
+            // Rozptýlené štarty, aby aj krátky beh zasiahol celý svet, nie len horný okraj.
+            uint64_t walk = (uint64_t)(first + count);
+            int cell = (int)(walk * 2654435761u % total);
+            WalkRng rng;
+            walk_rng_seed(&rng, S->seed, CALIBRATION_REP, walk);
+            Walker start = { cell % n, cell / n };
+            steps_buf[count] = walk_from(S, start, &rng, NULL, NULL);
+        }
+        long long steps_sum = 0;
+        pthread_mutex_lock(&B->lock);
+        for (int i = 0; i < count; i++) steps_sum += (steps_buf[i] == -1) ? S->max_steps : steps_buf[i];
+        B->steps += steps_sum;
+        pthread_mutex_unlock(&B->lock);
+    }
+    free(steps_buf);
+    return NULL;
+}
+
+double simulation_burst(SharedState *S, int threads, int batch, int ms)
+{
+    BurstCtx B;
+    memset(&B, 0, sizeof(B));
+    B.S = S;
+    B.batch = batch > 0 ? batch : SIM_DEFAULT_BATCH;
+    pthread_mutex_init(&B.lock, NULL);
+    atomic_init(&B.next, 0);
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    if (!tids) {
+        pthread_mutex_destroy(&B.lock);
+        return -1.0;
+    }
+    uint64_t t0 = now_ns();
+    B.deadline = t0 + (uint64_t)ms * 1000000ull;
+    int started = 0;
+    for (; started < threads; started++)
+        if (pthread_create(&tids[started], NULL, burst_worker, &B) != 0) break;
+    for (int i = 0; i < started; i++) pthread_join(tids[i], NULL);
+    uint64_t elapsed = now_ns() - t0;
+    free(tids);
+    pthread_mutex_destroy(&B.lock);
+    if (started < threads) return -1.0;
+    return elapsed > 0 ? B.steps * 1e9 / elapsed : 0.0;
+}
+
 // Hlavné simulačné vlákno: prechádza všetky počiatočné pozície a akumuluje štatistiky.
+// Pri S->threads > 1 si bunky každej replikácie delí s pomocnými vláknami.
 void* simulation_thread(void *arg)
 {
     SharedState *S = arg;
 
+    TRACE_THREAD("simulation");
+    if (S->ncpus > 0) affinity_pin_self(S->cpus[0]);
+    SimPool *P = calloc(1, sizeof(SimPool));
+    int threads = (S->threads > 1) ? S->threads : 1;
+    int batch = (S->batch > 0) ? S->batch : SIM_DEFAULT_BATCH;
+    SimScratch sc;
+    bool scratch_ok = scratch_init(&sc, S, batch) == 0;
+    SimCounters *counters = aligned_alloc(_Alignof(SimCounters), threads * sizeof(SimCounters));
+    pthread_t *helpers = (threads > 1) ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    if (!P || !scratch_ok || !counters || (threads > 1 && !helpers)) {
+        printf("Chyba: nepodarilo sa alokovať pamäť pre simuláciu.\n");
+        free(P);
+        scratch_free(&sc);
+        free(counters);
+        free(helpers);
+        pthread_mutex_lock(&S->lock);
+        S->finished = true;
+        sync_progress_to_ipc(S);
+        pthread_mutex_unlock(&S->lock);
+        return NULL;
+    }
+    memset(counters, 0, threads * sizeof(SimCounters));
+    P->S = S;
+    P->batch = batch;
+    P->threads = threads;
+    P->counters = counters;
+    atomic_store(&P->next_tid, 1);
+
     // Pre resume: začni od current_rep (už vykonaných replikácií)
     int start_rep = S->current_rep;
+    P->win.start_ns = now_ns();
+    P->win.walks_target = (long long)(S->replications - start_rep) * S->world_size * S->world_size;
+    metrics_sample(P, true);
+
+    // Bariéra sa nastaví až na počet vlákien, ktoré naozaj bežia (pthread_create môže zlyhať).
+    pthread_mutex_init(&P->start_lock, NULL);
+    pthread_mutex_lock(&P->start_lock);
+    int started = 0;
+    while (started < threads - 1 && pthread_create(&helpers[started], NULL, sim_worker, P) == 0)
+        started++;
+    if (started < threads - 1) {
+        printf("Warning: Could not start all simulation threads, running with %d.\n", started + 1);
+        threads = started + 1;
+        P->threads = threads;
+        pthread_mutex_lock(&S->lock);
+        S->threads = threads;
+        pthread_mutex_unlock(&S->lock);
+    }
+    pthread_barrier_init(&P->barrier, NULL, threads);
+    pthread_mutex_unlock(&P->start_lock);
     
-    for (int r = start_rep; r < S->replications; r++) {
+    for (int r = start_rep; r < S->replications && !S->cancel; r++) {
+        P->rep = r;
+        atomic_store(&P->next_cell, 0);
+        TRACE_BEGIN(rep_t0);
+        apply_edits(P, r);
 
-        for (int y = 0; y < S->world_size; y++) {
-            for (int x = 0; x < S->world_size; x++) {
+        pthread_barrier_wait(&P->barrier);
+        work_replication(P, 0, &sc);
+        pthread_barrier_wait(&P->barrier);
 
-                Walker start = { x, y };
-                int steps = simulate_from(S, start);
-
-                pthread_mutex_lock(&S->lock);
-
-                if (steps != -1) {
-                    S->success_count[y][x]++;
-                    S->total_steps[y][x] += steps;
-                }
-
-                pthread_mutex_unlock(&S->lock);
-            }
-        }
+        if (S->cancel) break; // nedokončenú replikáciu nezapočítame
 
         // Aktualizuj current_rep až PO dokončení celej replikácie
+        uint64_t t0 = now_ns();
         pthread_mutex_lock(&S->lock);
+        uint64_t t1 = now_ns();
         S->current_rep = r + 1;
+        if (S->grid_file) S->grid_file->reps_done = S->current_rep;
         copy_summary_to_ipc(S);
         sync_progress_to_ipc(S);
         pthread_mutex_unlock(&S->lock);
+        P->win.publish_time_ns += (long long)(now_ns() - t1);
+        counter_add(&counters[0].lock_wait_ns, (long long)(t1 - t0));
+        TRACE_END(rep_t0, "replication", r);
+    }
+
+    // Úpravy zaradené počas poslednej replikácie: už len prepočet, bez novej replikácie.
+    if (!S->cancel && S->current_rep >= S->replications &&
+        apply_edits(P, S->replications) > 0) {
+        atomic_store(&P->next_cell, S->world_size * S->world_size);
+        pthread_barrier_wait(&P->barrier);
+        work_replication(P, 0, &sc);
+        pthread_barrier_wait(&P->barrier);
     }
 
+    P->stop = true;
+    pthread_barrier_wait(&P->barrier);
+    for (int i = 0; i < threads - 1; i++)
+        pthread_join(helpers[i], NULL);
+    pthread_barrier_destroy(&P->barrier);
+    pthread_mutex_destroy(&P->start_lock);
+    metrics_sample(P, true);
+    free(helpers);
+    scratch_free(&sc);
+    free(counters);
+    free(P->catchup);
+    free(P);
+
     pthread_mutex_lock(&S->lock);
     S->finished = true;
     copy_summary_to_ipc(S);
@@ -111,72 +849,47 @@ void* simulation_thread(void *arg)
     return NULL;
 }
 
-// Vlákno, ktoré posúva chodca a synchronizuje jeho stav do IPC.
+// Interaktívny chodec: vlastný stav a vlastný horizont, bez S->lock. Každý krok zapíše
+// do stopy v IPC (jediný zapisovateľ) a do walker_x/y; klienti si stopu čítajú sami.
 void* walker_thread(void *arg)
 {
     SharedState *S = arg;
+    Walker w = S->walker;
+    int interval_ms = S->walker_interval_ms > 0 ? S->walker_interval_ms : WALKER_UPDATE_INTERVAL_MS;
+    int n = clamp_world_size(S);
 
-    int steps = 0;
-
-    int last_wx = -1;
-    int last_wy = -1;
-    int last_mode = -1;
-    int last_view = -1;
-
-    struct timespec last, now;
-    clock_gettime(CLOCK_MONOTONIC, &last);
-
-    while (1) {
-
-        pthread_mutex_lock(&S->lock);
-        bool finished = S->finished;
-        int max = S->max_steps;
-        pthread_mutex_unlock(&S->lock);
-
-        if (finished) return NULL;
-        if (steps >= max) return NULL;
-
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        long ms = (now.tv_sec - last.tv_sec)*1000 +
-                  (now.tv_nsec - last.tv_nsec)/1000000;
-
-        if (ms >= WALKER_UPDATE_INTERVAL_MS) {
-
-            pthread_mutex_lock(&S->lock);
-            random_walk(S, &S->walker);
-            if (S->ipc) {
-                int n = clamp_world_size(S);
-                int wx = S->walker.x;
-                int wy = S->walker.y;
-                int mode = S->mode;
-                int view = S->summary_view;
-                if (wx >= n) wx %= n;
-                if (wy >= n) wy %= n;
-
-                bool changed = (wx != last_wx) || (wy != last_wy) ||
-                               (mode != last_mode) || (view != last_view);
-
-                if (changed) {
-                    S->ipc->walker_x = wx;
-                    S->ipc->walker_y = wy;
-                    S->ipc->mode = mode;
-                    S->ipc->summary_view = view;
-                    S->ipc->finished = S->finished ? 1 : 0;
-                    S->ipc->world_size = n;
-
-                    last_wx = wx;
-                    last_wy = wy;
-                    last_mode = mode;
-                    last_view = view;
-                }
-            }
-            pthread_mutex_unlock(&S->lock);
-
-            last = now;
-            steps++;
+    // Animovaný chodec má vlastný prúd, oddelený od prúdov replikácií.
+    WalkRng rng;
+    walk_rng_seed(&rng, S->seed, UINT64_MAX, 0);
+    TRACE_THREAD("walker");
+    affinity_exclude_self(S->cpus, S->ncpus);
+    if (S->ipc) ipc_trail_push(S->ipc, w.x, w.y);
+
+    uint64_t next = now_ns();
+    for (long long steps = 0; S->walker_horizon <= 0 || steps < S->walker_horizon; steps++) {
+        next += (uint64_t)interval_ms * 1000000ull;
+        // Spí po kúskoch, aby ukončenie servera nečakalo na dlhú periódu.
+        uint64_t now;
+        while (!S->walker_stop && (now = now_ns()) < next) {
+            uint64_t left = next - now;
+            if (left > WALKER_SLEEP_SLICE_NS) left = WALKER_SLEEP_SLICE_NS;
+            struct timespec ts = { 0, (long)left };
+            nanosleep(&ts, NULL);
         }
+        if (S->walker_stop) break;
 
-        usleep(WALKER_SLEEP_INTERVAL_US);
+        TRACE_BEGIN(step_t0);
+        random_walk(S, &w, &rng);
+        if (S->pyr) {
+            S->pyr->hdr->walker_x = w.x;
+            S->pyr->hdr->walker_y = w.y;
+        }
+        if (S->ipc) {
+            ipc_trail_push(S->ipc, w.x, w.y);
+            S->ipc->walker_x = w.x % n;
+            S->ipc->walker_y = w.y % n;
+        }
+        TRACE_END(step_t0, "walker_step", steps);
     }
-}
\ No newline at end of file
+    return NULL;
+}
@@ -5,10 +5,13 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "walker.h"
+#include "ipc.h"
+#include "target.h"
 
 // Spoločný stav simulácie a rozhranie pre simulačné a vizualizačné vlákna.
-struct IPCShared;
+struct Pyramid;
 
 typedef struct {
     double up;
@@ -17,6 +20,14 @@ typedef struct {
     double right;
 } Probabilities;
 
+// Úprava prekážky zo socketu (OBSTACLE x y 0|1), čaká na hranicu replikácie.
+typedef struct ObstacleEdit {
+    int x, y;
+    int value;
+} ObstacleEdit;
+
+#define EDIT_QUEUE_MAX 256  // najviac čakajúcich úprav prekážok
+
 typedef struct SharedState {
 
     int world_size;
@@ -24,6 +35,8 @@ typedef struct SharedState {
     int max_steps;
 
     int current_rep;
+    long long walks_done;     // počet odsimulovaných prechádzok (tento beh)
+    long long steps_done;     // počet vykonaných krokov vrátane neúspešných prechádzok
 
     int **total_steps;
     int **success_count;
@@ -31,17 +44,50 @@ typedef struct SharedState {
     bool use_obstacles;
     int **obstacles;  // 1 = obstacle, 0 = free
 
-    Walker walker;
+    int *grid_block;     // súvislé úložisko všetkých troch mriežok
+    bool grid_external;  // blok nevlastníme (napr. leží v zdieľanej pamäti)
+    void *grid_map;      // mmap s mriežkami (world_map_grids) alebo NULL
+    size_t grid_map_size;
+    struct GridFileHeader *grid_file; // hlavička súboru s mriežkami (--grid-file) alebo NULL
+    long long *occupancy; // návštevy buniek (--occupancy): [0, n*n) úspešné, [n*n, 2*n*n) neúspešné prechádzky; NULL = nezbiera sa
+
+    Walker walker;            // štart interaktívneho chodca; ďalej si polohu drží jeho vlákno
+    int walker_interval_ms;   // perióda krokov chodca (0 = WALKER_UPDATE_INTERVAL_MS)
+    long long walker_horizon; // počet krokov chodca (0 = kým server nekončí)
+    volatile int walker_stop; // nenulové = vlákno chodca skončí
 
     int mode;   // 1 interactive / 2 summary
     int summary_view; // 0 average steps, 1 probability
     bool finished;
+    volatile int cancel;  // nenulové = démon úlohu zrušil, simulácia skončí po bloku buniek
 
     Probabilities prob;
+    double *prob_field;   // --prob-field: 4 * n*n pravdepodobností (up, down, left, right po bunkách) alebo NULL
+    uint32_t *prob_alias; // alias tabuľky poľa pre krok (probfield.h), 4 slová na bunku
+
+    TargetRect *targets;        // ciele (--target, pozri target.h), NULL = stred sveta
+    int ntargets;
+    unsigned char *target_map;  // n*n: 0 = nie je cieľ, i + 1 = cieľ i; NULL = cieľom je stred
+    int shift_x, shift_y;       // torus s jedným cieľom: bunka (x,y) sa simuluje zo (x - shift_x, y - shift_y)
+    long long *target_hits;     // úspešné prechádzky podľa cieľa (ntargets hodnôt)
+
+    bool allow_edits;                    // OBSTACLE je povolený (nastaví server pred štartom vlákien)
+    ObstacleEdit edits[EDIT_QUEUE_MAX];  // úpravy čakajúce na hranicu replikácie (chránené lock)
+    int nedits;
+    unsigned char *stale;   // n*n: 1 = bunka sa po úprave prekážok prepočítava; NULL = zatiaľ bez úprav
+    long long stale_cells;  // počet buniek s stale == 1
+
+    uint64_t seed;  // základ prúdov náhodných čísel (prechádzka = seed + replikácia + bunka)
+    int threads;    // počet simulačných vlákien (<= 1 = jedno)
+    int batch;      // počet buniek, ktoré si vlákno naraz vezme (0 = SIM_DEFAULT_BATCH)
+    const int *cpus; // CPU pre simulačné vlákna (vlákno i beží na cpus[i % ncpus]), NULL = bez pripnutia
+    int ncpus;
 
     pthread_mutex_t lock;
+    IPCMetrics metrics;   // posledná vzorka metrík behu (chránené lock)
 
     struct IPCShared *ipc;
+    struct Pyramid *pyr;   // pyramída štatistík v zdieľanej pamäti (alebo NULL)
 
     volatile int client_connected; // 0 = waiting, 1 = client connected
     
@@ -49,7 +95,26 @@ typedef struct SharedState {
 
 } SharedState;
 
+#define SIM_DEFAULT_BATCH 64
+#define WALKER_UPDATE_INTERVAL_MS 300  // predvolená perióda krokov interaktívneho chodca
+// Mapa obsadenosti drží na každom vlákne lokálne biny pre celý svet, preto je obmedzená.
+#define OCCUPANCY_MAX_WORLD 1024
+
+// Jedna prechádzka zo štartu do stredu; vráti počet krokov alebo -1 (nedošiel za max_steps).
+int simulate_from(SharedState *S, Walker start, WalkRng *rng);
 void* simulation_thread(void *arg);
+// Kalibračný beh skutočnej záťaže na ms milisekúnd s threads vláknami a blokom batch; štatistiky
+// sveta nemení. Vráti kroky za sekundu alebo -1 (nepodarilo sa spustiť vlákna).
+double simulation_burst(SharedState *S, int threads, int batch, int ms);
+// Zaradí úpravu prekážky na najbližšiu hranicu replikácie; dotknuté bunky sa potom prepočítajú
+// s pôvodnými prúdmi náhodných čísel. Vráti NULL alebo dôvod odmietnutia.
+const char *simulation_queue_edit(SharedState *S, int x, int y, int value);
+
+// Publikovanie stavu do zdieľanej pamäte (volajúci drží S->lock, ak bežia vlákna).
+void sync_basic_to_ipc(SharedState *S);
+void sync_progress_to_ipc(SharedState *S);
+void sync_obstacles_to_ipc(SharedState *S);
+void sync_stats_to_ipc(SharedState *S);
 void* walker_thread(void *arg);
 
 #endif
\ No newline at end of file
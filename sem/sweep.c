@@ -0,0 +1,259 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "sweep.h"
+#include "simulation.h"
+#include "walker.h"
+#include "world.h"
+#include "affinity.h"
+#include "worldgen.h"
+#include "probfield.h"
+#include "target.h"
+
+// Sweep parametrov s rovnakými náhodnými prúdmi pre všetky body.
+
+typedef struct SweepGrid {
+    Probabilities probs[SWEEP_MAX_PROBS];
+    int nprobs;
+    int steps[SWEEP_MAX_STEPS];
+    int nsteps;
+} SweepGrid;
+
+// Načíta osi sweepu zo súboru. Vráti 0 alebo -1 pri chybe.
+static int load_sweep_file(const char *path, SweepGrid *g)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("Error: Could not open sweep file '%s'.\n", path);
+        return -1;
+    }
+
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        for (char *c = line; *c; c++)
+            if (*c == ',') *c = ' ';  // "0.25,0.25,..." aj "0.25 0.25 ..."
+        char key[16];
+        int used = 0;
+        if (sscanf(line, "%15s%n", key, &used) != 1 || key[0] == '#') continue;
+
+        if (strcmp(key, "prob") == 0) {
+            Probabilities p;
+            if (sscanf(line + used, "%lf %lf %lf %lf", &p.up, &p.down, &p.left, &p.right) != 4 ||
+                g->nprobs == SWEEP_MAX_PROBS) {
+                printf("Error: %s:%d: expected 'prob <up> <down> <left> <right>'.\n", path, lineno);
+                fclose(f);
+                return -1;
+            }
+            g->probs[g->nprobs++] = p;
+        } else if (strcmp(key, "steps") == 0) {
+            char *p = line + used;
+            int value, n;
+            while (sscanf(p, "%d%n", &value, &n) == 1) {
+                if (value <= 0 || g->nsteps == SWEEP_MAX_STEPS) {
+                    printf("Error: %s:%d: invalid or too many step values.\n", path, lineno);
+                    fclose(f);
+                    return -1;
+                }
+                g->steps[g->nsteps++] = value;
+                p += n;
+            }
+        } else {
+            printf("Error: %s:%d: unknown key '%s'.\n", path, lineno, key);
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+// Pripraví spoločný svet (veľkosť a prekážky) pre všetky body sweepu.
+static int setup_world(const ServerConfig *config, SharedState *S)
+{
+    WorldGenSpec gen;
+    if (config->generate[0] != '\0') {
+        if (worldgen_parse(config->generate, &gen) != 0) return -1;
+        S->world_size = gen.size;
+        S->use_obstacles = true;
+    } else if (config->obstacles_file[0] != '\0') {
+        S->world_size = get_world_size_from_obstacles(config->obstacles_file);
+        if (S->world_size <= 0) {
+            printf("Error: Could not read obstacles file '%s'.\n", config->obstacles_file);
+            return -1;
+        }
+        S->use_obstacles = true;
+    } else if (config->prob_field[0] != '\0') {
+        S->world_size = get_world_size_from_obstacles(config->prob_field);
+        if (S->world_size <= 0) {
+            printf("Error: Could not read probability field '%s'.\n", config->prob_field);
+            return -1;
+        }
+    } else {
+        S->world_size = config->world_size;
+    }
+    allocate_world(S);
+    initialize_world(S);
+    if (config->generate[0] != '\0' ? worldgen_generate(S, &gen, stdout) != 0
+                                     : S->use_obstacles && !load_obstacles(S, config->obstacles_file)) {
+        free_world(S);
+        return -1;
+    }
+    if (config->prob_field[0] != '\0' && !probfield_load(S, config->prob_field)) {
+        free_world(S);
+        return -1;
+    }
+    if (config->targets[0] != '\0') {
+        TargetRect targets[TARGET_MAX];
+        int count = target_parse(config->targets, targets, TARGET_MAX);
+        if (count < 0 || target_setup(S, targets, count) != 0) {
+            free_world(S);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Otvorí výstupný súbor v saved/ (ako save_simulation_results).
+static FILE *open_result_file(const char *name, char *path, size_t size)
+{
+    struct stat st;
+    if (stat(SAVED_DIR, &st) == -1) mkdir(SAVED_DIR, 0755);
+    snprintf(path, size, "%s/%s", SAVED_DIR, name);
+    FILE *f = fopen(path, "w");
+    if (!f) printf("Error: Could not open file '%s' for writing.\n", path);
+    return f;
+}
+
+static double elapsed_s(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+// Hlavná funkcia sweepu: jeden svet, všetky body za sebou s rovnakým seedom.
+int sweep_run(const ServerConfig *config)
+{
+    int cpu_list[AFFINITY_MAX_CPUS];
+    int ncpus = server_cpu_plan(config, cpu_list, AFFINITY_MAX_CPUS);
+    if (ncpus < 0) return 1;
+
+    SweepGrid *g = calloc(1, sizeof(SweepGrid));
+    if (!g) return 1;
+    if (load_sweep_file(config->sweep_file, g) != 0) {
+        free(g);
+        return 1;
+    }
+    // Pole pravdepodobností platí pre všetky body, sweep potom mení len max_steps.
+    if (config->prob_field[0] != '\0' && g->nprobs > 0) {
+        printf("Error: 'prob' lines cannot be combined with --prob-field.\n");
+        free(g);
+        return 1;
+    }
+    if (g->nprobs == 0) {
+        g->probs[0] = (Probabilities){ config->prob_up, config->prob_down,
+                                       config->prob_left, config->prob_right };
+        g->nprobs = 1;
+    }
+    if (g->nsteps == 0) g->steps[g->nsteps++] = config->max_steps;
+
+    // stdout patrí súhrnu bodov, hlásenia idú na stderr (ako v headless móde).
+    FILE *summary = NULL;
+    int out_fd = dup(STDOUT_FILENO);
+    if (out_fd >= 0) summary = fdopen(out_fd, "w");
+    fflush(stdout);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    if (!summary) summary = stderr;
+
+    SharedState S;
+    memset(&S, 0, sizeof(S));
+    if (setup_world(config, &S) != 0) {
+        if (summary != stderr) fclose(summary);
+        free(g);
+        return 1;
+    }
+    S.mode = 2;
+    S.replications = config->replications;
+    S.threads = config->threads > 0 ? config->threads : 1;
+    S.batch = config->batch;
+    S.cpus = ncpus > 0 ? cpu_list : NULL;
+    S.ncpus = ncpus;
+    S.seed = config->seed ? config->seed
+                          : walk_rng_mix((uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32));
+    pthread_mutex_init(&S.lock, NULL);
+
+    char result_path[512] = "";
+    FILE *cells_out = NULL;
+    if (config->output_file[0] != '\0') {
+        cells_out = open_result_file(config->output_file, result_path, sizeof(result_path));
+        if (cells_out) fprintf(cells_out, "point,x,y,success_count,total_steps\n");
+    }
+
+    int n = S.world_size;
+    int points = g->nprobs * g->nsteps;
+    printf("[Sweep] %d point(s) on %dx%d, %d replications each, seed %llu, %d thread(s).\n",
+           points, n, n, S.replications, (unsigned long long)S.seed, S.threads);
+    fprintf(summary, "point,prob_up,prob_down,prob_left,prob_right,max_steps,replications,walks,"
+                     "successes,success_rate,mean_steps,sim_time_s,seed\n");
+
+    int point = 0;
+    for (int pi = 0; pi < g->nprobs; pi++) {
+        for (int si = 0; si < g->nsteps; si++, point++) {
+            // Rovnaký seed a čísla replikácií => každá (replikácia, bunka) má v každom bode
+            // rovnaký prúd, body sa líšia len parametrami.
+            size_t cells = (size_t)n * n;
+            memset(S.grid_block + cells, 0, 2 * cells * sizeof(int));
+            S.prob = g->probs[pi];
+            S.max_steps = g->steps[si];
+            S.current_rep = 0;
+            S.walks_done = 0;
+            S.steps_done = 0;
+            S.finished = false;
+
+            struct timespec t0, t1;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            simulation_thread(&S);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+
+            long long successes = 0, success_steps = 0;
+            for (int y = 0; y < n; y++) {
+                for (int x = 0; x < n; x++) {
+                    successes += S.success_count[y][x];
+                    success_steps += S.total_steps[y][x];
+                    if (cells_out && !S.obstacles[y][x])
+                        fprintf(cells_out, "%d,%d,%d,%d,%d\n", point, x, y,
+                                S.success_count[y][x], S.total_steps[y][x]);
+                }
+            }
+            double rate = S.walks_done > 0 ? (double)successes / S.walks_done : 0.0;
+            double mean = successes > 0 ? (double)success_steps / successes : 0.0;
+            fprintf(summary, "%d,%.6f,%.6f,%.6f,%.6f,%d,%d,%lld,%lld,%.6f,%.3f,%.6f,%llu\n",
+                    point, S.prob.up, S.prob.down, S.prob.left, S.prob.right, S.max_steps,
+                    S.replications, S.walks_done, successes, rate, mean,
+                    elapsed_s(&t0, &t1), (unsigned long long)S.seed);
+            fflush(summary);
+            printf("[Sweep] Point %d/%d done: success rate %.4f.\n", point + 1, points, rate);
+        }
+    }
+
+    int rc = 0;
+    if (cells_out) {
+        if (fclose(cells_out) != 0) rc = 1;
+        else printf("[Sweep] Cell statistics written to '%s'.\n", result_path);
+    } else if (config->output_file[0] != '\0') {
+        rc = 1;
+    }
+
+    pthread_mutex_destroy(&S.lock);
+    free_world(&S);
+    if (summary != stderr) fclose(summary);
+    free(g);
+    return rc;
+}
@@ -0,0 +1,22 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "server.h"
+
+// Sweep parametrov: viac bodov (pravdepodobnosti x max_steps) na jednom svete v jednom procese.
+// Všetky body používajú rovnaké prúdy náhodných čísel pre (replikáciu, bunku) - spoločné náhodné
+// čísla (CRN), takže rozdiely medzi bodmi majú oveľa menší rozptyl ako pri nezávislých behoch.
+//
+// Súbor sweepu (--sweep), riadky:
+//   prob <up> <down> <left> <right>   jeden vektor pravdepodobností (riadok sa môže opakovať)
+//   steps <k1> [k2 ...]               hodnoty max_steps
+//   # komentár
+// Body sú kartézsky súčin všetkých prob a steps; chýbajúcu os doplní -p / -k.
+
+#define SWEEP_MAX_PROBS 256
+#define SWEEP_MAX_STEPS 256
+
+// Spustí všetky body; súhrn bodov ide ako CSV na stdout, štatistiky buniek do saved/<-o>.
+int sweep_run(const ServerConfig *config);
+
+#endif // SWEEP_H
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "target.h"
+#include "simulation.h"
+
+// Cieľové bunky: parsovanie, mapa cieľov alebo posun na toruse a posúvanie výsledkov.
+
+int target_parse(const char *spec, TargetRect *out, int max)
+{
+    int count = 0;
+    const char *p = spec;
+    while (*p) {
+        TargetRect t;
+        int used = 0;
+        if (sscanf(p, " %d , %d - %d , %d%n", &t.x0, &t.y0, &t.x1, &t.y1, &used) == 4) {
+            if (t.x0 > t.x1) { int s = t.x0; t.x0 = t.x1; t.x1 = s; }
+            if (t.y0 > t.y1) { int s = t.y0; t.y0 = t.y1; t.y1 = s; }
+        } else if (sscanf(p, " %d , %d%n", &t.x0, &t.y0, &used) == 2) {
+            t.x1 = t.x0;
+            t.y1 = t.y0;
+        } else {
+            printf("Error: Invalid target near '%s' (expected x,y or x0,y0-x1,y1).\n", p);
+            return -1;
+        }
+        if (count >= max) {
+            printf("Error: At most %d targets are supported.\n", max);
+            return -1;
+        }
+        out[count++] = t;
+        p += used;
+        while (*p == ' ') p++;
+        if (*p == ';') p++;
+        else if (*p != '\0') {
+            printf("Error: Invalid target near '%s'.\n", p);
+            return -1;
+        }
+    }
+    if (count == 0) printf("Error: Empty target list.\n");
+    return count > 0 ? count : -1;
+}
+
+int target_translatable(const SharedState *S, const TargetRect *targets, int count)
+{
+    if (S->use_obstacles || S->prob_field) return 0;
+    // Torus môže niesť prekážky pridané za behu (OBSTACLE).
+    for (int y = 0; y < S->world_size; y++)
+        for (int x = 0; x < S->world_size; x++)
+            if (S->obstacles[y][x]) return 0;
+    if (count == 0) return 1;
+    return count == 1 && targets[0].x0 == targets[0].x1 && targets[0].y0 == targets[0].y1;
+}
+
+// Uvoľní ciele a vráti svet k predvolenému stredu.
+static void target_clear(SharedState *S)
+{
+    free(S->targets);
+    free(S->target_map);
+    free(S->target_hits);
+    S->targets = NULL;
+    S->target_map = NULL;
+    S->target_hits = NULL;
+    S->ntargets = 0;
+    S->shift_x = 0;
+    S->shift_y = 0;
+}
+
+int target_setup(SharedState *S, const TargetRect *targets, int count)
+{
+    int n = S->world_size;
+    for (int i = 0; i < count; i++) {
+        const TargetRect *t = &targets[i];
+        if (t->x0 < 0 || t->y0 < 0 || t->x1 >= n || t->y1 >= n) {
+            printf("Error: Target %d (%d,%d-%d,%d) is outside the %dx%d world.\n",
+                   i, t->x0, t->y0, t->x1, t->y1, n, n);
+            return -1;
+        }
+    }
+    // Kópia pred uvoľnením: targets môže ukazovať na S->targets.
+    TargetRect *copy = count > 0 ? malloc(count * sizeof(TargetRect)) : NULL;
+    long long *hits = count > 0 ? calloc(count, sizeof(long long)) : NULL;
+    if (count > 0 && (!copy || !hits)) {
+        printf("Error: Could not allocate targets.\n");
+        free(copy);
+        free(hits);
+        return -1;
+    }
+    if (count > 0) memcpy(copy, targets, count * sizeof(TargetRect));
+    target_clear(S);
+    if (count == 0) return 0;
+
+    S->targets = copy;
+    S->target_hits = hits;
+    S->ntargets = count;
+    if (target_translatable(S, copy, count)) {
+        S->shift_x = copy[0].x0 - n / 2;
+        if (S->shift_x < 0) S->shift_x += n;
+        S->shift_y = copy[0].y0 - n / 2;
+        if (S->shift_y < 0) S->shift_y += n;
+        // Jediný cieľ: jeho zásahy sú všetky úspešné prechádzky.
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++) hits[0] += S->success_count[y][x];
+        return 0;
+    }
+
+    S->target_map = calloc((size_t)n * n, 1);
+    if (!S->target_map) {
+        printf("Error: Could not allocate target map.\n");
+        target_clear(S);
+        return -1;
+    }
+    int cleared = 0;
+    for (int i = 0; i < count; i++) {
+        for (int y = copy[i].y0; y <= copy[i].y1; y++) {
+            for (int x = copy[i].x0; x <= copy[i].x1; x++) {
+                if (S->obstacles[y][x]) {
+                    S->obstacles[y][x] = 0;
+                    cleared++;
+                }
+                unsigned char *m = &S->target_map[(size_t)y * n + x];
+                if (*m == 0) *m = (unsigned char)(i + 1);  // pri prekryve platí prvý cieľ
+            }
+        }
+    }
+    if (cleared > 0) printf("Warning: %d obstacle(s) under targets removed.\n", cleared);
+    return 0;
+}
+
+void target_shift_results(SharedState *S, int dx, int dy)
+{
+    int n = S->world_size;
+    dx = ((dx % n) + n) % n;
+    dy = ((dy % n) + n) % n;
+    if (dx == 0 && dy == 0) return;
+    size_t cells = (size_t)n * n;
+    long long *tmp = malloc(cells * sizeof(long long));
+    if (!tmp) {
+        printf("Error: Could not allocate memory to shift results.\n");
+        return;
+    }
+    int **grids[2] = { S->total_steps, S->success_count };
+    for (int g = 0; g < 2; g++) {
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++)
+                tmp[(size_t)((y + dy) % n) * n + (x + dx) % n] = grids[g][y][x];
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++) grids[g][y][x] = (int)tmp[(size_t)y * n + x];
+    }
+    for (int h = 0; S->occupancy && h < 2; h++) {
+        long long *occ = S->occupancy + h * cells;
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++)
+                tmp[(size_t)((y + dy) % n) * n + (x + dx) % n] = occ[(size_t)y * n + x];
+        memcpy(occ, tmp, cells * sizeof(long long));
+    }
+    free(tmp);
+}
+
+int target_same(const SharedState *a, const SharedState *b)
+{
+    if (a->ntargets != b->ntargets) return 0;
+    for (int i = 0; i < a->ntargets; i++) {
+        const TargetRect *p = &a->targets[i], *q = &b->targets[i];
+        if (p->x0 != q->x0 || p->y0 != q->y0 || p->x1 != q->x1 || p->y1 != q->y1) return 0;
+    }
+    return 1;
+}
+
+void target_format(const SharedState *S, char *buf, int size)
+{
+    if (S->ntargets == 0) {
+        snprintf(buf, size, "center");
+        return;
+    }
+    int len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < S->ntargets && len < size; i++) {
+        const TargetRect *t = &S->targets[i];
+        if (t->x0 == t->x1 && t->y0 == t->y1)
+            len += snprintf(buf + len, size - len, "%s%d,%d", i ? ";" : "", t->x0, t->y0);
+        else
+            len += snprintf(buf + len, size - len, "%s%d,%d-%d,%d", i ? ";" : "", t->x0, t->y0, t->x1, t->y1);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef TARGET_H
+#define TARGET_H
+
+// Cieľové bunky (--target): namiesto stredu sveta pohlcujúca množina buniek a obdĺžnikov.
+// Špecifikácia: položky oddelené ';', "x,y" = jedna bunka, "x0,y0-x1,y1" = obdĺžnik (vrátane
+// okrajov), napr. "3,4;10,10-12,12". Každá položka je jeden cieľ: prechádzka končí v prvej
+// cieľovej bunke, do ktorej vojde, a úspech sa pripíše aj tomuto cieľu (target_hits).
+//
+// Na toruse (bez prekážok a bez poľa pravdepodobností) s jedinou cieľovou bunkou je výsledok len
+// posunutím výsledku pre stred. Vtedy sa mapa cieľov nestavia: bunka (x, y) sa simuluje ako
+// prechádzka zo (x - shift_x, y - shift_y) do stredu s prúdom náhodných čísel tej bunky, takže
+// pri rovnakom seede vyjde presne posunutý výsledok stredu a uložené výsledky sa dajú pri -l
+// pre iný cieľ len posunúť.
+
+#define TARGET_MAX 64
+
+struct SharedState;
+
+typedef struct TargetRect {
+    int x0, y0;
+    int x1, y1;
+} TargetRect;
+
+// Rozparsuje špecifikáciu do out (najviac max položiek). Vráti počet alebo -1 (a vypíše chybu).
+int target_parse(const char *spec, TargetRect *out, int max);
+// Nastaví ciele sveta (prekážky pod nimi odstráni). count == 0 vráti predvolený stred. Vráti 0 alebo -1.
+int target_setup(struct SharedState *S, const TargetRect *targets, int count);
+// 1 = ciele sa dajú nahradiť posunom výsledkov pre stred (torus bez prekážok a jediná bunka).
+int target_translatable(const struct SharedState *S, const TargetRect *targets, int count);
+// Posunie výsledky (mriežky a mapu obsadenosti) na toruse o (dx, dy).
+void target_shift_results(struct SharedState *S, int dx, int dy);
+// 1 = dva svety majú rovnaké ciele.
+int target_same(const struct SharedState *a, const struct SharedState *b);
+// Vypíše ciele ako špecifikáciu (pre výpisy servera), "center" ak nie sú zadané.
+void target_format(const struct SharedState *S, char *buf, int size);
+
+#endif // TARGET_H
@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 200809L
+#include "trace.h"
+
+#ifdef POS_TRACE
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+// Jedna ukončená udalosť (Chrome trace "X": začiatok + trvanie).
+typedef struct TraceEvent {
+    const char *name;   // statický reťazec
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+    long long arg;
+    char detail[16];
+} TraceEvent;
+
+// Kruhový buffer jedného vlákna: zapisuje len vlastník, výpis ho číta bez zámku.
+typedef struct TraceRing {
+    atomic_ullong head;         // počet zapísaných udalostí (nikdy neklesá)
+    int tid;
+    char thread_name[32];
+    struct TraceRing *next;
+    TraceEvent events[TRACE_RING_EVENTS];
+} TraceRing;
+
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER; // len registrácia a výpis
+static TraceRing *rings = NULL;
+static int next_tid = 1;
+static uint64_t base_ns = 0;
+static _Thread_local TraceRing *tls_ring = NULL;
+
+uint64_t trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Buffer aktuálneho vlákna; pri prvej udalosti ho vytvorí a zaradí do zoznamu.
+static TraceRing *thread_ring(void)
+{
+    if (tls_ring) return tls_ring;
+    TraceRing *r = calloc(1, sizeof(TraceRing));
+    if (!r) return NULL;
+    pthread_mutex_lock(&rings_lock);
+    r->tid = next_tid++;
+    snprintf(r->thread_name, sizeof(r->thread_name), "thread-%d", r->tid);
+    r->next = rings;
+    rings = r;
+    pthread_mutex_unlock(&rings_lock);
+    tls_ring = r;
+    return r;
+}
+
+// Zapíše udalosť, ktorá začala v start_ns a končí teraz.
+void trace_complete(const char *name, uint64_t start_ns, long long arg, const char *detail)
+{
+    uint64_t end = trace_now();
+    TraceRing *r = thread_ring();
+    if (!r) return;
+    unsigned long long idx = atomic_load_explicit(&r->head, memory_order_relaxed);
+    TraceEvent *e = &r->events[idx % TRACE_RING_EVENTS];
+    e->name = name;
+    e->ts_ns = start_ns;
+    e->dur_ns = end - start_ns;
+    e->arg = arg;
+    e->detail[0] = '\0';
+    if (detail) {
+        strncpy(e->detail, detail, sizeof(e->detail) - 1);
+        e->detail[sizeof(e->detail) - 1] = '\0';
+    }
+    atomic_store_explicit(&r->head, idx + 1, memory_order_release);
+}
+
+// Pomenuje aktuálne vlákno vo výpise.
+void trace_thread_name(const char *name)
+{
+    TraceRing *r = thread_ring();
+    if (!r) return;
+    pthread_mutex_lock(&rings_lock);
+    snprintf(r->thread_name, sizeof(r->thread_name), "%s", name);
+    pthread_mutex_unlock(&rings_lock);
+}
+
+// Vypíše reťazec ako JSON (len znaky, ktoré sa môžu objaviť v názvoch a príkazoch).
+static void json_str(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+// Zapíše všetky buffre ako Chrome trace JSON. Vracia 0 pri úspechu, -1 pri chybe.
+int trace_dump(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    TraceEvent *copy = malloc(sizeof(TraceEvent) * TRACE_RING_EVENTS);
+    if (!copy) {
+        fclose(f);
+        return -1;
+    }
+
+    int pid = (int)getpid();
+    bool first = true;
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    pthread_mutex_lock(&rings_lock);
+    for (TraceRing *r = rings; r; r = r->next) {
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",\n", pid, r->tid);
+        json_str(f, r->thread_name);
+        fprintf(f, "}}");
+        first = false;
+
+        // Skopíruj a potom zahoď udalosti, ktoré mohol vlastník medzitým prepísať.
+        unsigned long long h1 = atomic_load_explicit(&r->head, memory_order_acquire);
+        unsigned long long start = h1 > TRACE_RING_EVENTS ? h1 - TRACE_RING_EVENTS : 0;
+        for (unsigned long long i = start; i < h1; i++)
+            copy[i - start] = r->events[i % TRACE_RING_EVENTS];
+        unsigned long long h2 = atomic_load_explicit(&r->head, memory_order_acquire);
+        unsigned long long from = start;
+        if (h2 >= TRACE_RING_EVENTS && h2 - TRACE_RING_EVENTS + 1 > from)
+            from = h2 - TRACE_RING_EVENTS + 1;
+
+        for (unsigned long long i = from; i < h1; i++) {
+            const TraceEvent *e = &copy[i - start];
+            fprintf(f, ",\n{\"name\":");
+            json_str(f, e->name);
+            fprintf(f, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+                    pid, r->tid, (double)(e->ts_ns - base_ns) / 1000.0, (double)e->dur_ns / 1000.0);
+            if (e->detail[0]) {
+                fprintf(f, "\"detail\":");
+                json_str(f, e->detail);
+            } else {
+                fprintf(f, "\"arg\":%lld", e->arg);
+            }
+            fprintf(f, "}}");
+        }
+    }
+    pthread_mutex_unlock(&rings_lock);
+    fprintf(f, "\n]}\n");
+    free(copy);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// Cesta výstupného súboru: POS_TRACE_FILE alebo trace_<pid>.json.
+static void trace_path(char *buf, size_t size)
+{
+    const char *env = getenv("POS_TRACE_FILE");
+    if (env && env[0]) snprintf(buf, size, "%s", env);
+    else snprintf(buf, size, "trace_%d.json", (int)getpid());
+}
+
+static void trace_dump_default(void)
+{
+    char path[256];
+    trace_path(path, sizeof(path));
+    if (trace_dump(path) == 0) fprintf(stderr, "[Trace] Written %s\n", path);
+    else fprintf(stderr, "[Trace] Failed to write %s\n", path);
+}
+
+// Čaká na SIGUSR2 a vypíše priebežný stav (signál je v ostatných vláknach blokovaný).
+static void *signal_thread(void *arg)
+{
+    sigset_t *set = arg;
+    int sig;
+    while (sigwait(set, &sig) == 0)
+        trace_dump_default();
+    return NULL;
+}
+
+// Zapne výpis pri ukončení a na SIGUSR2. Volať skôr, ako vzniknú ďalšie vlákna.
+void trace_start(void)
+{
+    static sigset_t set;
+    base_ns = trace_now();
+    TRACE_THREAD("main");
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    pthread_t thr;
+    if (pthread_create(&thr, NULL, signal_thread, &set) == 0)
+        pthread_detach(thr);
+    atexit(trace_dump_default);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Trasovanie hlavných fáz behu do Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Zapína sa pri preklade (make TRACE=1 => -DPOS_TRACE); bez neho sa makrá rozvinú na nič.
+//
+//   TRACE_BEGIN(t0);
+//   ... práca ...
+//   TRACE_END(t0, "replication", r);
+//
+// Udalosti idú do kruhového bufferu vlákna bez zámkov. Súbor sa zapíše pri ukončení procesu
+// a na SIGUSR2 (cesta z POS_TRACE_FILE, inak trace_<pid>.json).
+
+#ifdef POS_TRACE
+
+#define TRACE_RING_EVENTS 16384  // udalostí na vlákno, staršie sa prepisujú
+
+uint64_t trace_now(void);
+void trace_complete(const char *name, uint64_t start_ns, long long arg, const char *detail);
+void trace_thread_name(const char *name);
+void trace_start(void);
+int trace_dump(const char *path);
+
+#define TRACE_BEGIN(var)                   uint64_t var = trace_now()
+#define TRACE_END(var, name, arg)          trace_complete((name), (var), (arg), NULL)
+#define TRACE_END_DETAIL(var, name, str)   trace_complete((name), (var), 0, (str))
+#define TRACE_THREAD(name)                 trace_thread_name(name)
+#define TRACE_START()                      trace_start()
+
+#else
+
+#define TRACE_BEGIN(var)                   ((void)0)
+#define TRACE_END(var, name, arg)          ((void)0)
+#define TRACE_END_DETAIL(var, name, str)   ((void)0)
+#define TRACE_THREAD(name)                 ((void)0)
+#define TRACE_START()                      ((void)0)
+
+#endif
+
+#endif // TRACE_H
@@ -1,6 +1,6 @@
-#include <stdlib.h>
 #include "walker.h"
 #include "simulation.h"
+#include "probfield.h"
 
 // Pohyb chodca podľa pravdepodobností a rešpektovanie prekážok alebo wrap-aroundu.
 // Inicializuje pozíciu chodca na zadané súradnice.
@@ -11,26 +11,36 @@ void walker_init(Walker *w, int x, int y)
 }
 
 // Vykoná jeden krok náhodnej prechádzky podľa pravdepodobností a pravidiel sveta.
-void random_walk(SharedState *S, Walker* w)
+void random_walk(SharedState *S, Walker* w, WalkRng *rng)
 {
-    double p_up    = S->prob.up;
-    double p_down  = p_up   + S->prob.down;
-    double p_left  = p_down + S->prob.left;
-
-    double r = (double)rand() / RAND_MAX;
-
     int new_x = w->x;
     int new_y = w->y;
 
-    // Urči základný smer pohybu (bez wrap-around)
-    if (r < p_up)
-        new_y = w->y - 1;
-    else if (r < p_down)
-        new_y = w->y + 1;
-    else if (r < p_left)
-        new_x = w->x - 1;
-    else
-        new_x = w->x + 1;
+    if (S->prob_alias) {
+        // Pole pravdepodobností: alias tabuľka bunky, jedno náhodné číslo a jedno porovnanie
+        static const int dx[4] = { 0, 0, -1, 1 };
+        static const int dy[4] = { -1, 1, 0, 0 };
+        const uint32_t *cell = &S->prob_alias[4 * ((size_t)w->y * S->world_size + w->x)];
+        int dir = probfield_sample(cell, walk_rng_next(rng));
+        new_x += dx[dir];
+        new_y += dy[dir];
+    } else {
+        double p_up    = S->prob.up;
+        double p_down  = p_up   + S->prob.down;
+        double p_left  = p_down + S->prob.left;
+
+        double r = walk_rng_uniform(rng);
+
+        // Urči základný smer pohybu (bez wrap-around)
+        if (r < p_up)
+            new_y = w->y - 1;
+        else if (r < p_down)
+            new_y = w->y + 1;
+        else if (r < p_left)
+            new_x = w->x - 1;
+        else
+            new_x = w->x + 1;
+    }
   
     // Pre svet BEZ prekážok: aplikuj wrap-around
     if (!S->use_obstacles) {
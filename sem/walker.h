@@ -1,15 +1,50 @@
 #ifndef WALKER_H
 #define WALKER_H
 
+#include <stdint.h>
+
 typedef struct Walker {
     int x;
     int y;
 } Walker;
 
+// Generátor náhodných čísel pre jednu prechádzku (splitmix64 nad počítadlom).
+// Každá prechádzka má vlastný prúd odvodený zo (seed, replikácia, bunka), takže výsledok
+// nezávisí od počtu vlákien ani od poradia, v akom sa bunky spracujú.
+typedef struct WalkRng {
+    uint64_t state;
+} WalkRng;
+
+// Premieša 64-bitovú hodnotu (finalizér splitmix64).
+static inline uint64_t walk_rng_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline void walk_rng_seed(WalkRng *r, uint64_t seed, uint64_t stream, uint64_t index)
+{
+    r->state = walk_rng_mix(walk_rng_mix(seed ^ (stream * 0xD1B54A32D192ED03ull)) ^
+                            (index * 0x9E3779B97F4A7C15ull));
+}
+
+static inline uint64_t walk_rng_next(WalkRng *r)
+{
+    r->state += 0x9E3779B97F4A7C15ull;
+    return walk_rng_mix(r->state);
+}
+
+// Rovnomerné číslo z [0, 1) s 53-bitovou presnosťou.
+static inline double walk_rng_uniform(WalkRng *r)
+{
+    return (double)(walk_rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
 // Rozhranie pre inicializáciu a pohyb chodca.
 struct SharedState;          
 
 void walker_init(Walker *w, int x, int y);
-void random_walk(struct SharedState *S, Walker* w);
+void random_walk(struct SharedState *S, Walker* w, WalkRng *rng);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,39 +1,231 @@
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS, madvise
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "simulation.h"
 #include "world.h"
+#include "probfield.h"
+#include "target.h"
 
-#define SAVED_DIR "saved"
 
 // Svet simulácie: alokácia matíc, načítanie prekážok a ukladanie výsledkov.
 
+// Nastaví ukazovatele riadkov do súvislého bloku (obstacles, total_steps, success_count za sebou).
+static void bind_rows(SharedState *S, int *block)
+{
+    int n = S->world_size;
+    size_t cells = (size_t)n * n;
+    for (int i = 0; i < n; i++) {
+        S->obstacles[i]     = block + (size_t)i * n;
+        S->total_steps[i]   = block + cells + (size_t)i * n;
+        S->success_count[i] = block + 2 * cells + (size_t)i * n;
+    }
+    S->grid_block = block;
+}
+
 // Alokuje 2D polia pre štatistiky a prekážky podľa world_size.
+// Všetky tri mriežky ležia v jednom súvislom bloku, riadky sú len ukazovatele doň.
+// Pri nedostatku pamäte ostanú všetky ukazovatele NULL (volajúci kontroluje S->grid_block).
 void allocate_world(SharedState *S)
 {
+    size_t cells = (size_t)S->world_size * S->world_size;
     S->total_steps = malloc(S->world_size * sizeof(int*));
     S->success_count = malloc(S->world_size * sizeof(int*));
     S->obstacles = malloc(S->world_size * sizeof(int*));
+    S->grid_external = false;
+    int *block = calloc(3 * cells, sizeof(int));
+    if (!S->total_steps || !S->success_count || !S->obstacles || !block) {
+        free(S->total_steps);
+        free(S->success_count);
+        free(S->obstacles);
+        free(block);
+        S->total_steps = S->success_count = S->obstacles = NULL;
+        S->grid_block = NULL;
+        return;
+    }
+    bind_rows(S, block);
+}
 
-    for (int i = 0; i < S->world_size; i++) {
-        S->total_steps[i] = calloc(S->world_size, sizeof(int));
-        S->success_count[i] = calloc(S->world_size, sizeof(int));
-        S->obstacles[i] = calloc(S->world_size, sizeof(int));
+// Presunie mriežky do externého bloku (napr. zdieľanej pamäte pyramídy) veľkosti 3 * n * n.
+void world_rebind(SharedState *S, int *block)
+{
+    if (!S || !block || block == S->grid_block) return;
+    size_t cells = (size_t)S->world_size * S->world_size;
+    memcpy(block, S->grid_block, 3 * cells * sizeof(int));
+    if (!S->grid_external) free(S->grid_block);
+    bind_rows(S, block);
+    S->grid_external = true;
+}
+
+// Namapuje súbor s mriežkami; *existing = súbor už mal obsah. Vráti mapovanie alebo NULL.
+static void *map_grid_file(const char *path, size_t bytes, bool *existing)
+{
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        printf("Error: Could not open grid file '%s'.\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return NULL;
+    }
+    *existing = st.st_size > 0;
+    if (*existing && (size_t)st.st_size != bytes) {
+        printf("Error: Grid file '%s' has %lld bytes, expected %zu for this world.\n",
+               path, (long long)st.st_size, bytes);
+        close(fd);
+        return NULL;
+    }
+    if (!*existing && ftruncate(fd, (off_t)bytes) == -1) {
+        printf("Error: Could not size grid file '%s'.\n", path);
+        close(fd);
+        return NULL;
     }
+    void *base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+// Anonymné mapovanie; s hugepages skúsi najprv explicitné (MAP_HUGETLB), potom transparentné.
+static void *map_grid_anonymous(size_t bytes, bool hugepages)
+{
+    void *base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (hugepages)
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#else
+    (void)hugepages;
+#endif
+    if (base == MAP_FAILED)
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+// Overí, že existujúci súbor s mriežkami patrí k rovnakej konfigurácii a prekážkam.
+static int grid_file_matches(const SharedState *S, const GridFileHeader *h, const int *grid)
+{
+    if (h->magic != GRID_FILE_MAGIC || h->world_size != S->world_size || h->max_steps != S->max_steps ||
+        h->prob[0] != S->prob.up || h->prob[1] != S->prob.down ||
+        h->prob[2] != S->prob.left || h->prob[3] != S->prob.right) {
+        printf("Error: Grid file belongs to a different configuration.\n");
+        return 0;
+    }
+    size_t cells = (size_t)S->world_size * S->world_size;
+    for (size_t i = 0; i < cells; i++) {
+        if ((grid[i] != 0) != (S->grid_block[i] != 0)) {
+            printf("Error: Grid file has different obstacles.\n");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Presunie mriežky do mmap (súbor alebo anonymná pamäť s hugepages).
+int world_map_grids(SharedState *S, const char *path, bool hugepages)
+{
+    size_t cells = (size_t)S->world_size * S->world_size;
+    size_t grid_bytes = 3 * cells * sizeof(int);
+    size_t bytes = (path ? GRID_FILE_HEADER_SIZE : 0) + grid_bytes;
+    bool existing = false;
+
+    void *base = path ? map_grid_file(path, bytes, &existing) : map_grid_anonymous(bytes, hugepages);
+    if (!base) {
+        printf("Error: Could not map %zu bytes for the world grids.\n", bytes);
+        return -1;
+    }
+#ifdef MADV_HUGEPAGE
+    if (hugepages) madvise(base, bytes, MADV_HUGEPAGE); // len rada jadru, chyba nevadí
+#endif
+    // Štartové bunky idú po riadkoch, takže súbor sa číta a zapisuje prúdovo.
+    if (path) madvise(base, bytes, MADV_SEQUENTIAL);
+
+    GridFileHeader *hdr = path ? (GridFileHeader *)base : NULL;
+    int *grid = (int *)((char *)base + (path ? GRID_FILE_HEADER_SIZE : 0));
+
+    if (existing) {
+        if (S->current_rep > 0) {
+            printf("Error: Grid file '%s' already has results; do not combine it with -l.\n", path);
+            munmap(base, bytes);
+            return -1;
+        }
+        if (!grid_file_matches(S, hdr, grid)) {
+            munmap(base, bytes);
+            return -1;
+        }
+    } else {
+        memcpy(grid, S->grid_block, grid_bytes);
+        if (hdr) {
+            memset(hdr, 0, sizeof(*hdr));
+            hdr->magic = GRID_FILE_MAGIC;
+            hdr->world_size = S->world_size;
+            hdr->max_steps = S->max_steps;
+            hdr->reps_done = S->current_rep;
+            hdr->prob[0] = S->prob.up;
+            hdr->prob[1] = S->prob.down;
+            hdr->prob[2] = S->prob.left;
+            hdr->prob[3] = S->prob.right;
+        }
+    }
+
+    if (S->grid_map) munmap(S->grid_map, S->grid_map_size);
+    else if (!S->grid_external) free(S->grid_block);
+    bind_rows(S, grid);
+    S->grid_external = true;
+    S->grid_map = base;
+    S->grid_map_size = bytes;
+    S->grid_file = hdr;
+    if (existing) {
+        S->current_rep = hdr->reps_done;
+        return 1;
+    }
+    return 0;
 }
 
 // Uvoľní všetky dynamicky alokované matice sveta.
 void free_world(SharedState *S)
 {
-    for (int i = 0; i < S->world_size; i++) {
-        free(S->total_steps[i]);
-        free(S->success_count[i]);
-        free(S->obstacles[i]);
-    }
+    if (S->grid_map) munmap(S->grid_map, S->grid_map_size);
+    else if (!S->grid_external) free(S->grid_block);
+    S->grid_map = NULL;
+    S->grid_file = NULL;
+    S->grid_block = NULL;
     free(S->total_steps);
     free(S->success_count);
     free(S->obstacles);
+    free(S->occupancy);
+    S->occupancy = NULL;
+    free(S->prob_field);
+    free(S->prob_alias);
+    S->prob_field = NULL;
+    S->prob_alias = NULL;
+    free(S->stale);
+    S->stale = NULL;
+    S->stale_cells = 0;
+    target_setup(S, NULL, 0);
+}
+
+// Alokuje vynulovanú mapu obsadenosti. Vráti 1 pri úspechu, inak 0.
+int world_alloc_occupancy(SharedState *S)
+{
+    if (S->world_size > OCCUPANCY_MAX_WORLD) {
+        printf("Error: Occupancy map is limited to worlds up to %dx%d.\n",
+               OCCUPANCY_MAX_WORLD, OCCUPANCY_MAX_WORLD);
+        return 0;
+    }
+    size_t cells = (size_t)S->world_size * S->world_size;
+    S->occupancy = calloc(2 * cells, sizeof(long long));
+    if (!S->occupancy) {
+        printf("Error: Could not allocate occupancy map.\n");
+        return 0;
+    }
+    return 1;
 }
 
 // Vyplní polia nulami (čistý svet bez prekážok).
@@ -129,6 +321,14 @@ int save_simulation_results(SharedState *S, const char* filename)
     char filepath[512];
     snprintf(filepath, sizeof(filepath), "%s/%s", SAVED_DIR, filename);
 
+    if (!world_save_file(S, filepath)) return 0;
+    printf("[Server] Results saved to '%s'\n", filepath);
+    return 1;
+}
+
+// Zapíše výsledky do súboru na zadanej ceste (bez saved/). Vráti 1 pri úspechu, inak 0.
+int world_save_file(const SharedState *S, const char *filepath)
+{
     FILE *f = fopen(filepath, "w");
     if (!f) {
         printf("Error: Could not open file '%s' for writing.\n", filepath);
@@ -159,9 +359,44 @@ int save_simulation_results(SharedState *S, const char* filename)
         fprintf(f, "\n");
     }
 
-    fclose(f);
-    printf("[Server] Results saved to '%s'\n", filepath);
-    return 1;
+    // 4. Mapa obsadenosti (voliteľná): "occupancy" a návštevy úspešných/neúspešných prechádzok
+    if (S->occupancy) {
+        size_t cells = (size_t)S->world_size * S->world_size;
+        fprintf(f, "occupancy\n");
+        for (int y = 0; y < S->world_size; y++) {
+            for (int x = 0; x < S->world_size; x++) {
+                size_t c = (size_t)y * S->world_size + x;
+                fprintf(f, "%lld %lld ", S->occupancy[c], S->occupancy[cells + c]);
+            }
+            fprintf(f, "\n");
+        }
+    }
+
+    // 5. Pole pravdepodobností (voliteľné): "probfield" a štvorica up/down/left/right po bunkách
+    if (S->prob_field) {
+        fprintf(f, "probfield\n");
+        for (int y = 0; y < S->world_size; y++) {
+            for (int x = 0; x < S->world_size; x++) {
+                const double *p = &S->prob_field[4 * ((size_t)y * S->world_size + x)];
+                fprintf(f, "%.6f %.6f %.6f %.6f ", p[0], p[1], p[2], p[3]);
+            }
+            fprintf(f, "\n");
+        }
+    }
+
+    // 6. Ciele (voliteľné): "targets", počet a riadky "x0 y0 x1 y1 zásahy"
+    if (S->ntargets > 0) {
+        fprintf(f, "targets\n%d\n", S->ntargets);
+        for (int i = 0; i < S->ntargets; i++) {
+            const TargetRect *t = &S->targets[i];
+            fprintf(f, "%d %d %d %d %lld\n", t->x0, t->y0, t->x1, t->y1, S->target_hits[i]);
+        }
+    }
+
+    // 7. Seed (voliteľný): "seed" a základ prúdov, z ktorých vznikli replikácie 0..replications-1
+    if (S->seed) fprintf(f, "seed\n%llu\n", (unsigned long long)S->seed);
+
+    return fclose(f) == 0 ? 1 : 0;
 }
 
 // Obnoví predchádzajúcu simuláciu zo súboru.
@@ -176,6 +411,16 @@ int load_previous_simulation(SharedState *S, const char* filename)
     char filepath[512];
     snprintf(filepath, sizeof(filepath), "%s/%s", SAVED_DIR, filename);
 
+    if (!world_load_file(S, filepath)) return 0;
+    printf("[Server] Simulation loaded from '%s'\n", filepath);
+    printf("  World: %dx%d, Replications: %d, Max steps: %d\n",
+           S->world_size, S->world_size, S->replications, S->max_steps);
+    return 1;
+}
+
+// Načíta výsledky zo súboru na zadanej ceste (bez saved/). Vráti 1 pri úspechu, inak 0.
+int world_load_file(SharedState *S, const char *filepath)
+{
     FILE *f = fopen(filepath, "r");
     if (!f) {
         printf("Error: Could not open file '%s' for reading.\n", filepath);
@@ -208,6 +453,11 @@ int load_previous_simulation(SharedState *S, const char* filename)
 
     // Alokuj pamäť pre mapy
     allocate_world(S);
+    if (!S->grid_block) {
+        printf("Error: Not enough memory for a %dx%d world.\n", world_size, world_size);
+        fclose(f);
+        return 0;
+    }
 
     // Načítaj obstacles matrix
     for (int y = 0; y < world_size; y++) {
@@ -233,9 +483,169 @@ int load_previous_simulation(SharedState *S, const char* filename)
         }
     }
 
+    // Voliteľné sekcie: mapa obsadenosti (--occupancy) a pole pravdepodobností (--prob-field)
+    char tag[16];
+    size_t cells = (size_t)world_size * world_size;
+    while (fscanf(f, "%15s", tag) == 1) {
+        if (strcmp(tag, "occupancy") == 0) {
+            if (!world_alloc_occupancy(S)) {
+                fclose(f);
+                free_world(S);
+                return 0;
+            }
+            for (size_t c = 0; c < cells; c++) {
+                if (fscanf(f, "%lld %lld", &S->occupancy[c], &S->occupancy[cells + c]) != 2) {
+                    printf("Error: Failed to load occupancy at [%d][%d].\n",
+                           (int)(c / world_size), (int)(c % world_size));
+                    fclose(f);
+                    free_world(S);
+                    return 0;
+                }
+            }
+        } else if (strcmp(tag, "probfield") == 0) {
+            if (!probfield_alloc(S)) {
+                fclose(f);
+                free_world(S);
+                return 0;
+            }
+            for (size_t i = 0; i < 4 * cells; i++) {
+                if (fscanf(f, "%lf", &S->prob_field[i]) != 1) {
+                    printf("Error: Failed to load probability field at [%d][%d].\n",
+                           (int)(i / 4 / world_size), (int)(i / 4 % world_size));
+                    fclose(f);
+                    free_world(S);
+                    return 0;
+                }
+            }
+            if (!probfield_build(S)) {
+                fclose(f);
+                free_world(S);
+                return 0;
+            }
+        } else if (strcmp(tag, "targets") == 0) {
+            TargetRect targets[TARGET_MAX];
+            long long hits[TARGET_MAX];
+            int count = 0;
+            int ok = fscanf(f, "%d", &count) == 1 && count > 0 && count <= TARGET_MAX;
+            for (int i = 0; ok && i < count; i++)
+                ok = fscanf(f, "%d %d %d %d %lld", &targets[i].x0, &targets[i].y0,
+                            &targets[i].x1, &targets[i].y1, &hits[i]) == 5;
+            if (!ok || target_setup(S, targets, count) != 0) {
+                printf("Error: Failed to load targets.\n");
+                fclose(f);
+                free_world(S);
+                return 0;
+            }
+            memcpy(S->target_hits, hits, count * sizeof(long long));
+        } else if (strcmp(tag, "seed") == 0) {
+            unsigned long long seed;
+            if (fscanf(f, "%llu", &seed) != 1) {
+                printf("Error: Failed to load seed.\n");
+                fclose(f);
+                free_world(S);
+                return 0;
+            }
+            S->seed = seed;
+        } else {
+            printf("Error: Unknown section '%s' in '%s'.\n", tag, filepath);
+            fclose(f);
+            free_world(S);
+            return 0;
+        }
+    }
+
     fclose(f);
-    printf("[Server] Simulation loaded from '%s'\n", filepath);
-    printf("  World: %dx%d, Replications: %d, Max steps: %d\n", 
-           world_size, world_size, replications, max_steps);
     return 1;
-}
\ No newline at end of file
+}
+// Súbory nesú pravdepodobnosti na 6 desatinných miest.
+static int prob_differs(double a, double b)
+{
+    double d = a - b;
+    return d > 1e-6 || d < -1e-6;
+}
+
+// Overí, že dva behy majú rovnakú konfiguráciu (veľkosť, okraje, max_steps, pravdepodobnosti, prekážky).
+// Vráti 1 ak sú kompatibilné, inak 0 a vypíše dôvod.
+int world_compatible(const SharedState *a, const SharedState *b)
+{
+    if (a->world_size != b->world_size) {
+        printf("Error: World size differs (%d vs %d).\n", a->world_size, b->world_size);
+        return 0;
+    }
+    if (a->use_obstacles != b->use_obstacles) {
+        printf("Error: One run is a torus and the other has walls.\n");
+        return 0;
+    }
+    if (a->max_steps != b->max_steps) {
+        printf("Error: Max steps differ (%d vs %d).\n", a->max_steps, b->max_steps);
+        return 0;
+    }
+    if (prob_differs(a->prob.up, b->prob.up) || prob_differs(a->prob.down, b->prob.down) ||
+        prob_differs(a->prob.left, b->prob.left) || prob_differs(a->prob.right, b->prob.right)) {
+        printf("Error: Move probabilities differ.\n");
+        return 0;
+    }
+    if (!target_same(a, b)) {
+        printf("Error: Targets differ.\n");
+        return 0;
+    }
+    if ((a->prob_field != NULL) != (b->prob_field != NULL)) {
+        printf("Error: Probability field is not present in both runs.\n");
+        return 0;
+    }
+    if (a->prob_field) {
+        size_t total = 4 * (size_t)a->world_size * a->world_size;
+        for (size_t i = 0; i < total; i++) {
+            if (prob_differs(a->prob_field[i], b->prob_field[i])) {
+                printf("Error: Probability fields differ at [%d][%d].\n",
+                       (int)(i / 4 / a->world_size), (int)(i / 4 % a->world_size));
+                return 0;
+            }
+        }
+    }
+    for (int y = 0; y < a->world_size; y++) {
+        for (int x = 0; x < a->world_size; x++) {
+            if ((a->obstacles[y][x] != 0) != (b->obstacles[y][x] != 0)) {
+                printf("Error: Obstacles differ at [%d][%d].\n", y, x);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Pripočíta štatistiky a replikácie behu src do dst (volajúci overil world_compatible).
+// Vráti 0, ak by súčet v niektorej bunke pretiekol int, inak 1.
+int world_accumulate(SharedState *dst, const SharedState *src)
+{
+    int n = dst->world_size;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            long long steps = (long long)dst->total_steps[y][x] + src->total_steps[y][x];
+            long long succ = (long long)dst->success_count[y][x] + src->success_count[y][x];
+            if (steps > INT_MAX || succ > INT_MAX) {
+                printf("Error: Statistics overflow at [%d][%d].\n", y, x);
+                return 0;
+            }
+        }
+    }
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            dst->total_steps[y][x] += src->total_steps[y][x];
+            dst->success_count[y][x] += src->success_count[y][x];
+        }
+    }
+    if (dst->occupancy && src->occupancy) {
+        size_t total = 2 * (size_t)n * n;
+        for (size_t c = 0; c < total; c++) dst->occupancy[c] += src->occupancy[c];
+    } else if (dst->occupancy || src->occupancy) {
+        printf("Warning: Occupancy map is not present in all runs, dropping it.\n");
+        free(dst->occupancy);
+        dst->occupancy = NULL;
+    }
+    for (int i = 0; i < dst->ntargets; i++) dst->target_hits[i] += src->target_hits[i];
+    // Súčet behov už nie sú replikácie 0..R-1 jedného seedu: resume z neho začne s novým seedom.
+    dst->seed = 0;
+    dst->replications += src->replications;
+    return 1;
+}
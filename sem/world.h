@@ -4,17 +4,47 @@
 #define CLEAR_SCREEN() printf("\033[2J\033[H")
 #define MOVE_CURSOR() printf("\033[H")
 
+#define SAVED_DIR "saved"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hlavička súboru s mriežkami (--grid-file); mriežky začínajú za ňou na hranici stránky.
+#define GRID_FILE_MAGIC 0x44495247u /* "GRID" */
+#define GRID_FILE_HEADER_SIZE 4096
+
+typedef struct GridFileHeader {
+    uint32_t magic;
+    int32_t world_size;
+    int32_t max_steps;
+    int32_t reps_done;      // dokončené replikácie (aktualizuje sa po každej)
+    double prob[4];         // up, down, left, right
+} GridFileHeader;
+
 // Rozhranie pre alokáciu, načítanie a ukladanie sveta simulácie.
 struct SharedState;   
 struct Walker;        
 
 void allocate_world(struct SharedState *S);
 void free_world(struct SharedState *S);
+void world_rebind(struct SharedState *S, int *block);
+// Mapa obsadenosti (--occupancy): 2 * n*n počítadiel, uvoľní ju free_world.
+int world_alloc_occupancy(struct SharedState *S);
+// Presunie mriežky do mmap: do súboru path (živé výsledky), alebo anonymne ak path == NULL.
+// Vráti 0 (nový súbor/anonymne), 1 (pokračuje sa zo súboru, current_rep nastavený) alebo -1.
+int world_map_grids(struct SharedState *S, const char *path, bool hugepages);
 
 void initialize_world(struct SharedState *S);
 int get_world_size_from_obstacles(const char* filename);
 int load_obstacles(struct SharedState *S, const char* filename);
 int save_simulation_results(struct SharedState *S, const char* filename);
 int load_previous_simulation(struct SharedState *S, const char* filename);
+// To isté pre cestu mimo saved/ (knižnica poswalk).
+int world_save_file(const struct SharedState *S, const char *filepath);
+int world_load_file(struct SharedState *S, const char *filepath);
+
+// Spájanie behov s rovnakou konfiguráciou (zlúčenie shardov, koordinátor).
+int world_compatible(const struct SharedState *a, const struct SharedState *b);
+int world_accumulate(struct SharedState *dst, const struct SharedState *src);
 
 #endif
\ No newline at end of file
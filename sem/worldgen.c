@@ -0,0 +1,362 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "worldgen.h"
+#include "server.h"
+#include "simulation.h"
+#include "walker.h"
+#include "world.h"
+
+// Generátory sveta: všetky čerpajú z jedného prúdu WalkRng odvodeného zo seed= špecifikácie.
+
+static const char *const kind_names[] = { "random", "maze", "rooms", "rings" };
+
+int worldgen_parse(const char *text, WorldGenSpec *spec)
+{
+    memset(spec, 0, sizeof(*spec));
+    spec->density = 0.3;
+    spec->gap = 4;
+    spec->seed = 1;
+
+    const char *colon = strchr(text, ':');
+    size_t len = colon ? (size_t)(colon - text) : 0;
+    int kind = -1;
+    for (int i = 0; colon && i < (int)(sizeof(kind_names) / sizeof(kind_names[0])); i++)
+        if (strlen(kind_names[i]) == len && strncmp(text, kind_names[i], len) == 0) kind = i;
+    if (kind < 0) {
+        printf("Error: Unknown world spec '%s' (expected random|maze|rooms|rings:<size>).\n", text);
+        return -1;
+    }
+    spec->kind = (WorldGenKind)kind;
+
+    char *end;
+    long size = strtol(colon + 1, &end, 10);
+    if (size < 3 || size > 46000) {
+        printf("Error: World spec size must be between 3 and 46000.\n");
+        return -1;
+    }
+    spec->size = (int)size;
+
+    // Zvyšok: ",kľúč=hodnota" ...
+    while (*end == ',') {
+        char key[16];
+        char value[32];
+        int used = 0;
+        if (sscanf(end + 1, "%15[^=,]=%31[^,]%n", key, value, &used) != 2) {
+            printf("Error: Invalid world spec option near '%s'.\n", end + 1);
+            return -1;
+        }
+        if (strcmp(key, "seed") == 0) spec->seed = strtoull(value, NULL, 10);
+        else if (strcmp(key, "density") == 0) spec->density = atof(value);
+        else if (strcmp(key, "rooms") == 0) spec->rooms = atoi(value);
+        else if (strcmp(key, "gap") == 0) spec->gap = atoi(value);
+        else {
+            printf("Error: Unknown world spec option '%s'.\n", key);
+            return -1;
+        }
+        end += 1 + used;
+    }
+    if (*end != '\0' || spec->density < 0.0 || spec->density >= 1.0 || spec->rooms < 0 ||
+        spec->gap < 2) {
+        printf("Error: Invalid world spec '%s'.\n", text);
+        return -1;
+    }
+    return 0;
+}
+
+static int rng_below(WalkRng *rng, int bound)
+{
+    return bound > 0 ? (int)(walk_rng_next(rng) % (uint64_t)bound) : 0;
+}
+
+static void fill(SharedState *S, int value)
+{
+    for (int y = 0; y < S->world_size; y++)
+        for (int x = 0; x < S->world_size; x++)
+            S->obstacles[y][x] = value;
+}
+
+static void gen_random(SharedState *S, const WorldGenSpec *spec, WalkRng *rng)
+{
+    for (int y = 0; y < S->world_size; y++)
+        for (int x = 0; x < S->world_size; x++)
+            S->obstacles[y][x] = walk_rng_uniform(rng) < spec->density;
+}
+
+// Bludisko: bunky na nepárnych súradniciach, náhodné DFS prerazí steny medzi susedmi.
+static int gen_maze(SharedState *S, WalkRng *rng)
+{
+    int cw = (S->world_size - 1) / 2;
+    size_t cells = (size_t)cw * cw;
+    int *stack = malloc(cells * sizeof(int));
+    unsigned char *seen = calloc(cells, 1);
+    if (!stack || !seen) {
+        free(stack);
+        free(seen);
+        return -1;
+    }
+    static const int dx[4] = { 1, -1, 0, 0 };
+    static const int dy[4] = { 0, 0, 1, -1 };
+
+    fill(S, 1);
+    int start = (S->world_size / 2 - 1) / 2;
+    if (start < 0) start = 0;
+    int top = 0;
+    stack[top++] = start * cw + start;
+    seen[start * cw + start] = 1;
+    S->obstacles[2 * start + 1][2 * start + 1] = 0;
+    while (top > 0) {
+        int cell = stack[top - 1];
+        int cx = cell % cw, cy = cell / cw;
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dx[d], ny = cy + dy[d];
+            if (nx >= 0 && ny >= 0 && nx < cw && ny < cw && !seen[ny * cw + nx]) options[count++] = d;
+        }
+        if (count == 0) {
+            top--;
+            continue;
+        }
+        int d = options[rng_below(rng, count)];
+        int nx = cx + dx[d], ny = cy + dy[d];
+        S->obstacles[2 * cy + 1 + dy[d]][2 * cx + 1 + dx[d]] = 0;
+        S->obstacles[2 * ny + 1][2 * nx + 1] = 0;
+        seen[ny * cw + nx] = 1;
+        stack[top++] = ny * cw + nx;
+    }
+    free(stack);
+    free(seen);
+    return 0;
+}
+
+static void carve_rect(SharedState *S, int x0, int y0, int w, int h)
+{
+    for (int y = y0; y < y0 + h; y++)
+        for (int x = x0; x < x0 + w; x++)
+            S->obstacles[y][x] = 0;
+}
+
+// Miestnosti v plnej skale; každá sa chodbou v tvare L napojí na predchádzajúcu (prvá je v strede).
+static void gen_rooms(SharedState *S, const WorldGenSpec *spec, WalkRng *rng)
+{
+    int n = S->world_size;
+    int count = spec->rooms > 0 ? spec->rooms : (n / 8 > 1 ? n / 8 : 1);
+    int max_side = 3 + n / 32;
+    if (max_side > n) max_side = n;
+    int px = n / 2, py = n / 2;
+
+    fill(S, 1);
+    for (int i = 0; i < count; i++) {
+        int w = 3 + rng_below(rng, max_side - 2);
+        int h = 3 + rng_below(rng, max_side - 2);
+        if (w > n) w = n;
+        if (h > n) h = n;
+        int x0 = (i == 0) ? n / 2 - w / 2 : rng_below(rng, n - w + 1);
+        int y0 = (i == 0) ? n / 2 - h / 2 : rng_below(rng, n - h + 1);
+        carve_rect(S, x0, y0, w, h);
+
+        int rx = x0 + w / 2, ry = y0 + h / 2;
+        for (int x = (px < rx ? px : rx); x <= (px < rx ? rx : px); x++) S->obstacles[py][x] = 0;
+        for (int y = (py < ry ? py : ry); y <= (py < ry ? ry : py); y++) S->obstacles[y][rx] = 0;
+        px = rx;
+        py = ry;
+    }
+}
+
+// Sústredné štvorcové prstence okolo stredu, v každom niekoľko náhodných dverí.
+static void gen_rings(SharedState *S, const WorldGenSpec *spec, WalkRng *rng)
+{
+    int n = S->world_size, c = n / 2;
+    fill(S, 0);
+    for (int r = spec->gap; r <= c; r += spec->gap) {
+        int perimeter = 8 * r;
+        for (int pass = 0; pass < 2; pass++) {
+            // 1. prechod kreslí stenu, 2. otvára dvere (1 + r / (4 * gap) na prstenec)
+            int doors = 1 + r / (4 * spec->gap);
+            int count = pass == 0 ? perimeter : doors;
+            for (int i = 0; i < count; i++) {
+                int k = pass == 0 ? i : rng_below(rng, perimeter);
+                int side = k / (2 * r), off = k % (2 * r);
+                int x, y;
+                if (side == 0) { x = c - r + off; y = c - r; }
+                else if (side == 1) { x = c + r; y = c - r + off; }
+                else if (side == 2) { x = c + r - off; y = c + r; }
+                else { x = c - r; y = c + r - off; }
+                if (x >= 0 && y >= 0 && x < n && y < n) S->obstacles[y][x] = (pass == 0);
+            }
+        }
+    }
+}
+
+// Záplava voľných buniek od start; do mark zapíše value. Vráti počet zaplavených buniek.
+static long long flood(const SharedState *S, int start, unsigned char *mark, unsigned char value, int *queue)
+{
+    int n = S->world_size;
+    long long head = 0, tail = 0;
+    queue[tail++] = start;
+    mark[start] = value;
+    while (head < tail) {
+        int cell = queue[head++];
+        int x = cell % n, y = cell / n;
+        int nb[4] = { x > 0 ? cell - 1 : -1, x < n - 1 ? cell + 1 : -1,
+                      y > 0 ? cell - n : -1, y < n - 1 ? cell + n : -1 };
+        for (int d = 0; d < 4; d++) {
+            int v = nb[d];
+            if (v >= 0 && mark[v] != value && !S->obstacles[v / n][v % n]) {
+                mark[v] = value;
+                queue[tail++] = v;
+            }
+        }
+    }
+    return tail;
+}
+
+// Napojí stred na najväčšiu voľnú oblasť (prerazí najkratšiu cestu cez prekážky, BFS po vrstvách
+// ceny 0/1) a zaplní voľné bunky, z ktorých sa do stredu nedá dostať. Vráti počet voľných buniek.
+static long long connect_center(SharedState *S, long long *sealed)
+{
+    int n = S->world_size;
+    size_t cells = (size_t)n * n;
+    int center = (n / 2) * n + n / 2;
+    unsigned char *mark = calloc(cells, 1);    // 1 = navštívené pri hľadaní oblastí, 2 = najväčšia
+    unsigned char *from = malloc(cells);       // smer, ktorým sa bunka dosiahla pri prerážaní
+    int *queue = malloc(cells * sizeof(int));
+    int *next = malloc(cells * sizeof(int));
+    if (!mark || !from || !queue || !next) {
+        free(mark);
+        free(from);
+        free(queue);
+        free(next);
+        return -1;
+    }
+    S->obstacles[n / 2][n / 2] = 0;
+
+    // Najväčšia voľná oblasť
+    long long best = 0;
+    int best_cell = center;
+    for (size_t c = 0; c < cells; c++) {
+        if (mark[c] || S->obstacles[c / n][c % n]) continue;
+        long long size = flood(S, (int)c, mark, 1, queue);
+        if (size > best) {
+            best = size;
+            best_cell = (int)c;
+        }
+    }
+    flood(S, best_cell, mark, 2, queue);
+
+    if (mark[center] != 2) {
+        // Vrstvy podľa počtu prerazených prekážok: voľné bunky v tej istej vrstve, prekážky do ďalšej.
+        static const int step[4] = { 1, -1, 0, 0 };
+        memset(from, 0xff, cells);
+        long long cur_n = 0, next_n = 0;
+        queue[cur_n++] = center;
+        from[center] = 4;
+        int found = -1;
+        while (cur_n > 0 && found < 0) {
+            for (long long i = 0; i < cur_n && found < 0; i++) {
+                int cell = queue[i];
+                if (mark[cell] == 2) {
+                    found = cell;
+                    break;
+                }
+                int x = cell % n, y = cell / n;
+                for (int d = 0; d < 4; d++) {
+                    int nx = x + step[d];
+                    int ny = y + (d == 2 ? 1 : d == 3 ? -1 : 0);
+                    if (nx < 0 || ny < 0 || nx >= n || ny >= n) continue;
+                    int v = ny * n + nx;
+                    if (from[v] != 0xff) continue;
+                    from[v] = (unsigned char)d;
+                    if (S->obstacles[ny][nx]) next[next_n++] = v;
+                    else queue[cur_n++] = v;
+                }
+            }
+            int *tmp = queue;
+            queue = next;
+            next = tmp;
+            cur_n = next_n;
+            next_n = 0;
+        }
+        // Prerazenie cesty späť k stredu
+        for (int cell = found; cell >= 0 && cell != center;) {
+            S->obstacles[cell / n][cell % n] = 0;
+            int d = from[cell];
+            int x = cell % n - step[d];
+            int y = cell / n - (d == 2 ? 1 : d == 3 ? -1 : 0);
+            cell = y * n + x;
+        }
+    }
+
+    // Odrezané vrecká zaplň, aby z každej voľnej bunky viedla cesta do stredu.
+    memset(mark, 0, cells);
+    long long reachable = flood(S, center, mark, 1, queue);
+    *sealed = 0;
+    for (size_t c = 0; c < cells; c++) {
+        if (!mark[c] && !S->obstacles[c / n][c % n]) {
+            S->obstacles[c / n][c % n] = 1;
+            (*sealed)++;
+        }
+    }
+    free(mark);
+    free(from);
+    free(queue);
+    free(next);
+    return reachable;
+}
+
+int worldgen_generate(SharedState *S, const WorldGenSpec *spec, FILE *log)
+{
+    if (S->world_size != spec->size) return -1;
+    WalkRng rng;
+    walk_rng_seed(&rng, spec->seed, (uint64_t)spec->kind, (uint64_t)spec->size);
+
+    switch (spec->kind) {
+        case WORLDGEN_RANDOM: gen_random(S, spec, &rng); break;
+        case WORLDGEN_MAZE:
+            if (gen_maze(S, &rng) != 0) {
+                printf("Error: Could not allocate memory for maze generation.\n");
+                return -1;
+            }
+            break;
+        case WORLDGEN_ROOMS: gen_rooms(S, spec, &rng); break;
+        case WORLDGEN_RINGS: gen_rings(S, spec, &rng); break;
+    }
+
+    long long sealed = 0;
+    long long free_cells = connect_center(S, &sealed);
+    if (free_cells < 0) {
+        printf("Error: Could not allocate memory for world generation.\n");
+        return -1;
+    }
+    S->use_obstacles = true;
+    if (log)
+        fprintf(log, "[Server] Generated %s world %dx%d (seed %llu): %.1f %% free, %lld cell(s) sealed off.\n",
+                kind_names[spec->kind], spec->size, spec->size, (unsigned long long)spec->seed,
+                100.0 * free_cells / ((double)spec->size * spec->size), sealed);
+    return 0;
+}
+
+int worldgen_export(const ServerConfig *config)
+{
+    WorldGenSpec spec;
+    if (config->generate[0] == '\0') {
+        printf("Error: --export-map needs --generate <spec>.\n");
+        return 1;
+    }
+    if (worldgen_parse(config->generate, &spec) != 0) return 1;
+
+    SharedState S;
+    memset(&S, 0, sizeof(S));
+    S.world_size = spec.size;
+    S.max_steps = config->max_steps;
+    S.prob = (Probabilities){ config->prob_up, config->prob_down, config->prob_left, config->prob_right };
+    allocate_world(&S);
+    initialize_world(&S);
+    int rc = 1;
+    if (worldgen_generate(&S, &spec, stdout) == 0 && save_simulation_results(&S, config->export_map)) rc = 0;
+    free_world(&S);
+    return rc;
+}
@@ -0,0 +1,43 @@
+#ifndef WORLDGEN_H
+#define WORLDGEN_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Procedurálne generované svety (--generate), bez čítania obstacles.txt.
+// Špecifikácia: "<druh>:<veľkosť>[,kľúč=hodnota...]", napr. "maze:2049,seed=7".
+//   random  náhodné prekážky, density=<0..1> (predvolene 0.3)
+//   maze    bludisko z náhodného DFS, chodby šírky 1
+//   rooms   miestnosti spojené chodbami, rooms=<počet> (predvolene veľkosť/8)
+//   rings   sústredné štvorcové prstence s dverami, gap=<rozostup> (predvolene 4)
+// Rovnaká špecifikácia (vrátane seed=, predvolene 1) dá vždy rovnakú mapu. Stred je vždy voľný
+// a z každej voľnej bunky sa dá do stredu dostať (odrezané vrecká sa zaplnia prekážkami).
+
+struct SharedState;
+struct ServerConfig;
+
+typedef enum WorldGenKind {
+    WORLDGEN_RANDOM,
+    WORLDGEN_MAZE,
+    WORLDGEN_ROOMS,
+    WORLDGEN_RINGS
+} WorldGenKind;
+
+typedef struct WorldGenSpec {
+    WorldGenKind kind;
+    int size;
+    double density;  // random
+    int rooms;       // rooms (0 = size / 8)
+    int gap;         // rings
+    uint64_t seed;
+} WorldGenSpec;
+
+// Rozparsuje špecifikáciu. Vráti 0 alebo -1 (a vypíše chybu).
+int worldgen_parse(const char *text, WorldGenSpec *spec);
+// Vyplní S->obstacles sveta veľkosti spec->size (už alokovaného). Vráti 0 alebo -1.
+// Ak log nie je NULL, zapíše doň jeden riadok o vygenerovanej mape.
+int worldgen_generate(struct SharedState *S, const WorldGenSpec *spec, FILE *log);
+// --export-map: vygeneruje svet a uloží ho vo formáte výsledkov (0 replikácií, pokračuje sa cez -l).
+int worldgen_export(const struct ServerConfig *config);
+
+#endif // WORLDGEN_H